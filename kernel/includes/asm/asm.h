@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/30 15:06:51 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/19 14:33:51 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:52:52 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -43,9 +43,11 @@
 #define GET_EFLAGS(x) __asm__ volatile("pushf\n\t" \
 								   "pop %0"    \
 								   : "=r"(x)::)
-#define SET_EFLAGS(x) __asm__ volatile("push %0\n\t" \
-								   "popf" ::     \
-									   : "r"(x))
+#define __SET_EFLAGS(x) __asm__ volatile("push %0\n\t" \
+									 "popf" ::     \
+										 "r"(x)    \
+									 : "memory", "cc")
+#define SET_EFLAGS(x) irqsoff_set_eflags(x) // Traced, see system/irqsoff.h
 
 /*******************************************************************************
  *                                SET ASM FLAGS                                *
@@ -89,8 +91,16 @@
  *                               INTERRUPT FLAG                                *
  ******************************************************************************/
 
-#define ASM_STI() __asm__ volatile("sti") // Set Interrupt Flag
-#define ASM_CLI() __asm__ volatile("cli") // Clear Interrupt Flag
+/* Traced by the irqs-off tracer (system/irqsoff.h) */
+extern void irqsoff_cli(void);
+extern void irqsoff_sti(void);
+extern void irqsoff_set_eflags(unsigned int eflags);
+
+#define __ASM_STI() __asm__ volatile("sti" ::: "memory") // Untraced, the caller reports to the tracer
+#define __ASM_CLI() __asm__ volatile("cli" ::: "memory")
+
+#define ASM_STI() irqsoff_sti() // Set Interrupt Flag
+#define ASM_CLI() irqsoff_cli() // Clear Interrupt Flag
 #define ASM_HLT() __asm__ volatile("hlt") // Halt
 
 #endif /* !ASM_H */
\ No newline at end of file
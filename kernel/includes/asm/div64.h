@@ -0,0 +1,61 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   div64.h                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:20:28 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 02:20:28 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef DIV64_H
+#define DIV64_H
+
+#include <kernel.h>
+
+/*
+** 64-bit arithmetic helpers for i386.
+** The kernel is not linked against libgcc, so plain 64-bit divisions would
+** leave '__udivdi3' unresolved: use these helpers instead.
+*/
+
+/**
+ * @brief Divide a 64-bit dividend by a 32-bit divisor
+ * @note : Two 'divl' instructions, the same way Linux's do_div() works on i386
+ */
+static inline uint64_t div_u64_rem(uint64_t dividend, uint32_t divisor, uint32_t *remainder) {
+    uint32_t high = (uint32_t)(dividend >> 32);
+    uint32_t low = (uint32_t)dividend;
+    uint32_t q_high = 0;
+    uint32_t rem;
+
+    if (high >= divisor) {
+        q_high = high / divisor;
+        high = high % divisor;
+    }
+    __asm__("divl %4"
+            : "=a"(low), "=d"(rem)
+            : "0"(low), "1"(high), "rm"(divisor));
+    if (remainder)
+        *remainder = rem;
+    return (((uint64_t)q_high << 32) | low);
+}
+
+static inline uint64_t div_u64(uint64_t dividend, uint32_t divisor) {
+    return (div_u64_rem(dividend, divisor, NULL));
+}
+
+/**
+ * @brief Compute (a * mul) >> shift without losing the upper bits of the product
+ * @note : shift must be in [1, 32], the result must fit in 64 bits
+ */
+static inline uint64_t mul_u64_u32_shr(uint64_t a, uint32_t mul, uint32_t shift) {
+    uint64_t low = (uint64_t)(uint32_t)a * mul;
+    uint64_t high = (uint64_t)(uint32_t)(a >> 32) * mul;
+
+    return ((low >> shift) + (high << (32 - shift)));
+}
+
+#endif /* !DIV64_H */
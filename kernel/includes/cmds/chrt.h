@@ -1,24 +1,20 @@
 /* ************************************************************************** */
 /*                                                                            */
 /*                                                        :::      ::::::::   */
-/*   process_threads.c                                  :+:      :+:    :+:   */
+/*   chrt.h                                             :+:      :+:    :+:   */
 /*                                                    +:+ +:+         +:+     */
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
-/*   Created: 2023/10/26 20:50:21 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/26 21:23:48 by vvaucoul         ###   ########.fr       */
+/*   Created: 2026/10/19 03:24:56 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:25:28 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
-#include <multitasking/process.h>
+#ifndef CHRT_H
+#define CHRT_H
 
-void __process_threads(task_t *current_task) {
-    if (current_task->threads != NULL) {
-        thread_schedule(current_task->threads);
-        // thread_t *tmp = current_task->threads;
-        // while (tmp) {
-        //     printk("[TASKING]: Starting thread\n");
-        //     tmp = tmp->next;
-        // }
-    }
-}
\ No newline at end of file
+#include <shell/ksh_args.h>
+
+extern void chrt(const ksh_args_t *args);
+
+#endif /* !CHRT_H */
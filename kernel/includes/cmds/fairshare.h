@@ -0,0 +1,20 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fairshare.h                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:36:10 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:36:26 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef FAIRSHARE_H
+#define FAIRSHARE_H
+
+#include <shell/ksh_args.h>
+
+extern void fairshare(const ksh_args_t *args);
+
+#endif /* !FAIRSHARE_H */
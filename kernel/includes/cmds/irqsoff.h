@@ -0,0 +1,20 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   irqsoff.h                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:50:54 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:52:52 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CMD_IRQSOFF_H
+#define CMD_IRQSOFF_H
+
+#include <shell/ksh_args.h>
+
+extern void irqsoff(const ksh_args_t *args);
+
+#endif /* !CMD_IRQSOFF_H */
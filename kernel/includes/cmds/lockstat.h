@@ -0,0 +1,20 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   lockstat.h                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:02:15 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:02:30 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LOCKSTAT_H
+#define LOCKSTAT_H
+
+#include <shell/ksh_args.h>
+
+extern void lockstat(const ksh_args_t *args);
+
+#endif /* !LOCKSTAT_H */
@@ -0,0 +1,20 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   schedtrace.h                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:13:21 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:13:29 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SCHEDTRACE_H
+#define SCHEDTRACE_H
+
+#include <shell/ksh_args.h>
+
+extern void schedtrace(const ksh_args_t *args);
+
+#endif /* !SCHEDTRACE_H */
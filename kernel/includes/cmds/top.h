@@ -1,29 +1,23 @@
 /* ************************************************************************** */
 /*                                                                            */
 /*                                                        :::      ::::::::   */
-/*   task_overflow_handler.c                            :+:      :+:    :+:   */
+/*   top.h                                              :+:      :+:    :+:   */
 /*                                                    +:+ +:+         +:+     */
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
-/*   Created: 2023/10/23 11:31:55 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/23 18:26:58 by vvaucoul         ###   ########.fr       */
+/*   Created: 2026/10/19 03:16:06 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:18:16 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
-#include <multitasking/process.h>
-#include <multitasking/scheduler.h>
-#include <system/panic.h>
-#include <kernel.h>
+#ifndef TOP_H
+#define TOP_H
 
-uint32_t stack_canary = 0xDEADBEEF;
+#include <shell/ksh_args.h>
 
-void __task_overflow_handler(void) {
-    uint32_t esp;
+#define TOP_DEFAULT_REFRESH 5 // Refreshes when no count is given
+#define TOP_REFRESH_MS 1000   // Matches the usage sample period
 
-    __asm__ __volatile__("mov %%esp, %0" : "=r"(esp));
+extern void top(const ksh_args_t *args);
 
-    if (stack_canary != 0xDEADBEEF || esp <= KERNEL_STACK_SIZE) {
-        __PANIC("Stack overflow detected");
-        kpause();
-    }
-}
\ No newline at end of file
+#endif /* !TOP_H */
@@ -0,0 +1,72 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   kstack.h                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:45:27 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 02:45:27 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef KSTACK_H
+#define KSTACK_H
+
+#include <kernel.h>
+#include <memory/paging.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  KERNEL STACKS                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Kernel stacks live in their own virtual region, away from the heap:
+**
+**   KSTACK_REGION_START
+**   | guard | stack 0 | guard | stack 1 | ...
+**
+** Guard pages are never mapped: running off a stack faults instead of
+** silently corrupting its neighbour. With esp in a guard page the CPU cannot
+** push the #PF frame, so the overflow shows up as a double fault, handled on
+** a stack of its own (task gate, see percpu_install_double_fault()).
+**
+** The page tables of the region are created with the kernel directory, so
+** every cloned directory shares them. Freed stacks stay mapped and go back
+** to a pool.
+*/
+
+#define KSTACK_PAGES 2 // 2 (8KB) or 4 (16KB)
+
+#if KSTACK_PAGES != 2 && KSTACK_PAGES != 4
+#error "KSTACK_PAGES must be 2 (8KB) or 4 (16KB)"
+#endif
+
+#define KSTACK_SIZE (KSTACK_PAGES * PAGE_SIZE)
+#define KSTACK_GUARD_SIZE PAGE_SIZE
+#define KSTACK_SLOT_SIZE (KSTACK_GUARD_SIZE + KSTACK_SIZE)
+
+#define KSTACK_REGION_START 0xD0000000
+#define KSTACK_REGION_SIZE 0x800000 // 8MB: two page tables
+#define KSTACK_REGION_END (KSTACK_REGION_START + KSTACK_REGION_SIZE)
+#define KSTACK_SLOTS (KSTACK_REGION_SIZE / KSTACK_SLOT_SIZE)
+
+typedef struct s_kstack_stats {
+    uint32_t mapped; // Slots mapped so far
+    uint32_t in_use; // Stacks currently allocated
+    uint32_t pooled; // Mapped stacks waiting in the free pool
+} kstack_stats_t;
+
+extern void kstack_init_region(page_directory_t *dir);
+extern void kstack_init(void);
+
+extern uint32_t kstack_alloc(void);
+extern void kstack_free(uint32_t stack);
+
+extern bool kstack_is_guard(uint32_t addr);
+extern void kstack_overflow_report(uint32_t addr, uint32_t eip, uint32_t esp);
+extern void kstack_double_fault(void);
+
+extern kstack_stats_t kstack_get_stats(void);
+
+#endif /* !KSTACK_H */
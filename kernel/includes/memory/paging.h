@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/11/17 14:29:43 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/26 14:44:38 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:33:57 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -69,12 +69,18 @@ typedef struct s_page_directory {
     page_table_t *tables[PAGE_TABLE_SIZE];
     uint32_t tablesPhysical[PAGE_TABLE_SIZE];
     uint32_t physicalAddr;
+    uint32_t refcount; // Owner task + kernel threads / idle tasks running on it
 } page_directory_t;
 
 extern page_directory_t *kernel_directory;
-extern page_directory_t *current_directory;
+
+/* Page directory loaded on this CPU (users include system/percpu.h) */
+#define current_directory (this_cpu()->directory)
+
+#define PAGING_MAX_MMIO_REGIONS 4
 
 extern void init_paging(void);
+extern void paging_reserve_mmio(uint32_t base, uint32_t size);
 extern page_t *get_page(uint32_t address, page_directory_t *dir);
 extern page_t *create_page(uint32_t address, page_directory_t *dir);
 
@@ -97,6 +103,8 @@ extern page_table_t *clone_table(page_table_t *src, uint32_t *physAddr);
 extern void copy_page_physical(uint32_t, uint32_t);
 
 extern void destroy_page_directory(page_directory_t *dir);
+extern void page_directory_get(page_directory_t *dir);
+extern void page_directory_put(page_directory_t *dir);
 
 extern int is_paging_enabled(void);
 
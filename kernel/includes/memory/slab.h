@@ -0,0 +1,52 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   slab.h                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:49:24 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 02:52:48 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <kernel.h>
+#include <memory/paging.h>
+#include <system/spinlock.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   SLAB CACHES                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Fixed-size object cache: objects are carved from page-sized slabs taken
+** from the kernel heap and recycled through a free list, so allocating and
+** freeing an object is O(1) and never touches the heap index.
+** Slabs are kept for the lifetime of the cache.
+*/
+
+#define SLAB_SIZE PAGE_SIZE
+#define SLAB_ALIGN 16
+
+typedef struct s_kmem_cache {
+    const char *name;
+    uint32_t obj_size;      // Object size, rounded to SLAB_ALIGN
+    uint32_t objs_per_slab;
+
+    void *free;             // Free objects, linked through their first word
+    spinlock_t lock;
+
+    uint32_t nr_slabs;
+    uint32_t nr_free;
+    uint32_t nr_in_use;
+} kmem_cache_t;
+
+extern void kmem_cache_init(kmem_cache_t *cache, const char *name, uint32_t obj_size);
+extern void *kmem_cache_alloc(kmem_cache_t *cache);
+extern void kmem_cache_free(kmem_cache_t *cache, void *obj);
+extern void kmem_cache_print(kmem_cache_t *cache);
+
+#endif /* !SLAB_H */
@@ -0,0 +1,64 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   cpu_acct.h                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:15:16 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:38:37 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CPU_ACCT_H
+#define CPU_ACCT_H
+
+#include <kernel.h>
+
+#include <system/pit.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 CPU ACCOUNTING                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** The running time of a task is charged in sched_clock() units (TSC
+** cycles) when it is switched out and when it enters / leaves a syscall:
+** to utime while it runs user code, to stime otherwise. Interrupts are
+** charged to the mode they interrupted.
+**
+** Every second, the timer samples the CPU usage of each task over the last
+** second. Idle time is the run time of the idle task of each CPU (see
+** cpu_idle()), sampled the same way but kept out of the task list. Every CPU_ACCT_LOAD_FREQ, the load averages decay towards the
+** number of runnable tasks, in FSHIFT fixed point (as UNIX does).
+*/
+
+#define CPU_ACCT_SAMPLE_FREQ TIMER_PHASE   // Usage sample period, in ticks (1 s)
+#define CPU_ACCT_LOAD_FREQ (5 * TIMER_PHASE) // Load average period, in ticks (5 s)
+
+#define FSHIFT 11              // Bits of precision of the load averages
+#define FIXED_1 (1 << FSHIFT)  // 1.0 in fixed point
+#define EXP_1 1884             // 1 / exp(5s / 1min) in fixed point
+#define EXP_5 2014             // 1 / exp(5s / 5min)
+#define EXP_15 2037            // 1 / exp(5s / 15min)
+
+#define LOAD_INT(x) ((x) >> FSHIFT)
+#define LOAD_FRAC(x) ((((x) & (FIXED_1 - 1)) * 100) >> FSHIFT)
+
+struct s_task;
+struct s_cpu;
+
+extern uint32_t avenrun[3];
+
+extern void cpu_acct_switch(struct s_task *prev, struct s_task *next);
+extern void cpu_acct_syscall_enter(struct s_task *task);
+extern void cpu_acct_syscall_exit(struct s_task *task);
+extern void cpu_acct_user_enter(struct s_task *task);
+extern void cpu_acct_tick(uint64_t jiffies);
+
+extern uint64_t cpu_acct_utime_ns(struct s_task *task);
+extern uint64_t cpu_acct_stime_ns(struct s_task *task);
+extern uint64_t cpu_acct_idle_ns(struct s_cpu *cpu);
+extern uint32_t cpu_acct_idle_usage(struct s_cpu *cpu);
+
+#endif /* !CPU_ACCT_H */
@@ -0,0 +1,75 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   kthread.h                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:42:04 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:26:15 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef KTHREAD_H
+#define KTHREAD_H
+
+#include <kernel.h>
+#include <multitasking/process.h>
+#include <multitasking/wait_queue.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 KERNEL THREADS                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** A kernel thread is a task of its own: it is scheduled from the run queues
+** like any process, with its own kernel stack and priority, but it has no
+** address space (page_directory == NULL, it borrows the previous one, see
+** switch_to()) and never returns to user mode.
+**
+** The kthread_t outlives the task: it keeps the exit code and the CPU time
+** of the thread until kthread_join() (or until exit for detached threads).
+** It is freed by whoever lets go of it last: the joiner (or detacher) once
+** the task is reaped, else the reaper once it was released.
+*/
+
+#define KTHREAD_NAME_LEN 16
+
+typedef int32_t (*kthread_fn_t)(void *arg);
+
+typedef struct s_kthread {
+    task_t *task; // Schedulable entity, NULL once reaped
+    pid_t pid;
+    char name[KTHREAD_NAME_LEN];
+
+    kthread_fn_t fn;
+    void *arg;
+
+    int32_t exit_code;
+    volatile bool exited;
+    bool detached;
+    bool joined;
+    bool released;         // Joined or detached and done with, freed with the task
+    wait_queue_t exit_wait; // kthread_join() sleeps here until exited
+
+    uint64_t cpu_time; // Time spent on a CPU (ns), final once exited
+    uint32_t switches; // Times scheduled in, final once exited
+} kthread_t;
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    FUNCTIONS                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+extern kthread_t *kthread_create(kthread_fn_t fn, void *arg, const char *name);
+extern kthread_t *kthread_create_on_cpu(kthread_fn_t fn, void *arg, const char *name, uint32_t cpu);
+extern int32_t kthread_join(kthread_t *kthread, int32_t *exit_code);
+extern void kthread_detach(kthread_t *kthread);
+extern void kthread_exit(int32_t exit_code) __attribute__((noreturn));
+
+extern kthread_t *kthread_self(void);
+extern uint64_t kthread_cpu_time(kthread_t *kthread);
+
+extern void kthread_task_freed(task_t *task);
+extern void kthread_print(kthread_t *kthread);
+
+#endif /* !KTHREAD_H */
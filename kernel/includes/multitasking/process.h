@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/02/12 10:07:05 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 11:29:28 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:27:37 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -14,17 +14,21 @@
 #define PROCESS_H
 
 #include <kernel.h>
+#include <memory/kstack.h>
 #include <memory/paging.h>
 
+#include <multitasking/sched_class.h>
+#include <multitasking/wait_queue.h>
+#include <system/rcu.h>
+#include <system/rwlock.h>
 #include <system/signal.h>
-#include <system/threads.h>
 
-#define KERNEL_STACK_SIZE 0x1000 // 4KB - Kernel Stack === PAGE_SIZE
+#define KERNEL_STACK_SIZE KSTACK_SIZE // 8KB or 16KB, see kstack.h
 #define INIT_PID 0x1             // First process pid created
 
-// Each ticks, increase counter by ZOMBIE_HUNGRY, zombie will die after ZOMBIE_HUNGRY_DIE ticks
-#define ZOMBIE_HUNGRY 0x3      // Zombie hungry counter
-#define ZOMBIE_HUNGRY_DIE 0x10 // Zombie hungry die counter
+
+/* task_waitpid() options */
+#define WNOHANG 0x1 // Return 0 instead of blocking if no child has exited
 
 typedef enum e_task_state {
     TASK_RUNNING,
@@ -32,7 +36,8 @@ typedef enum e_task_state {
     TASK_WAITING,
     TASK_STOPPED,
     TASK_ZOMBIE,
-    TASK_ORPHAN,
+    TASK_BLOCKED, // Waiting on a wait queue (see wait_queue.h)
+    TASK_STATE_COUNT, // Number of states, not a state
 } task_state_t;
 
 typedef enum e_task_priority {
@@ -53,38 +58,92 @@ typedef uint32_t uid_t;
 #endif
 
 typedef struct s_process_cpu_load {
-    uint64_t start_time;      // Time when the task started
-    uint64_t load_time;       // Time when the task was loaded and finished his task
-    uint64_t total_load_time; // Total time the task was loaded
+    uint64_t stamp;    // sched_clock() when the running time was last charged (see cpu_acct.c)
+    uint64_t utime;    // Time spent running user code (sched_clock units)
+    uint64_t stime;    // Time spent running kernel code (sched_clock units)
+    uint64_t sample;   // utime + stime at the last usage sample
+    uint32_t usage;    // CPU usage over the last sample period (permille)
+    uint32_t switches; // Times the task was scheduled in
+    bool user_mode;    // Running user code: time goes to utime
 } process_cpu_load_t;
 
+struct s_kthread;
+struct s_wait_queue;
+struct s_pi_mutex;
+
 typedef struct s_task {
     pid_t pid;    // Process id
-    int32_t ppid; // Parent pid
+    int32_t ppid; // Parent pid, kept equal to parent->pid
+    pid_t pgid;   // Process group id, inherited at fork
+
+    struct s_task *parent;                // Parent task, INIT once the parent exited (see process_tree.c)
+    struct s_task *children;              // First child
+    struct s_task *sibling, *sibling_prev; // Links in the parent's children list
 
     uid_t owner;           // Owner id (user id)
     uid_t effective_owner; // Effective owner id (effective user id)
 
-    uint32_t esp, ebp; // Stack and base pointer
-    uint32_t eip;      // Instruction pointer
+    uint32_t esp; // Saved stack pointer, points to a switch frame (see switch_to.s)
 
-    page_directory_t *page_directory; // Page directory
+    page_directory_t *page_directory;   // Page directory (NULL for kernel threads)
+    page_directory_t *active_directory; // Page directory loaded while running (borrowed by kernel threads)
+
+    uint8_t *fpu_state;    // FXSAVE area, allocated on first FPU use (see fpu.c)
+    void *fpu_state_alloc; // Raw allocation backing fpu_state
 
     uint32_t kernel_stack;      // Kernel stack
     struct s_task *next, *prev; // Next and previous task
+    struct s_task *pid_next;    // PID hash chain (see pid.c)
+
+    struct s_task *state_next, *state_prev; // List of the tasks in the same state (see task_table.c)
+    task_state_t list_state;                // State list the task is linked in
+    bool in_task_table;
+
+    struct s_wait_queue *wq;          // Wait queue the task is blocked on
+    struct s_task *wq_next, *wq_prev; // Wait queue links (see wait_queue.c)
+    uint32_t wq_since;                // Jiffies when it blocked (see watchdog.c)
+    bool wq_idle;                     // Blocked by wait_event_idle(), never a hung task
+    uint32_t wq_deadline;             // Subtick a timed wait gives up at, 0 if none (see wait_queue.c)
+
+    volatile uint32_t futex_key;           // Physical address waited on in futex(), 0 if none
+    struct s_task *futex_next, *futex_prev; // Futex bucket links (see futex.c)
+
+    uint32_t cpu;                     // CPU whose run queue holds the task (last CPU it ran on)
+    uint32_t cpus_allowed;            // CPUs it may be homed on, bit per CPU id (see runqueue.c)
+    volatile bool on_cpu;             // Running, or being switched out, on a CPU
+    bool on_rq;                       // Homed in the run queue of 'cpu' (see runqueue.c)
+
+    sched_policy_t policy;                  // Scheduling class of the task (see sched_class.h)
+    const struct s_sched_class *sched_class; // Class whose queue the task is linked in
+    uint32_t rt_priority;                   // SCHED_FIFO / SCHED_RR priority, higher runs first
+    uint32_t pi_rt_priority;                // RT priority inherited from PI mutex waiters, 0 if none
+    struct s_task *rt_next, *rt_prev;       // RT queue links (see sched_rt.c)
+    uint32_t rt_level;                      // RT level the task is queued at, 0 while not runnable
+    uint64_t rt_slice_ns;                   // SCHED_RR time left in the current slice
+
+    sched_entity_t se;                   // Fair class entity (see sched_fair.c)
+    struct s_task_group *sched_group;    // Fair-share group of the task (see sched_group.c)
 
     int32_t exit_code;
 
     uint32_t wake_up_tick; // Wake up tick (Check task sleep)
 
-    task_priority_t or_priority; // Task priority at creation
-    task_priority_t priority;    // Task priority runtime
+    task_priority_t or_priority;   // Task priority at creation
+    task_priority_t fair_priority; // or_priority saved while an RT policy replaces it (see sched_setscheduler())
+    task_priority_t priority;      // Task priority runtime
+    task_priority_t pi_boost;      // Priority inherited from PI mutex waiters (see pi_mutex.c)
+
+    struct s_pi_mutex *pi_held;       // PI mutexes owned by the task
+    struct s_pi_mutex *pi_blocked_on; // PI mutex the task sleeps on
 
     task_state_t state;
 
     process_cpu_load_t cpu_load; // CPU load (Check task cpu load)
+    uint64_t sched_wakeup_tsc;   // When the task became runnable, 0 once it ran (see sched_trace.c)
 
-    signal_node_t *signal_queue; // Queue of signals to be processed
+    volatile sigset_t sig_pending;          // Signals sent, not delivered yet (see process_signals.c)
+    sigset_t sig_blocked;                   // Signals kept pending until unblocked
+    sigaction_t sigactions[SIGNALS_COUNT];  // Action of each signal, zeroed is SIG_DFL
 
     /*
     **  Task ID
@@ -112,15 +171,18 @@ typedef struct s_task {
         uint32_t data_size;
     } sectors;
 
-    int32_t zombie_hungry; // Counter for zombie process
+    wait_queue_t child_exit; // Sleeps in waitpid, woken when a child exits (see process_wait.c)
 
-    thread_t *threads;
+    struct s_kthread *kthread; // Kernel thread descriptor (NULL for processes, see kthread.c)
+
+    rcu_head_t rcu; // Deferred free of the task_t, lockless readers may still see it
 } task_t;
 
 void init_tasking(void);
 void switch_task(void);
 
 int32_t task_fork(void);
+void task_init_switch_frame(task_t *task, void (*entry)(void));
 
 int32_t getpid(void);
 int32_t getppid(void);
@@ -129,45 +191,89 @@ task_t *get_current_task(void);
 task_t *get_task(int32_t pid);
 
 int32_t init_task(void func(void));
+void task_park(void);
 
 int32_t kill_task(int32_t pid);
+int32_t task_terminate(task_t *task);
 int32_t free_task(task_t *task);
 int32_t kill_all_tasks(void);
 int32_t task_wait(int32_t pid);
+pid_t task_waitpid(pid_t pid, int32_t *status, int32_t options);
+void task_notify_parent(task_t *task);
+
+/* process_tree.c */
+void task_tree_link(task_t *parent, task_t *child);
+void task_tree_unlink(task_t *task);
+void task_reparent_children(task_t *task);
+int32_t task_setpgid(pid_t pid, pid_t pgid);
+pid_t task_getpgid(pid_t pid);
+int32_t task_kill_pgrp(pid_t pgid, int32_t signum);
 
 void switch_to_user_mode(void);
 void switch_user_mode(void);
 
 extern uint32_t read_eip(void);
 
-extern void task_exit(int32_t retval);
+extern void task_exit(int32_t retval) __attribute__((noreturn));
 
 __attribute__((pure)) extern page_directory_t *get_task_directory(void);
 
+extern void set_task_uid(task_t *task, uint32_t uid);
+extern void set_task_gid(task_t *task, uint32_t gid);
+extern void set_task_euid(task_t *task, uint32_t euid);
+extern void set_task_egid(task_t *task, uint32_t egid);
+
 task_t *get_waiting_queue(void);
-uint32_t get_task_count(void);
-uint32_t get_waiting_task_count(void);
 extern uint32_t getuid(void);
 
-extern void lock_task(task_t *task);
-extern void unlock_task(task_t *task);
 
 extern void task_set_priority(pid_t pid, task_priority_t priority);
+extern task_priority_t task_base_priority(task_t *task);
 
-extern pid_t find_first_free_pid(void);
+extern pid_t pid_alloc(void);
+extern void pid_free(pid_t pid);
+extern uint32_t pid_used(void);
+extern void pid_hash_add(task_t *task);
+extern void pid_hash_remove(task_t *task);
+extern task_t *pid_hash_find(pid_t pid);
 
-extern double get_cpu_load(task_t *task);
+extern uint32_t get_cpu_load(task_t *task);
 
 extern void print_task_info(task_t *task);
 extern void print_all_tasks();
 extern void print_parent_and_children(int pid);
 
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   TASK TABLE                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+extern task_t *task_alloc(void);
+extern void task_free_struct(task_t *task);
+extern void task_free_struct_rcu(task_t *task);
+
+extern bool task_set_state(task_t *task, task_state_t state);
+extern task_t *task_state_first(task_state_t state);
+extern uint32_t task_state_count(task_state_t state);
+
+extern void task_admit(task_t *task);
+extern void task_admit_waiting(void);
+extern void task_table_remove(task_t *task);
+
+extern uint32_t task_get_max(void);
+extern void task_set_max(uint32_t max);
+extern uint32_t get_task_count(void);
+extern uint32_t get_waiting_task_count(void);
+
 // ! ||--------------------------------------------------------------------------------||
 // ! ||                                   READY QUEUE                                  ||
 // ! ||--------------------------------------------------------------------------------||
 
 extern task_t *ready_queue;
 
+/* Links of the ready list: written under tasklist_lock + write_lock, walked
+** by readers in RCU read sections (a removed task keeps its 'next') */
+extern rwlock_t ready_queue_lock;
+
 /* Ready Queue:
 ** - Ready queue is a queue of running tasks
 ** - Each tick, we check if a task in ready queue can be executed
@@ -0,0 +1,146 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   sched_class.h                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:21:45 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:26:15 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SCHED_CLASS_H
+#define SCHED_CLASS_H
+
+#include <kernel.h>
+
+#include <system/rbtree.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                               SCHEDULING CLASSES                               ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Every run queue is split by scheduling class, classes are asked in order
+** (sched_class_highest, then ->next) and the first one with a runnable task
+** wins:
+**
+**   rt   : SCHED_FIFO / SCHED_RR, fixed priority 1 .. SCHED_RT_PRIO_MAX
+**   fair : SCHED_NORMAL, weighted virtual runtime (see sched_fair.c)
+**
+** A task is homed in the run queue of one CPU (enqueue / dequeue) whatever
+** its state, task_sleep / task_woken follow its RUNNING transitions.
+*/
+
+typedef enum e_sched_policy {
+    SCHED_NORMAL,
+    SCHED_FIFO, // Runs until it blocks, yields or a higher RT priority wakes up
+    SCHED_RR,   // SCHED_FIFO with a time slice among equal priorities
+} sched_policy_t;
+
+#define SCHED_RT_PRIO_LEVELS 32                       // One bit per level in rt_rq_t.bitmap
+#define SCHED_RT_PRIO_MAX (SCHED_RT_PRIO_LEVELS - 1) // Valid RT priorities: 1 .. SCHED_RT_PRIO_MAX
+#define SCHED_RT_PRIO_DEFAULT 16                      // Given to TASK_PRIORITY_REALTIME tasks
+
+#define SCHED_RR_TIMESLICE_MS 100   // Default RR quantum
+#define SCHED_RT_PERIOD_US 1000000  // RT throttling period
+#define SCHED_RT_RUNTIME_US 950000  // RT time allowed per period, >= period disables throttling
+
+struct s_task;
+struct s_runqueue;
+struct s_cpu;
+
+typedef struct s_rt_rq {
+    uint32_t bitmap;                            // Levels with at least one runnable task
+    struct s_task *head[SCHED_RT_PRIO_LEVELS];  // Per level FIFO of the runnable tasks, linked by rt_next / rt_prev
+    struct s_task *tail[SCHED_RT_PRIO_LEVELS];
+    uint32_t nr_running;                        // Runnable RT tasks (queued)
+
+    uint64_t exec_start;   // sched_clock() when the running RT task was last charged
+    uint64_t period_start; // sched_clock() at the start of the throttling period
+    uint64_t runtime_ns;   // RT time used in the current period
+    bool throttled;        // Runtime exhausted, no RT task runs until the period ends
+    uint32_t throttles;    // Periods cut short by the throttling
+} rt_rq_t;
+
+/* CFS defaults, the clock is sched_clock() but preemption is checked at ticks */
+#define SCHED_LATENCY_NS 6000000           // Target latency: every runnable task runs once per period
+#define SCHED_MIN_GRANULARITY_NS 750000    // Shortest slice, stretches the period past latency / granularity tasks
+#define SCHED_WAKEUP_GRANULARITY_NS 1000000 // vruntime lead a woken task needs to preempt
+
+#define SCHED_WEIGHT_NICE_0 1024 // Weight of a TASK_PRIORITY_MEDIUM task
+
+struct s_cfs_rq;
+struct s_task_group;
+
+/**
+ * @brief Schedulable entity of the fair class: a task, or a group of tasks
+ *        whose own queue (my_q) is scheduled in its parent's queue
+ */
+typedef struct s_sched_entity {
+    rb_node_t run_node;               // Timeline node in cfs_rq
+    bool queued;                      // Runnable, accounted in cfs_rq
+    uint32_t weight;                  // Weight accounted in cfs_rq->load
+    uint64_t vruntime;                // Weighted runtime, relative to min_vruntime while a task is not homed
+    uint64_t sum_exec_ns;             // Total runtime charged
+    uint64_t prev_sum_exec_ns;        // sum_exec_ns when the entity got the CPU
+    struct s_cfs_rq *cfs_rq;          // Queue the entity is scheduled in
+    struct s_cfs_rq *my_q;            // Group entity: queue of its members, NULL for a task
+    struct s_sched_entity *parent;    // Group entity owning cfs_rq, NULL at the top level
+} sched_entity_t;
+
+typedef struct s_cfs_rq {
+    rb_root_t timeline;           // Queued entities but the running one, by vruntime
+    struct s_sched_entity *curr;  // Running entity of this queue, out of the timeline
+    struct s_sched_entity *skip;  // Entity that yielded, picked last
+    struct s_sched_entity *last;  // Last entity given the CPU, compared only
+    uint64_t min_vruntime;        // Monotonic floor of the queued vruntimes
+    uint64_t exec_start;          // sched_clock() when curr was last charged
+    uint32_t nr_running;          // Queued entities, curr included
+    uint32_t h_nr_running;        // Queued tasks, in this queue and the groups below
+    uint32_t load;                // Sum of the queued weights
+    bool resched;                 // Top level: curr used its slice or was preempted by a wake up
+    struct s_task_group *tg;      // Group owning the queue, NULL for the top level one
+    uint32_t cpu;                 // CPU of the queue
+} cfs_rq_t;
+
+/**
+ * @brief Operations of a scheduling class
+ * @note : Called with the run queue lock held and interrupts disabled.
+ *         Every operation but enqueue / dequeue / pick_next / steal may be
+ *         NULL.
+ */
+typedef struct s_sched_class {
+    const char *name;
+    const struct s_sched_class *next; // Next class in pick order
+
+    void (*enqueue)(struct s_runqueue *rq, struct s_task *task);
+    void (*dequeue)(struct s_runqueue *rq, struct s_task *task);
+    struct s_task *(*pick_next)(struct s_runqueue *rq, struct s_task *prev);
+    struct s_task *(*steal)(struct s_runqueue *rq, struct s_task *exclude, struct s_cpu *thief);
+
+    void (*put_prev)(struct s_runqueue *rq, struct s_task *prev);   // prev leaves the CPU (or is re-picked)
+    void (*set_next)(struct s_runqueue *rq, struct s_task *next);   // next gets the CPU
+    void (*task_tick)(struct s_runqueue *rq, struct s_task *curr);  // Timer tick while curr runs
+    void (*task_woken)(struct s_runqueue *rq, struct s_task *task); // task became RUNNING
+    void (*task_sleep)(struct s_runqueue *rq, struct s_task *task); // task left RUNNING
+    void (*yield_task)(struct s_runqueue *rq, struct s_task *curr); // curr gives the CPU away
+    bool (*check_preempt)(struct s_runqueue *rq, struct s_task *curr, struct s_task *task);
+} sched_class_t;
+
+extern const sched_class_t rt_sched_class;
+extern const sched_class_t fair_sched_class;
+
+#define sched_class_highest (&rt_sched_class)
+#define for_each_class(class) for (const sched_class_t *class = sched_class_highest; class; class = class->next)
+
+/* Tunables (see chrt) */
+extern uint32_t sched_rr_timeslice_ms;
+extern uint32_t sched_rt_period_us;
+extern uint32_t sched_rt_runtime_us;
+extern uint32_t sched_latency_ns;
+extern uint32_t sched_min_granularity_ns;
+extern uint32_t sched_wakeup_granularity_ns;
+
+#endif /* !SCHED_CLASS_H */
@@ -0,0 +1,65 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   sched_group.h                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:31:57 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:36:26 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SCHED_GROUP_H
+#define SCHED_GROUP_H
+
+#include <multitasking/process.h>
+#include <multitasking/sched_class.h>
+
+#include <system/percpu.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                              FAIR-SHARE GROUPS                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Fair tasks are scheduled in two levels: the top level queue of a CPU
+** holds one entity per group with runnable tasks there, each group entity
+** owns the queue of its tasks. CPU time is shared between groups by their
+** shares first, then between the tasks of a group by their weights.
+**
+** Groups are keyed by uid (or gid, see sched_group_set_key()), created on
+** first use and never freed. The shares of a group are split between CPUs
+** in proportion to its load on each of them.
+*/
+
+#define SCHED_GROUP_SHARES_DEFAULT SCHED_WEIGHT_NICE_0
+#define SCHED_GROUP_SHARES_MIN 2
+#define SCHED_GROUP_SHARES_MAX (1 << 18)
+
+typedef enum e_sched_group_key {
+    SCHED_GROUP_BY_UID,
+    SCHED_GROUP_BY_GID,
+} sched_group_key_t;
+
+typedef struct s_task_group {
+    uint32_t id;                       // uid or gid of the members
+    volatile uint32_t shares;          // Weight of the group against the other groups
+    sched_entity_t se[PERCPU_MAX_CPUS]; // Entity of the group in the top level queue of each CPU
+    cfs_rq_t cfs[PERCPU_MAX_CPUS];     // Queue of the group members on each CPU
+    struct s_task_group *next;
+} task_group_t;
+
+extern task_group_t default_task_group;
+extern sched_group_key_t sched_group_key;
+
+extern void sched_group_init(void);
+extern void sched_group_init_cpu(task_group_t *tg, uint32_t cpu);
+extern task_group_t *sched_group_get(uint32_t id);
+extern task_group_t *task_group_of(task_t *task);
+extern void sched_group_attach(task_t *task);
+extern int32_t sched_group_set_shares(uint32_t id, uint32_t shares);
+extern void sched_group_set_key(sched_group_key_t key);
+extern void sched_group_print(void);
+
+#endif /* !SCHED_GROUP_H */
@@ -0,0 +1,66 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   sched_trace.h                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:11:51 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:13:29 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SCHED_TRACE_H
+#define SCHED_TRACE_H
+
+#include <kernel.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 SCHEDULER TRACE                                ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Scheduler tracepoints (switch, wakeup, fork, exit) record TSC stamped
+** events in a ring buffer per CPU. Each CPU only writes its own buffer,
+** with interrupts disabled.
+**
+** Wakeups stamp the task (sched_wakeup_tsc), the switch that runs it turns
+** the stamp into a wakeup-to-run latency, kept in a log2 histogram.
+*/
+
+#define SCHED_TRACE_EVENTS 512     // Events kept per CPU
+#define SCHED_TRACE_HIST_BUCKETS 16 // Latency buckets: < 1us, < 2us, < 4us ... >= 16ms
+#define SCHED_TRACE_RQ_SLOTS 8      // Time slots of the run queue length report
+#define SCHED_TRACE_TOP_TASKS 16    // Tasks in the switches per second report
+
+typedef enum e_sched_trace_type {
+    SCHED_TRACE_SWITCH, // pid: task switched in, arg: task switched out
+    SCHED_TRACE_WAKEUP, // pid: task woken, arg: waker
+    SCHED_TRACE_FORK,   // pid: child, arg: parent
+    SCHED_TRACE_EXIT,   // pid: task, arg: exit code
+    SCHED_TRACE_TYPE_COUNT
+} sched_trace_type_t;
+
+typedef struct s_sched_trace_event {
+    uint64_t tsc;
+    uint8_t type;
+    uint8_t cpu;
+    uint16_t nr_running; // Run queue length of the CPU at the event
+    int32_t pid;
+    int32_t arg;
+} sched_trace_event_t;
+
+struct s_task;
+
+extern volatile bool sched_trace_enabled;
+
+extern void sched_trace_switch(struct s_task *prev, struct s_task *next);
+extern void sched_trace_wakeup(struct s_task *task);
+extern void sched_trace_fork(struct s_task *parent, struct s_task *child);
+extern void sched_trace_exit(struct s_task *task);
+
+extern void sched_trace_reset(void);
+extern void sched_trace_report(void);
+extern void sched_trace_dump_serial(void);
+
+#endif /* !SCHED_TRACE_H */
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/12/07 22:33:26 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/26 20:51:33 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:26:14 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -16,18 +16,23 @@
 #include <memory/memory.h>
 #include <multitasking/process.h>
 
+#include <system/percpu.h>
+#include <system/spinlock.h>
+
 // ! ||--------------------------------------------------------------------------------||
 // ! ||                      MULTILEVEL FEEDBACK QUEUE SCHEDULING                      ||
 // ! ||--------------------------------------------------------------------------------||
 
 // #define __DEBUG__ 1
 
+/* Default admission bound of the task table, see task_set_max() */
 #ifdef __DEBUG__
-#define MAX_TASKS 4
+#define TASK_MAX_DEFAULT 4
 #else
-#define MAX_TASKS 32 // 4 tasks max
+#define TASK_MAX_DEFAULT 1024
 #endif
-#define PID_MAX __INT32_MAX__ // Max pid
+#define PID_MAX 32768      // Pids are 1 .. PID_MAX - 1 (size of the pid bitmap, see pid.c)
+#define PID_HASH_SIZE 256 // Buckets of the pid -> task index, power of 2
 
 #ifdef __DEBUG__
 #define __DEBUG_TASK_FREQUENCY 1
@@ -40,22 +45,96 @@ extern bool scheduler_initialized;
 
 extern void init_scheduler(void);
 
-extern task_t *__process_selector(task_t *current_task);
-extern void __orphans_collector(task_t *current_task);
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 CONTEXT SWITCH                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+typedef struct s_sched_stats {
+    uint32_t switches;    // Context switches done
+    uint32_t cr3_reloads; // Switches that changed the address space
+    uint32_t cr3_skipped; // Switches that kept the address space (no TLB flush)
+} sched_stats_t;
+
+extern sched_stats_t sched_stats;
+
+/* switch_to.s */
+extern void __switch_to(uint32_t *prev_esp, uint32_t next_esp, uint32_t next_cr3);
+extern int32_t __task_fork_context(uint32_t *child_esp, void (*commit)(void *), void *arg);
+
+extern void schedule(void);
+extern void schedule_tail(void);
+extern void scheduler_tick(void);
+extern void task_yield(void);
+
+extern void sched_wakeup(task_t *task);
+extern void sched_sleep(task_t *task);
+extern void resched_cpu(cpu_t *cpu);
+extern void sched_resched_point(void);
+
+extern void sched_init_idle(cpu_t *cpu, bool adopt_context);
+extern void cpu_idle(void);
+
 extern void __process_sleeping(task_t *current_task);
 extern int32_t __process_killer(void);
 extern int32_t __process_zombie(task_t *current_task);
-extern void __process_waiting(void);
-extern void __process_threads(task_t *current_task);
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   RUN QUEUES                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/* Protects the task lists (ready_queue, waiting_queue, state lists), recursive */
+extern rspinlock_t tasklist_lock;
+
+extern void runqueue_enqueue(cpu_t *cpu, task_t *task);
+extern void runqueue_dequeue(task_t *task);
+extern cpu_t *runqueue_select_cpu(task_t *task);
+
+static inline bool runqueue_cpu_allowed(task_t *task, cpu_t *cpu) {
+    return ((task->cpus_allowed >> cpu->id) & 1);
+}
+extern task_t *runqueue_steal(cpu_t *cpu);
+extern void runqueue_link_locked(cpu_t *cpu, task_t *task);
+extern void runqueue_unlink_locked(cpu_t *cpu, task_t *task);
+
+extern cpu_t *task_rq_lock(task_t *task, uint32_t *eflags);
+extern void task_rq_unlock(cpu_t *cpu, uint32_t eflags);
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                SCHEDULING POLICY                               ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief RT priority a task is scheduled at: its own, or the one inherited
+ *        through a PI mutex. 0 for a fair task.
+ */
+static inline uint32_t task_rt_prio(task_t *task) {
+    return (task->pi_rt_priority > task->rt_priority ? task->pi_rt_priority : task->rt_priority);
+}
+
+/**
+ * @brief Scheduling class of a task, from its policy and its PI boost
+ * @note : A SCHED_NORMAL task boosted by an RT waiter runs in the RT class,
+ *         as SCHED_FIFO, until it releases.
+ */
+static inline const sched_class_t *task_sched_class(task_t *task) {
+    return (task_rt_prio(task) ? &rt_sched_class : &fair_sched_class);
+}
+
+extern int32_t sched_setscheduler(pid_t pid, sched_policy_t policy, uint32_t rt_priority);
+extern void sched_set_pi_boost(task_t *task, task_priority_t pi_boost, uint32_t pi_rt_priority);
+extern int32_t sched_getscheduler(pid_t pid);
+extern void sched_move_task(task_t *task, struct s_task_group *tg);
+extern void sched_print_stats(void);
 
 // ! ||--------------------------------------------------------------------------------||
 // ! ||                                     SIGNALS                                    ||
 // ! ||--------------------------------------------------------------------------------||
 
-void __signal_handler(task_t *current_task);
+void __signal_handler(task_t *task);
 
-extern void task_add_signal(task_t *task, int signum, void (*handler)(int));
-extern void task_remove_signal(task_t *task, int signum);
+extern int32_t task_send_signal(task_t *task, int32_t signum);
+extern int32_t task_sigaction(task_t *task, int32_t signum, const sigaction_t *act, sigaction_t *oldact);
+extern int32_t task_sigprocmask(task_t *task, int32_t how, const sigset_t *set, sigset_t *oldset);
 extern void task_print_signals(task_t *task);
 
 // ! ||--------------------------------------------------------------------------------||
@@ -68,6 +147,5 @@ extern void wait_for_scheduler_rounded(void);
 // ! ||                                    OVERFLOW                                    ||
 // ! ||--------------------------------------------------------------------------------||
 
-extern void __task_overflow_handler(void);
 
 #endif /* !SCHEDULER_H */
\ No newline at end of file
@@ -0,0 +1,112 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   wait_queue.h                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:53:57 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:23:18 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef WAIT_QUEUE_H
+#define WAIT_QUEUE_H
+
+#include <kernel.h>
+
+#include <system/spinlock.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   WAIT QUEUES                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** A wait queue holds the tasks blocked until a condition becomes true.
+** Blocked tasks are TASK_BLOCKED: the scheduler never picks them, they use
+** no CPU until wake_up_one() / wake_up_all() makes them runnable again.
+** The links live in task_t (wq, wq_next, wq_prev), a task waits on one
+** queue at a time.
+**
+** Only depends on the task through pointers, so task_t can embed queues
+** (see process.h).
+*/
+
+struct s_task;
+
+typedef struct s_wait_queue {
+    spinlock_t lock;
+    struct s_task *head, *tail; // FIFO of the blocked tasks
+    uint32_t nr_waiters;
+} wait_queue_t;
+
+#define WAIT_QUEUE_INIT {SPINLOCK_INIT, NULL, NULL, 0}
+
+extern void wait_queue_init(wait_queue_t *wq);
+
+extern uint32_t wait_queue_prepare(wait_queue_t *wq, bool idle);
+extern void wait_queue_sleep(void);
+extern void wait_queue_finish(wait_queue_t *wq, uint32_t eflags);
+extern void wait_queue_remove_task(struct s_task *task);
+
+extern uint32_t wake_up_one(wait_queue_t *wq);
+extern uint32_t wake_up_all(wait_queue_t *wq);
+extern uint32_t wake_up_task(wait_queue_t *wq, struct s_task *task);
+extern uint32_t wake_up_highest(wait_queue_t *wq);
+extern int32_t wait_queue_max_priority(wait_queue_t *wq);
+extern uint32_t wait_queue_max_rt_priority(wait_queue_t *wq);
+
+extern uint32_t wait_queue_deadline(uint32_t ms);
+extern void wait_queue_set_deadline(uint32_t deadline);
+extern bool wait_queue_expired(uint32_t deadline);
+extern void wait_queue_expire(void);
+
+/**
+ * @brief Block the current task until 'condition' is true
+ * @note : The condition is tested again once the task is queued with
+ *         interrupts disabled, so a wake up between the test and the
+ *         switch is never lost. Wakers must make the condition true
+ *         before calling wake_up_*().
+ *         The loop stops on the first true evaluation: the condition may
+ *         have side effects (trylock, claim).
+ */
+#define __wait_event(wq, condition, idle)                          \
+    do {                                                           \
+        if (condition)                                             \
+            break;                                                 \
+        for (;;) {                                                 \
+            uint32_t __wq_eflags = wait_queue_prepare((wq), idle); \
+            bool __wq_done = (condition);                          \
+                                                                   \
+            if (!__wq_done)                                        \
+                wait_queue_sleep();                                \
+            wait_queue_finish((wq), __wq_eflags);                  \
+            if (__wq_done)                                         \
+                break;                                             \
+        }                                                          \
+    } while (0)
+
+#define wait_event(wq, condition) __wait_event(wq, condition, false)
+
+/**
+ * @brief wait_event() for a wait of unbounded length by design (parked
+ *        task, parent waiting for its children, futex)
+ * @note : Never reported by the hung task watchdog (see watchdog.h).
+ */
+#define wait_event_idle(wq, condition) __wait_event(wq, condition, true)
+
+/**
+ * @brief wait_event_idle() giving up once timer_subtick reaches 'deadline'
+ *        (see wait_queue_deadline(), 0: no deadline)
+ * @note : The scheduler housekeeping wakes the task at the deadline (see
+ *         wait_queue_expire()). The caller tells a timeout from a wake up
+ *         by testing its condition again.
+ */
+#define wait_event_idle_deadline(wq, condition, deadline)                     \
+    do {                                                                      \
+        wait_queue_set_deadline(deadline);                                    \
+        __wait_event(wq, (condition) || wait_queue_expired(deadline), true); \
+        wait_queue_set_deadline(0);                                           \
+    } while (0)
+
+#endif /* !WAIT_QUEUE_H */
@@ -0,0 +1,64 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   watchdog.h                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:56:08 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:57:43 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <kernel.h>
+#include <system/percpu.h>
+#include <system/pit.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    WATCHDOG                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Run from the timer interrupt of every CPU (watchdog_tick()):
+**
+** - Soft lockup: schedule() did not run on a CPU for WATCHDOG_SOFTLOCKUP_SECS,
+**   although its timer ticks. Something holds it with preemption disabled
+**   (spinlock, RCU read section) or loops in a path that never schedules.
+**   The CPU reports itself: task, EIP of the interrupted code, stack scan.
+**   The BSP also reports the CPUs whose timer stopped ticking (interrupts
+**   left disabled), without EIP.
+**
+** - Hung task: a task blocked on a wait queue for WATCHDOG_HUNG_TASK_SECS,
+**   scanned by the BSP every WATCHDOG_HUNG_CHECK_SECS. wait_event_idle()
+**   waits (parked tasks, waitpid, futexes) may last forever, skipped.
+**
+** Reports go to COM1, once per lockup / per blocked wait. There are no
+** frame pointers (-O2): the stack scan prints every kernel text address
+** found on the stack, some of them stale ('?'), resolve them with addr2line.
+*/
+
+#define __WATCHDOG_PANIC__ false // Panic on a soft lockup / hung task instead of reporting it
+
+#define WATCHDOG_SOFTLOCKUP_SECS 10 // CPU without schedule() for that long
+#define WATCHDOG_HUNG_TASK_SECS 30  // Task blocked for that long
+#define WATCHDOG_HUNG_CHECK_SECS 5  // Period of the hung task scan
+#define WATCHDOG_STACK_ENTRIES 16   // Text addresses printed by a stack scan
+
+struct regs;
+
+extern volatile bool watchdog_enabled;
+
+extern void watchdog_tick(struct regs *r);
+
+/**
+ * @brief The scheduler ran on 'cpu' (schedule())
+ */
+static inline void watchdog_touch(cpu_t *cpu) {
+    cpu->watchdog_touch = (uint32_t)timer_get_jiffies();
+    cpu->watchdog_reported = false;
+}
+
+#endif /* !WATCHDOG_H */
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.Fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/09/05 01:10:02 by vvaucoul          #+#    #+#             */
-/*   Updated: 2022/12/10 00:17:07 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:52:53 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -15,7 +15,7 @@
 
 #include <shell/ksh_args.h>
 
-#define __NB_BUILTINS_ 0x0E
+#define __NB_BUILTINS_ 0x14
 #define __BUILTINS_MAX_NAMES 0x04
 #define __BUILTINS_MAX_NAME_LENGTH 0x80
 
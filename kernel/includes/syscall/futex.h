@@ -0,0 +1,54 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   futex.h                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:59:22 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:23:18 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <kernel.h>
+#include <multitasking/process.h>
+
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+
+#define FUTEX_HASH_SIZE 64 // Wait buckets, power of 2
+
+#define FUTEX_ETIMEDOUT -2 // FUTEX_WAIT: the timeout expired before a wake up
+
+/*
+ * futex() - Fast userspace locking.
+ *
+ * Returns:
+ *   - FUTEX_WAIT: 0 once woken, -1 if *uaddr != val (nothing to wait for),
+ *     FUTEX_ETIMEDOUT if timeout_ms (0: none) expired first.
+ *   - FUTEX_WAKE: the number of tasks woken (at most val).
+ *   - On failure: -1, indicating an error occurred.
+ *
+ * Description:
+ *   Futexes let user libraries build mutexes and condition variables whose
+ *   uncontended path is a single atomic operation on a shared word, the
+ *   kernel is only entered to sleep or to wake sleepers.
+ *
+ *   FUTEX_WAIT sleeps as long as *uaddr still holds val (checked atomically
+ *   against FUTEX_WAKE), or until timeout_ms elapsed. FUTEX_WAKE wakes up to
+ *   val tasks waiting on uaddr, timeout_ms is ignored.
+ *   Waiters are keyed by the physical address of uaddr, so tasks sharing a
+ *   page in different address spaces meet on the same futex.
+ */
+
+extern int futex(uint32_t *uaddr, int op, uint32_t val, uint32_t timeout_ms);
+
+extern int futex_wait(uint32_t *uaddr, uint32_t val);
+extern int futex_wait_timeout(uint32_t *uaddr, uint32_t val, uint32_t timeout_ms);
+extern int futex_wake(uint32_t *uaddr, uint32_t nr);
+extern void futex_remove_task(task_t *task);
+
+#endif /* !FUTEX_H */
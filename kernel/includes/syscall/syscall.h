@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/12/07 22:30:56 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/20 13:31:35 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:23:18 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -17,6 +17,7 @@
 
 #include <syscall/exit.h>
 #include <syscall/fork.h>
+#include <syscall/futex.h>
 #include <syscall/kill.h>
 #include <syscall/wait.h>
 
@@ -28,6 +29,7 @@ All x86 syscall: https://chromium.googlesource.com/chromiumos/docs/+/master/cons
 #define SYSCALL_IRQ 0x7F
 
 typedef void sysfn_t;
+typedef int32_t (*syscall_fn_t)(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
 
 typedef struct s_syscall {
     uint32_t id;
@@ -181,7 +183,7 @@ extern void init_syscall(void);
 #define __NR_wait 0x21
 /*
 ** EAX: 0x21
-** EBX: int pid
+** EBX: int *status
 ** ECX: 0x00
 ** EDX: 0x00
 ** ESI: 0x00
@@ -194,8 +196,8 @@ extern void init_syscall(void);
 /*
 ** EAX: 0x22
 ** EBX: int pid
-** ECX: int options
-** EDX: int status
+** ECX: int *status
+** EDX: int options
 ** ESI: 0x00
 ** EDI: 0x00
 ** EBP: 0x00
@@ -225,4 +227,40 @@ extern void init_syscall(void);
 ** EBP: 0x00
 */
 
+#define SYSCALL_SCHED_SETSCHEDULER 0x9C
+#define __NR_sched_setscheduler 0x9C
+/*
+** EAX: 0x9C
+** EBX: pid_t pid (0: current task)
+** ECX: int policy (SCHED_NORMAL / SCHED_FIFO / SCHED_RR)
+** EDX: uint32_t rt_priority (0 for SCHED_NORMAL)
+** ESI: 0x00
+** EDI: 0x00
+** EBP: 0x00
+*/
+
+#define SYSCALL_SCHED_GETSCHEDULER 0x9D
+#define __NR_sched_getscheduler 0x9D
+/*
+** EAX: 0x9D
+** EBX: pid_t pid (0: current task)
+** ECX: 0x00
+** EDX: 0x00
+** ESI: 0x00
+** EDI: 0x00
+** EBP: 0x00
+*/
+
+#define SYSCALL_FUTEX 0xF0
+#define __NR_futex 0xF0
+/*
+** EAX: 0xF0
+** EBX: uint32_t *uaddr
+** ECX: int op (FUTEX_WAIT / FUTEX_WAKE)
+** EDX: uint32_t val
+** ESI: uint32_t timeout_ms (FUTEX_WAIT, 0: no timeout)
+** EDI: 0x00
+** EBP: 0x00
+*/
+
 #endif /* !SYSCALL_H */
\ No newline at end of file
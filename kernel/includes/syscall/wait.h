@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/20 12:23:27 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/20 12:24:36 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:58:34 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -31,7 +31,10 @@
  *
  *   The waitpid() function is a variation of wait() that provides more control
  *   over which child process to wait for and how to retrieve information about
- *   its termination.
+ *   its termination. With WNOHANG, it returns 0 instead of blocking when no
+ *   child has exited yet.
+ *
+ *   The caller sleeps until a child exits, the child is reaped right away.
  */
 
 extern pid_t wait(int *status);
@@ -0,0 +1,88 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   apic.h                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:34:56 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:25:27 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef APIC_H
+#define APIC_H
+
+#include <kernel.h>
+#include <system/isr.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   LOCAL APIC                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+#define LAPIC_DEFAULT_BASE 0xFEE00000
+#define LAPIC_MMIO_SIZE 0x1000
+
+#define IA32_APIC_BASE_MSR 0x1B
+#define IA32_APIC_BASE_BSP (1 << 8)
+#define IA32_APIC_BASE_ENABLE (1 << 11)
+
+/* Registers (offsets from the LAPIC base) */
+#define LAPIC_ID 0x020
+#define LAPIC_VERSION 0x030
+#define LAPIC_TPR 0x080
+#define LAPIC_EOI 0x0B0
+#define LAPIC_SVR 0x0F0
+#define LAPIC_ESR 0x280
+#define LAPIC_ICR_LOW 0x300
+#define LAPIC_ICR_HIGH 0x310
+#define LAPIC_LVT_TIMER 0x320
+#define LAPIC_LVT_LINT0 0x350
+#define LAPIC_LVT_LINT1 0x360
+#define LAPIC_LVT_ERROR 0x370
+#define LAPIC_TIMER_INIT 0x380
+#define LAPIC_TIMER_CURRENT 0x390
+#define LAPIC_TIMER_DIVIDE 0x3E0
+
+#define LAPIC_SVR_ENABLE 0x100
+#define LAPIC_LVT_MASKED 0x10000
+#define LAPIC_TIMER_PERIODIC 0x20000
+#define LAPIC_TIMER_DIVIDE_16 0x3
+
+/* Interrupt Command Register */
+#define LAPIC_ICR_INIT 0x500
+#define LAPIC_ICR_STARTUP 0x600
+#define LAPIC_ICR_PENDING 0x1000
+#define LAPIC_ICR_LEVEL_ASSERT 0x4000
+#define LAPIC_ICR_LEVEL_TRIGGER 0x8000
+#define LAPIC_ICR_DEST_SHIFT 24
+
+#define LAPIC_TIMER_VECTOR 0x30    // First vector after the PIC IRQs
+#define LAPIC_RESCHED_VECTOR 0x31  // Reschedule IPI (see resched_cpu())
+#define LAPIC_SPURIOUS_VECTOR 0xFF
+
+#define LAPIC_CALIBRATE_US 10000 // Timer ticks counted over 10ms
+
+extern uint32_t lapic_base;
+
+extern bool lapic_detect(void);
+extern void lapic_install(void);
+extern void lapic_init(void);
+extern uint8_t lapic_id(void);
+extern void lapic_eoi(void);
+
+extern void lapic_send_init(uint8_t apic_id);
+extern void lapic_send_startup(uint8_t apic_id, uint32_t trampoline);
+extern void lapic_send_resched(uint8_t apic_id);
+
+extern void lapic_timer_calibrate(void);
+extern void lapic_timer_start(uint32_t hz);
+extern void lapic_timer_handler(struct regs *r);
+extern void lapic_resched_handler(struct regs *r);
+
+/* lapic_handler.s */
+extern void lapic_timer_irq(void);
+extern void lapic_resched_irq(void);
+extern void lapic_spurious_irq(void);
+
+#endif /* !APIC_H */
@@ -0,0 +1,73 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   clocksource.h                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:20:37 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:32:50 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CLOCKSOURCE_H
+#define CLOCKSOURCE_H
+
+#include <kernel.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   CLOCKSOURCE                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+#define NSEC_PER_USEC 1000UL
+#define NSEC_PER_MSEC 1000000UL
+#define NSEC_PER_SEC 1000000000ULL
+
+#define CLOCKSOURCE_CALIBRATE_MS 10 // PIT channel 2 gate used to calibrate the TSC
+#define CLOCKSOURCE_CALIBRATE_LOOPS 3 // Keep the fastest of N calibrations
+#define CLOCKSOURCE_CALIBRATE_SPINS 1000000 // Port 0x61 polls before giving up on channel 2 (~1s)
+
+typedef enum e_clocksource_type {
+    CLOCKSOURCE_JIFFIES, // Fallback: PIT ticks, TIMER_PHASE resolution
+    CLOCKSOURCE_TSC      // Time Stamp Counter, calibrated against PIT channel 2
+} clocksource_type_t;
+
+typedef struct s_clocksource {
+    clocksource_type_t type;
+    uint32_t tsc_khz;   // Calibrated TSC frequency
+    uint32_t mult;      // ns = (cycles * mult) >> shift
+    uint32_t shift;
+    uint64_t tsc_base;  // TSC value at calibration time (ktime origin)
+    uint64_t wall_base; // Wall clock (ns since epoch) read from the CMOS at boot
+} clocksource_t;
+
+extern clocksource_t clocksource;
+
+extern void clocksource_init(void);
+
+/**
+ * @brief Monotonic time since boot in nanoseconds
+ * @note : Lock-free (seqlock read side), costs a single rdtsc once the TSC
+ *         is calibrated
+ */
+extern uint64_t ktime_get(void);
+
+/**
+ * @brief Wall clock time in nanoseconds since the epoch
+ */
+extern uint64_t ktime_get_real(void);
+
+/**
+ * @brief Cheap timestamp for the scheduler (accounting, tracing)
+ * @note : Raw TSC cycles once calibrated, ktime (ns) before or without it.
+ *         Only differences matter, see sched_clock_to_ns().
+ */
+extern uint64_t sched_clock(void);
+extern uint64_t sched_clock_to_ns(uint64_t delta);
+
+extern uint64_t clocksource_cycles_to_ns(uint64_t cycles);
+extern uint64_t clocksource_ns_to_cycles(uint64_t ns);
+extern uint32_t clocksource_get_tsc_khz(void);
+extern void clocksource_udelay(uint32_t usec);
+
+#endif /* !CLOCKSOURCE_H */
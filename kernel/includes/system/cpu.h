@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/12/10 13:11:26 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/05/29 09:45:29 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:40:39 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -162,6 +162,37 @@ extern void get_cpu_topology(void);
 ** ============================= CPU FREQUENCY ================================
 */
 
-extern double get_cpu_frequency();
+/**
+ * @brief Read the Time Stamp Counter
+ */
+static inline uint64_t rdtsc(void) {
+    uint32_t low, high;
+
+    __asm__ volatile("rdtsc"
+                     : "=a"(low), "=d"(high));
+    return (((uint64_t)high << 32) | low);
+}
+
+/*
+** ================================= MSR ======================================
+*/
+
+static inline uint64_t rdmsr(uint32_t msr) {
+    uint32_t low, high;
+
+    __asm__ volatile("rdmsr"
+                     : "=a"(low), "=d"(high)
+                     : "c"(msr));
+    return (((uint64_t)high << 32) | low);
+}
+
+static inline void wrmsr(uint32_t msr, uint64_t value) {
+    __asm__ volatile("wrmsr" ::"c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+/**
+ * @brief CPU frequency in MHz, derived from the calibrated TSC (see clocksource.c)
+ */
+extern uint32_t get_cpu_frequency(void);
 
 #endif /* !CPU_H */
\ No newline at end of file
@@ -6,18 +6,49 @@
 /*   By: vvaucoul <vvaucoul@student.42.Fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/09/04 16:53:46 by vvaucoul          #+#    #+#             */
-/*   Updated: 2022/12/09 22:34:50 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:40:39 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #ifndef FPU_H
 #define FPU_H
 
+#include <kernel.h>
+
 #define __FPU_INIT 0x37F
 #define __FPU_INVALID_OPERAND 0x37E
 #define __FPU_DIVIDE_BY_ZERO 0x37A
 
+#define __MXCSR_INIT 0x1F80
+
+#define CR0_MP (1 << 1) // Monitor co-processor: 'wait' honours TS
+#define CR0_EM (1 << 2) // Emulation: must be clear to use x87/SSE
+#define CR0_TS (1 << 3) // Task switched: next FPU instruction raises #NM
+#define CR0_NE (1 << 5) // Native x87 error reporting
+
+#define CR4_OSFXSR (1 << 9)      // FXSAVE/FXRSTOR + SSE enabled
+#define CR4_OSXMMEXCPT (1 << 10) // Unmasked SSE exceptions raise #XM
+
+#define FPU_STATE_SIZE 512 // FXSAVE area (FNSAVE only uses the first 108 bytes)
+#define FPU_STATE_ALIGN 16 // FXSAVE requires a 16-byte aligned area
+
+#define FPU_NM_INTERRUPT 0x07 // #NM: Device Not Available
+
+struct s_task;
+
 /* Enable Float Point Units */
 void enable_fpu(void);
 
-#endif /* !FPU_H */
\ No newline at end of file
+/*
+** Lazy FPU switching:
+** - every context switch only sets CR0.TS,
+** - the first FPU/SSE instruction of a task traps (#NM), the handler saves
+**   the previous owner's registers and loads (or creates) the task's ones.
+** Tasks that never touch the FPU never pay for a save/restore.
+*/
+extern void fpu_init_cpu(void);
+extern void fpu_switch(struct s_task *prev, struct s_task *next);
+extern void fpu_fork(struct s_task *parent, struct s_task *child);
+extern void fpu_release(struct s_task *task);
+
+#endif /* !FPU_H */
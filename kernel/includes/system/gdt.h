@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 18:48:02 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 12:17:10 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:40:39 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -147,5 +147,6 @@ extern void print_gdt(void);
 extern void gdt_test(void);
 
 extern void gdt_add_entry(uint8_t index, uint32_t base, uint32_t limit, uint8_t access, uint8_t granularity);
+extern void gdt_set_entry(GDTEntry *table, uint8_t index, uint32_t base, uint32_t limit, uint8_t access, uint8_t granularity);
 
 #endif /* !GDT_H_ */
\ No newline at end of file
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.Fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 19:08:45 by vvaucoul          #+#    #+#             */
-/*   Updated: 2022/12/09 21:04:55 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:47:00 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -40,6 +40,7 @@ extern struct idt_ptr idtp;
 extern void idt_load(struct idt_ptr *idtp);
 extern void idt_install();
 extern void idt_set_gate(unsigned char num, unsigned long base, unsigned short selector, unsigned char flags);
+extern void idt_set_task_gate(unsigned char num, unsigned short tss_selector);
 
 extern void push_regs(void);
 extern void pop_regs(void);
@@ -0,0 +1,70 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   irqsoff.h                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:50:54 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:52:52 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef IRQSOFF_H
+#define IRQSOFF_H
+
+#include <kernel.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 IRQS-OFF TRACER                                ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Times the sections run with interrupts disabled. ASM_CLI, ASM_STI and
+** SET_EFLAGS (asm/asm.h) and the irqsave locks report the transitions of
+** the interrupt flag: a section starts at the cli clearing IF and ends where
+** IF is set back, both stamped with the TSC.
+**
+** The end is not always in the code that started it: after a context
+** switch the next task restores its own flags, a preempted task gets them
+** back through the iret of its interrupt handler (irqsoff_trace_on() from
+** the handlers). A section whose end cannot be seen (first return to user
+** mode) is dropped at the next interrupt and counted as lost.
+**
+** Each CPU keeps the maximum, a log2 histogram (in TSC cycles) and the
+** IRQSOFF_WORST longest sections, one per (start, end) address pair:
+** addr2line on the kernel binary names the code. Interrupt handlers run
+** with IF cleared by their gate, they are not counted.
+*/
+
+#define IRQSOFF_EFLAGS_IF 0x200   // Interrupt flag
+#define IRQSOFF_HIST_SHIFT 10     // First bucket: < 2^11 cycles
+#define IRQSOFF_HIST_BUCKETS 20   // Each bucket doubles, the last one: >= 2^29 cycles
+#define IRQSOFF_WORST 8           // Longest sections kept per CPU
+
+typedef struct s_irqsoff_section {
+    uint64_t cycles;
+    void *start_ip; // Code that disabled interrupts
+    void *end_ip;   // Code that enabled them back
+    int32_t pid;    // Task running at the start
+} irqsoff_section_t;
+
+extern volatile bool irqsoff_trace_enabled;
+
+extern void irqsoff_init(void);
+
+/**
+ * @brief Hooks of the code toggling IF without ASM_CLI / SET_EFLAGS
+ * @note : trace_off: a cli just ran, 'eflags' are the flags before it.
+ *         trace_on: 'eflags' are about to be restored (IF still clear).
+ *         irq_enter: 'eflags' of the interrupted context.
+ */
+extern void irqsoff_trace_off(uint32_t eflags, void *ip);
+extern void irqsoff_trace_on(uint32_t eflags, void *ip);
+extern void irqsoff_irq_enter(uint32_t eflags);
+
+extern void irqsoff_reset(void);
+extern void irqsoff_report(void);
+extern void irqsoff_dump_serial(void);
+
+#endif /* !IRQSOFF_H */
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.Fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 19:16:02 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/02/12 12:39:13 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:58:34 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -75,6 +75,7 @@
 
 #define IDT_SELECTOR 0x08
 #define IDT_FLAG_GATE 0x8E
+#define IDT_FLAG_USER_GATE 0xEE // Interrupt gate callable from ring 3 (int 0x80)
 
 #define ISR_MAX_COUNT 32
 
@@ -172,6 +173,7 @@ extern void isr28(); // Reserved
 extern void isr29(); // Reserved
 extern void isr30(); // Reserved
 extern void isr31(); // Reserved
+extern void isr128(); // System call (int 0x80)
 
 extern unsigned char *exception_messages[ISR_MAX_COUNT];
 
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/19 11:35:41 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/26 20:48:37 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:55:02 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -16,20 +16,30 @@
 #include <kernel.h>
 
 #include <multitasking/process.h>
+#include <multitasking/wait_queue.h>
+#include <system/spinlock.h>
 
 typedef enum {
     MUTEX_UNLOCKED = 0,
     MUTEX_LOCKED = 1
 } mutex_state_t;
 
+/*
+** Sleeping mutex: contending tasks block on 'waiters' instead of spinning.
+** Must not be taken from an interrupt handler.
+*/
 typedef struct {
-    mutex_state_t state; // Mutex state, 0 = unlocked, 1 = locked
-    uint32_t owner;      // PID of the owner of the mutex, if it is locked
-    task_t *wait_queue;  // Queue of tasks waiting on the mutex
+    spinlock_t lock;             // Protects state and owner
+    volatile mutex_state_t state; // Mutex state, 0 = unlocked, 1 = locked
+    task_t *owner;               // Task owning the mutex, if it is locked
+    wait_queue_t waiters;        // Tasks waiting on the mutex
 } mutex_t;
 
+#define MUTEX_INIT {SPINLOCK_INIT, MUTEX_UNLOCKED, NULL, WAIT_QUEUE_INIT}
+
 void init_mutex(mutex_t *mutex);
 void acquire_mutex(mutex_t *mutex);
+bool try_acquire_mutex(mutex_t *mutex);
 void release_mutex(mutex_t *mutex);
 
 // ! ||--------------------------------------------------------------------------------||
@@ -37,6 +47,7 @@ void release_mutex(mutex_t *mutex);
 // ! ||--------------------------------------------------------------------------------||
 
 #define mutex_lock(mutex) acquire_mutex(mutex)
+#define mutex_trylock(mutex) try_acquire_mutex(mutex)
 #define mutex_unlock(mutex) release_mutex(mutex)
 
-#endif /* !MUTEX_H */
\ No newline at end of file
+#endif /* !MUTEX_H */
@@ -0,0 +1,125 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   percpu.h                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:32:25 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:57:44 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef PERCPU_H
+#define PERCPU_H
+
+#include <kernel.h>
+
+#include <multitasking/sched_class.h>
+
+#include <system/gdt.h>
+#include <system/spinlock.h>
+#include <system/tss.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  PER-CPU DATA                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Every CPU owns a cpu_t. Its GDT has one more data segment (PERCPU_SELECTOR)
+** whose base is the CPU's own cpu_t: %fs is loaded with it on every CPU, so
+** this_cpu() is a single load and needs no CPU id lookup.
+**
+** GDT layout (per CPU):
+**   0-6 : shared kernel/user segments (see gdt.c)
+**   7-8 : TSS of the CPU
+**   9   : per-CPU data segment
+**   10  : double fault TSS (task gate of #DF, see kstack.h)
+*/
+
+#define PERCPU_MAX_CPUS 8
+
+#define PERCPU_TSS_INDEX 7
+#define PERCPU_GDT_INDEX 9
+#define PERCPU_DF_TSS_INDEX 10
+#define PERCPU_GDT_ENTRIES (PERCPU_DF_TSS_INDEX + 1)
+
+#define PERCPU_TSS_SELECTOR (PERCPU_TSS_INDEX * 8)       // 0x38
+#define PERCPU_SELECTOR (PERCPU_GDT_INDEX * 8)           // 0x48
+#define PERCPU_DF_TSS_SELECTOR (PERCPU_DF_TSS_INDEX * 8) // 0x50
+
+#define PERCPU_DF_STACK_SIZE 0x800 // Stack of the double fault task
+
+#define PERCPU_TSS_ACCESS 0x89  // Present, ring 0, 32-bit available TSS
+#define PERCPU_DATA_FLAGS 0x40  // 32-bit segment, byte granularity
+
+struct s_task;
+struct s_page_directory;
+
+typedef struct s_runqueue {
+    spinlock_t lock;
+    cfs_rq_t cfs;        // SCHED_NORMAL tasks runnable on this CPU
+    rt_rq_t rt;          // SCHED_FIFO / SCHED_RR tasks homed on this CPU
+    uint32_t nr_tasks;   // Tasks homed on this CPU, whatever their class and state
+    uint32_t nr_running; // RUNNING tasks seen by the last pick (load estimate)
+} runqueue_t;
+
+typedef struct s_cpu {
+    struct s_cpu *self; // Must stay first: this_cpu() reads it through %fs:0
+
+    uint32_t id;      // Logical id (index in cpus[]), 0 is the BSP
+    uint8_t apic_id;  // Local APIC id, target of the INIT / SIPI IPIs
+    volatile bool online;
+
+    struct s_task *current;             // Task running on this CPU
+    struct s_task *idle;                // Runs when nothing else is runnable
+    struct s_task *switch_prev;         // Switched out task, released by schedule_tail()
+    struct s_page_directory *directory; // Page directory loaded in CR3
+
+    struct s_task *fpu_owner; // Task whose FPU state lives in this CPU registers
+    bool fpu_ts_set;          // CR0.TS known to be set
+
+    runqueue_t rq;
+
+    tss_entry_t *tss;         // tss_entry on the BSP, tss_storage on the APs
+    tss_entry_t tss_storage;
+    tss_entry_t df_tss;       // Double fault task, runs on its own stack
+    GDTEntry gdt[PERCPU_GDT_ENTRIES];
+    GDTPtr gdt_ptr;
+
+    uint32_t boot_stack; // AP boot stack, becomes the idle task stack
+
+    uint64_t ticks;  // Local timer ticks
+    uint32_t steals; // Tasks pulled from other run queues
+
+    volatile uint32_t preempt_count; // Preemption disabled sections entered (see preempt.h)
+    volatile uint32_t rcu_nesting;   // RCU read sections entered, no switch while > 0
+    volatile bool need_resched;      // schedule() must run at the next preemption point
+
+    volatile uint32_t watchdog_touch; // Jiffies at the last schedule() (see watchdog.h)
+    volatile uint32_t watchdog_tick;  // Jiffies at the last timer tick of the CPU
+    volatile bool watchdog_reported;  // Soft lockup reported, until the next schedule()
+} cpu_t;
+
+extern cpu_t cpus[PERCPU_MAX_CPUS];
+extern uint32_t cpu_count;
+
+/**
+ * @brief Per-CPU data of the CPU running this code
+ * @note : volatile, never cached by the compiler: a task may be migrated
+ *         between two calls.
+ */
+static inline cpu_t *this_cpu(void) {
+    cpu_t *cpu;
+
+    __asm__ volatile("movl %%fs:0, %0"
+                     : "=r"(cpu));
+    return (cpu);
+}
+
+extern void percpu_init_bsp(void);
+extern void percpu_init_ap(cpu_t *cpu);
+extern void percpu_load_segment(void);
+extern void percpu_install_double_fault(cpu_t *cpu, GDTEntry *table);
+
+#endif /* !PERCPU_H */
@@ -0,0 +1,66 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pi_mutex.h                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:01:46 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:15:35 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef PI_MUTEX_H
+#define PI_MUTEX_H
+
+#include <kernel.h>
+
+#include <multitasking/process.h>
+#include <multitasking/wait_queue.h>
+
+#define PI_MUTEX_SPIN_LOOPS 1000 // Spins while the owner runs on another CPU
+#define PI_MUTEX_CHAIN_MAX 8     // Owners boosted through nested PI mutexes
+
+/*
+** Priority inheritance mutex: while a task sleeps on it, the owner runs at
+** (at least) the waiter's priority, so a realtime task is never held behind
+** lower priority tasks preempting the owner. An RT waiter lends its RT
+** level: the owner is scheduled in the RT class (see sched_set_pi_boost()).
+** Contention spins first while the owner is running on another CPU, then
+** sleeps. Waiters are woken highest priority first.
+*/
+
+typedef struct s_pi_mutex_stats {
+    uint32_t acquisitions;
+    uint32_t contended;     // Acquisitions that had to wait
+    uint32_t spin_acquired; // Contended acquisitions won while spinning
+    uint32_t sleeps;        // Contended acquisitions that slept
+    uint32_t boosts;        // Owner priority boosts
+    uint64_t hold_total_ns, hold_max_ns;
+    uint64_t wait_total_ns, wait_max_ns;
+} pi_mutex_stats_t;
+
+typedef struct s_pi_mutex {
+    volatile bool locked;
+    task_t *owner;
+    uint64_t locked_at; // ktime the owner took it
+    wait_queue_t waiters;
+
+    struct s_pi_mutex *held_next; // Next PI mutex held by the owner
+
+    const char *name;
+    pi_mutex_stats_t stats;
+    struct s_pi_mutex *list_next; // Registered mutexes (lockstat)
+} pi_mutex_t;
+
+extern void pi_mutex_init(pi_mutex_t *mutex, const char *name);
+extern void pi_mutex_destroy(pi_mutex_t *mutex);
+
+extern void pi_mutex_lock(pi_mutex_t *mutex);
+extern bool pi_mutex_trylock(pi_mutex_t *mutex);
+extern void pi_mutex_unlock(pi_mutex_t *mutex);
+
+extern void pi_mutex_get_stats(pi_mutex_t *mutex, pi_mutex_stats_t *stats);
+extern void pi_mutex_print_stats(void);
+
+#endif /* !PI_MUTEX_H */
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 20:06:54 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/23 20:12:16 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:21:49 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -21,6 +21,14 @@
 
 #define PIT_CMDREG 0x43 // PIT Chip's Command Register Port
 
+#define PIT_CHANNEL_0_DATA 0x40 // Channel 0 data port (IRQ0 timer)
+#define PIT_CHANNEL_2_DATA 0x42 // Channel 2 data port (speaker / calibration)
+#define PIT_CHANNEL_2_GATE 0x61 // Keyboard controller port B: channel 2 gate & output
+
+#define PIT_GATE_CHANNEL_2 0x01 // Bit 0: channel 2 gate
+#define PIT_GATE_SPEAKER 0x02   // Bit 1: speaker data enable
+#define PIT_GATE_OUT_2 0x20     // Bit 5: channel 2 output (read-only)
+
 #define PIT_CHANNEL_0 0x00               // 00......
 #define PIT_CHANNEL_1 0x40               // 01......
 #define PIT_CHANNEL_2 0x80               // 10......
@@ -62,6 +70,9 @@ extern void kpause(void);
 
 extern uint32_t timer_ticks;
 extern uint32_t timer_subtick;
+extern uint64_t timer_jiffies;
+
+extern uint64_t timer_get_jiffies(void);
 
 extern void timer_display_ktimer(void);
 
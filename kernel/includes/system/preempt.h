@@ -0,0 +1,83 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   preempt.h                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:43:43 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:46:31 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef PREEMPT_H
+#define PREEMPT_H
+
+#include <kernel.h>
+
+#include <system/percpu.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                KERNEL PREEMPTION                               ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Kernel code is preemptible: the timer (or a wake up) may switch tasks
+** anywhere, unless this CPU is in a section that must not switch:
+** - preempt_count > 0: preempt_disable() sections and spinlocks held
+** - rcu_nesting > 0: RCU read sections (see rcu.h)
+** - interrupts disabled
+** A switch asked for inside such a section only sets need_resched, it runs
+** once the section ends: at preempt_enable(), rcu_read_unlock() or at the
+** end of the interrupt that asked for it (sched_resched_point()).
+**
+** The count is per CPU: a section must end on the CPU it started on, which
+** it does since it cannot be switched out. Sections must not sleep.
+**
+** Interrupts only need to go off (irqsave) around data an interrupt
+** handler also touches: run queues, wait queues, the heap, ...
+*/
+
+#define PREEMPT_EFLAGS_IF 0x200 // Interrupt flag: a deferred switch may only run with it set
+
+extern void preempt_schedule(void);
+
+static inline void preempt_disable(void) {
+    __asm__ volatile("incl %%fs:%c0" ::"i"(__builtin_offsetof(cpu_t, preempt_count))
+                     : "memory");
+}
+
+/**
+ * @brief End a section without running the switch it deferred
+ * @note : For paths about to switch anyway, or with interrupts disabled.
+ */
+static inline void preempt_enable_no_resched(void) {
+    __asm__ volatile("decl %%fs:%c0" ::"i"(__builtin_offsetof(cpu_t, preempt_count))
+                     : "memory");
+}
+
+/**
+ * @brief End a section, run the switch it deferred if any
+ */
+static inline void preempt_enable(void) {
+    preempt_enable_no_resched();
+    if (this_cpu()->need_resched && !this_cpu()->preempt_count)
+        preempt_schedule();
+}
+
+static inline uint32_t preempt_count(void) {
+    return (this_cpu()->preempt_count);
+}
+
+/**
+ * @brief The task running this code may be switched out here
+ * @note : Interrupts are not checked: callers either know they are enabled
+ *         or are at the end of an interrupt.
+ */
+static inline bool preemptible(void) {
+    cpu_t *cpu = this_cpu();
+
+    return (!cpu->preempt_count && !cpu->rcu_nesting);
+}
+
+#endif /* !PREEMPT_H */
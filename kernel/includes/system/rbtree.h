@@ -0,0 +1,69 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   rbtree.h                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:27:19 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:30:02 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef RBTREE_H
+#define RBTREE_H
+
+#include <kernel.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 RED-BLACK TREE                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Intrusive red-black tree: the node is embedded in the object, the caller
+** walks down to the insertion point with its own ordering, links the node
+** with rb_link_node() and rebalances with rb_insert_color(). The leftmost
+** node is cached: rb_first() is O(1).
+**
+** No locking: the owner of the tree serializes every access.
+*/
+
+typedef struct s_rb_node {
+    struct s_rb_node *parent;
+    struct s_rb_node *left, *right;
+    bool red;
+} rb_node_t;
+
+typedef struct s_rb_root {
+    rb_node_t *node;     // Root node, NULL if empty
+    rb_node_t *leftmost; // First node in order, NULL if empty
+} rb_root_t;
+
+#define RB_ROOT_INIT {NULL, NULL}
+
+#define rb_entry(ptr, type, member) ((type *)((uint8_t *)(ptr) - __builtin_offsetof(type, member)))
+
+/**
+ * @brief Link a node at the leaf found by the caller's walk, before rb_insert_color()
+ */
+static inline void rb_link_node(rb_node_t *node, rb_node_t *parent, rb_node_t **link) {
+    node->parent = parent;
+    node->left = node->right = NULL;
+    node->red = true;
+    *link = node;
+}
+
+static inline rb_node_t *rb_first(const rb_root_t *root) {
+    return (root->leftmost);
+}
+
+static inline bool rb_empty(const rb_root_t *root) {
+    return (root->node == NULL);
+}
+
+extern void rb_insert_color(rb_node_t *node, rb_root_t *root, bool leftmost);
+extern void rb_erase(rb_node_t *node, rb_root_t *root);
+extern rb_node_t *rb_last(const rb_root_t *root);
+extern rb_node_t *rb_next(const rb_node_t *node);
+
+#endif /* !RBTREE_H */
@@ -0,0 +1,97 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   rcu.h                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:08:22 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:46:31 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef RCU_H
+#define RCU_H
+
+#include <kernel.h>
+
+#include <system/percpu.h>
+#include <system/preempt.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                       RCU                                      ||
+// ! ||--------------------------------------------------------------------------------||
+
+/*
+** Read-Copy-Update: readers walk shared lists without any lock, writers
+** unlink an object and defer its free with call_rcu() until every reader
+** that could still see it is gone.
+**
+** A read section (rcu_read_lock / rcu_read_unlock) is never preempted:
+** schedule() only sets need_resched and the switch happens when the
+** outermost section ends. A CPU going through schedule() is therefore
+** outside any read section (quiescent state). A grace period ends once
+** every online CPU has been through one: objects unlinked before it
+** started are unreachable and their callbacks run.
+**
+** Read sections must not sleep, and are cheap enough to nest. They are
+** kept apart from preempt_count (see preempt.h): a voluntary schedule()
+** inside one is deferred too, where it is a bug inside a spinlock.
+*/
+
+typedef struct s_rcu_head {
+    struct s_rcu_head *next;
+    void (*func)(struct s_rcu_head *head);
+} rcu_head_t;
+
+/* Object embedding 'member' from a pointer to it (rcu callbacks) */
+#define rcu_entry(ptr, type, member) ((type *)((uint8_t *)(ptr) - __builtin_offsetof(type, member)))
+
+typedef struct s_rcu_stats {
+    uint64_t gp_started;   // Grace periods started
+    uint64_t gp_completed; // Grace periods over
+    uint64_t callbacks;    // Callbacks invoked
+    uint32_t pending;      // Callbacks queued, not invoked yet
+} rcu_stats_t;
+
+extern rcu_stats_t rcu_stats;
+
+extern void call_rcu(rcu_head_t *head, void (*func)(rcu_head_t *head));
+extern void synchronize_rcu(void);
+extern void kfree_rcu(void *ptr);
+
+extern void rcu_note_context_switch(cpu_t *cpu);
+
+/**
+ * @brief Enter a read section
+ * @note : A single instruction on the CPU's own counter: the task cannot be
+ *         preempted between finding its CPU and incrementing it.
+ */
+static inline void rcu_read_lock(void) {
+    __asm__ volatile("incl %%fs:%c0" ::"i"(__builtin_offsetof(cpu_t, rcu_nesting))
+                     : "memory");
+}
+
+/**
+ * @brief Leave a read section, run the switch it deferred if any
+ */
+static inline void rcu_read_unlock(void) {
+    __asm__ volatile("decl %%fs:%c0" ::"i"(__builtin_offsetof(cpu_t, rcu_nesting))
+                     : "memory");
+    if (this_cpu()->need_resched && !this_cpu()->rcu_nesting)
+        preempt_schedule();
+}
+
+/**
+ * @brief Publish a pointer once the object it points to is initialized
+ * @note : x86 keeps stores in order, the compiler must too.
+ */
+#define rcu_assign_pointer(p, v)              \
+    do {                                      \
+        __asm__ volatile("" ::: "memory");    \
+        (p) = (v);                            \
+    } while (0)
+
+#define rcu_dereference(p) (*(__typeof__(p) volatile *)&(p))
+
+#endif /* !RCU_H */
@@ -0,0 +1,49 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   rwlock.h                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:04:59 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:04:59 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+#include <kernel.h>
+#include <system/spinlock.h>
+
+/*
+** Reader-writer spinlock for read-mostly data: any number of readers, or a
+** single writer. Writers have the preference: once a writer waits, new
+** readers back off until it is done, so a steady flow of readers cannot
+** starve it.
+**
+** A reader must not take the same lock again: with a writer waiting in
+** between, it would wait on itself.
+*/
+typedef struct s_rwlock {
+    spinlock_t lock;                  // Protects the fields below
+    volatile int32_t readers;         // Readers inside the critical section
+    volatile bool writer;             // A writer holds the lock
+    volatile uint32_t writers_waiting;
+} rwlock_t;
+
+#define RWLOCK_INIT {SPINLOCK_INIT, 0, false, 0}
+
+extern void rwlock_init(rwlock_t *rw);
+
+extern void read_lock(rwlock_t *rw);
+extern void read_unlock(rwlock_t *rw);
+extern void write_lock(rwlock_t *rw);
+extern void write_unlock(rwlock_t *rw);
+
+extern unsigned int read_lock_irqsave(rwlock_t *rw);
+extern void read_unlock_irqrestore(rwlock_t *rw, unsigned int eflags);
+extern unsigned int write_lock_irqsave(rwlock_t *rw);
+extern void write_unlock_irqrestore(rwlock_t *rw, unsigned int eflags);
+
+#endif /* !RWLOCK_H */
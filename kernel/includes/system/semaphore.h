@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/19 12:06:31 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/19 12:07:04 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:55:02 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -15,10 +15,35 @@
 
 #include <kernel.h>
 #include <multitasking/process.h>
+#include <multitasking/wait_queue.h>
+#include <system/spinlock.h>
 
+#define SEM_VALUE_MAX 0x7FFFFFFF
+
+/*
+** Counting semaphore with POSIX-like sem_* functions (0 on success, -1 on
+** error). sem_wait() blocks on 'waiters' while the value is 0.
+*/
 typedef struct {
-    int32_t value;      // Current value of the semaphore
-    task_t *wait_queue; // Queue of tasks waiting on the semaphore
+    spinlock_t lock;        // Protects value
+    volatile int32_t value; // Current value of the semaphore
+    wait_queue_t waiters;   // Tasks waiting on the semaphore
 } semaphore_t;
 
-#endif /* !SEMAPHORE_H */
\ No newline at end of file
+#define SEMAPHORE_INIT(value) {SPINLOCK_INIT, (value), WAIT_QUEUE_INIT}
+
+int sem_init(semaphore_t *semaphore, int pshared, unsigned int value);
+int sem_wait(semaphore_t *semaphore);
+int sem_trywait(semaphore_t *semaphore);
+int sem_post(semaphore_t *semaphore);
+int sem_getvalue(semaphore_t *semaphore, int *sval);
+int sem_destroy(semaphore_t *semaphore);
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                          Alias for sem_wait and sem_post                       ||
+// ! ||--------------------------------------------------------------------------------||
+
+#define semaphore_down(semaphore) sem_wait(semaphore)
+#define semaphore_up(semaphore) sem_post(semaphore)
+
+#endif /* !SEMAPHORE_H */
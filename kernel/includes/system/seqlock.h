@@ -0,0 +1,91 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   seqlock.h                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:04:59 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:04:59 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <kernel.h>
+#include <system/spinlock.h>
+
+/*
+** Sequence lock: writers serialize on a spinlock and bump the sequence
+** before and after the update (odd while writing). Readers take no lock,
+** they copy the data and retry if the sequence moved:
+**
+**     do {
+**         seq = read_seqbegin(&lock);
+**         copy = data;
+**     } while (read_seqretry(&lock, seq));
+**
+** Readers never block writers, so a writer in an interrupt handler cannot
+** deadlock against a reader it interrupted. Only for plain data that can
+** be copied: a reader may see a torn value before retrying.
+*/
+typedef struct s_seqlock {
+    spinlock_t lock;
+    volatile uint32_t sequence;
+} seqlock_t;
+
+#define SEQLOCK_INIT {SPINLOCK_INIT, 0}
+
+#define __seq_barrier() __asm__ volatile("" ::: "memory")
+
+static inline void write_seqlock(seqlock_t *sl) {
+    spinlock_acquire(&sl->lock);
+    sl->sequence++;
+    __seq_barrier();
+}
+
+static inline void write_sequnlock(seqlock_t *sl) {
+    __seq_barrier();
+    sl->sequence++;
+    spinlock_release(&sl->lock);
+}
+
+static inline unsigned int write_seqlock_irqsave(seqlock_t *sl) {
+    unsigned int eflags = spinlock_acquire_irqsave(&sl->lock);
+
+    sl->sequence++;
+    __seq_barrier();
+    return (eflags);
+}
+
+static inline void write_sequnlock_irqrestore(seqlock_t *sl, unsigned int eflags) {
+    __seq_barrier();
+    sl->sequence++;
+    spinlock_release_irqrestore(&sl->lock, eflags);
+}
+
+/**
+ * @brief Start a lock-free read section
+ * @return Sequence to give back to read_seqretry
+ * @note : Waits for an update in progress to finish (odd sequence).
+ */
+static inline uint32_t read_seqbegin(const seqlock_t *sl) {
+    uint32_t seq;
+
+    while ((seq = sl->sequence) & 1)
+        __asm__ volatile("pause");
+    __seq_barrier();
+    return (seq);
+}
+
+/**
+ * @brief End a read section
+ * @return true if a writer got in and the data must be read again
+ */
+static inline bool read_seqretry(const seqlock_t *sl, uint32_t start) {
+    __seq_barrier();
+    return (sl->sequence != start);
+}
+
+#endif /* !SEQLOCK_H */
@@ -6,13 +6,15 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/19 09:59:11 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/21 22:33:07 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:40:28 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #ifndef SIGNAL_H
 #define SIGNAL_H
 
+#include <kernel.h>
+
 // ! ||--------------------------------------------------------------------------------||
 // ! ||                                   SIGNAL LIST                                  ||
 // ! ||--------------------------------------------------------------------------------||
@@ -105,23 +107,56 @@ typedef enum {
     SIGUNUSED = 31,
 } signal_t;
 
-#define SIGNALS_COUNT 31
+#define SIGNALS_COUNT 32 // Signal numbers 1 .. 31, 0 is not a signal
+
+/*
+** Every task has a pending and a blocked mask, one bit per signal number:
+** - Sending a signal sets its pending bit, a signal already pending is not
+**   queued twice (POSIX coalescing)
+** - At context switch, the deliverable signals are pending & ~blocked, each
+**   one runs the action of the task sigaction table: its handler, nothing
+**   (SIG_IGN) or the default action of the signals table (SIG_DFL)
+** - SIGKILL and SIGSTOP cannot be blocked, caught nor ignored
+*/
+
+typedef uint32_t sigset_t;
+typedef void (*sighandler_t)(int32_t);
+
+#define sigmask(signum) ((sigset_t)1 << (signum))
+#define SIG_UNBLOCKABLE (sigmask(SIGKILL) | sigmask(SIGSTOP))
 
-typedef struct signal_node {
+#define SIG_DFL ((sighandler_t)0) // Default action (signals table)
+#define SIG_IGN ((sighandler_t)1) // Discarded
+
+/* task_sigprocmask() 'how' */
+#define SIG_BLOCK 0
+#define SIG_UNBLOCK 1
+#define SIG_SETMASK 2
+
+typedef struct s_sigaction {
+    sighandler_t sa_handler; // SIG_DFL, SIG_IGN or a kernel handler
+    sigset_t sa_mask;        // Also blocked while the handler runs
+    uint32_t sa_flags;       // Unused yet
+} sigaction_t;
+
+struct s_task;
+
+/**
+ * @brief Default action of a signal, NULL ignores it
+ */
+typedef struct s_signal_default {
     char *name;
     signal_t signum;
-    void (*handler)(int32_t);
-    struct signal_node *next;
-} signal_node_t;
-
-typedef int32_t signal_handler_t;
+    void (*action)(struct s_task *task, int32_t signum);
+} signal_default_t;
 
-extern signal_node_t signals[SIGNALS_COUNT];
+extern signal_default_t signals[SIGNALS_COUNT];
 
 // ! ||--------------------------------------------------------------------------------||
 // ! ||                                    FUNCTIONS                                   ||
 // ! ||--------------------------------------------------------------------------------||
 
+extern bool signal_valid(int32_t signum);
 extern void signal(int pid, int signum);
 extern void init_signals(void);
 
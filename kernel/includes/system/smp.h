@@ -0,0 +1,84 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   smp.h                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:35:52 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 02:47:00 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SMP_H
+#define SMP_H
+
+#include <kernel.h>
+#include <system/percpu.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                       SMP                                      ||
+// ! ||--------------------------------------------------------------------------------||
+
+#define __SMP_ENABLED__ true // Boot the application processors found in the MP table
+
+#define SMP_TRAMPOLINE_ADDR 0x7000 // Page aligned, below 1MB (STARTUP IPI vector 0x07)
+#define SMP_AP_BOOT_TIMEOUT_MS 100 // Give up on an AP not online after this delay
+
+/* Intel MultiProcessor Specification 1.4 */
+#define MP_FLOATING_SIGNATURE 0x5F504D5F // "_MP_"
+#define MP_CONFIG_SIGNATURE 0x504D4350   // "PCMP"
+
+#define MP_ENTRY_PROCESSOR 0
+#define MP_ENTRY_PROCESSOR_SIZE 20
+#define MP_ENTRY_OTHER_SIZE 8
+
+#define MP_PROCESSOR_ENABLED 0x01
+#define MP_PROCESSOR_BSP 0x02
+
+typedef struct s_mp_floating {
+    uint32_t signature;    // "_MP_"
+    uint32_t config;       // Physical address of the configuration table
+    uint8_t length;        // In 16 bytes units
+    uint8_t spec_rev;
+    uint8_t checksum;
+    uint8_t type;          // Default configuration if not 0 (no table)
+    uint8_t features[4];
+} __attribute__((packed)) mp_floating_t;
+
+typedef struct s_mp_config {
+    uint32_t signature; // "PCMP"
+    uint16_t length;
+    uint8_t spec_rev;
+    uint8_t checksum;
+    char oem_id[8];
+    char product_id[12];
+    uint32_t oem_table;
+    uint16_t oem_table_size;
+    uint16_t entry_count;
+    uint32_t lapic_addr;
+    uint16_t ext_length;
+    uint8_t ext_checksum;
+    uint8_t reserved;
+} __attribute__((packed)) mp_config_t;
+
+typedef struct s_mp_processor {
+    uint8_t type; // MP_ENTRY_PROCESSOR
+    uint8_t lapic_id;
+    uint8_t lapic_version;
+    uint8_t flags; // MP_PROCESSOR_ENABLED | MP_PROCESSOR_BSP
+    uint32_t signature;
+    uint32_t features;
+    uint32_t reserved[2];
+} __attribute__((packed)) mp_processor_t;
+
+extern bool smp_enabled;
+
+extern void smp_early_init(void);
+extern void smp_init(void);
+extern void ap_main(uint32_t cpu_id);
+
+extern uint32_t smp_online_cpus(void);
+extern void smp_print_cpus(void);
+
+#endif /* !SMP_H */
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/20 15:05:27 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/23 12:53:18 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:10:44 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -15,6 +15,7 @@
 
 #include <kernel.h>
 #include <system/mutex.h>
+#include <system/rcu.h>
 
 #define SOCKET_BUFFER_MAX 128
 #define MAX_SOCKETS 256
@@ -35,10 +36,13 @@ typedef struct socket {
     socket_flags_t flags;
 
     mutex_t mutex;
+
+    rcu_head_t rcu; // Deferred free, socket_find() callers may still use it
 } socket_t;
 
 socket_t *socket_create(socket_flags_t flags);
 void socket_destroy(socket_t *socket);
+socket_t *socket_find(int id);
 
 extern int socket_send(socket_t *socket, const char *data, int len);
 extern int socket_receive(socket_t *socket, char *buffer, int len);
@@ -6,16 +6,43 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/21 23:19:27 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/21 23:22:24 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:46:31 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #ifndef SPINLOCK_H
 #define SPINLOCK_H
 
+/*
+** Holding a spinlock disables preemption on the CPU (see preempt.h), the
+** irqsave variants disable interrupts too: only needed when an interrupt
+** handler takes the same lock.
+*/
 typedef volatile int spinlock_t;
 
+#define SPINLOCK_INIT 0
+
 extern void spinlock_acquire(spinlock_t *lock);
 extern void spinlock_release(spinlock_t *lock);
+extern int spinlock_try_acquire(spinlock_t *lock);
+
+extern unsigned int spinlock_acquire_irqsave(spinlock_t *lock);
+extern void spinlock_release_irqrestore(spinlock_t *lock, unsigned int eflags);
+
+/*
+** Recursive spinlock: the CPU holding it may take it again (code paths that
+** call back into a locked subsystem). Always irqsave.
+*/
+typedef struct s_rspinlock {
+    spinlock_t lock;
+    volatile int owner; // CPU id of the holder, -1 if free
+    unsigned int depth;
+} rspinlock_t;
+
+#define RSPINLOCK_INIT {SPINLOCK_INIT, -1, 0}
+
+extern unsigned int rspinlock_acquire_irqsave(rspinlock_t *lock);
+extern void rspinlock_release_irqrestore(rspinlock_t *lock, unsigned int eflags);
+extern int rspinlock_held(rspinlock_t *lock);
 
 #endif /* !SPINLOCK_H */
\ No newline at end of file
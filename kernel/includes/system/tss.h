@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/29 18:56:40 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/23 15:45:02 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:47:01 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -88,7 +88,7 @@ typedef volatile struct __tss {
 
 extern tss_entry_t tss_entry;
 
-extern void tss_flush(tss_entry_t *tss_entry);
+extern void tss_flush(uint16_t selector);
 // extern void tss_flush();
 extern void tss_init(uint32_t idx, uint32_t kss, uint32_t kesp);
 extern void tss_set_stack_segment(uint32_t kss);
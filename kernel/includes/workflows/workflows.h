@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/09/28 13:38:18 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/26 20:43:23 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:35:57 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -48,10 +48,37 @@ extern void process_test(void);
 /* Threads test */
 extern void threads_test(void);
 
+/* Context switch benchmark */
+extern void context_switch_test(void);
+
+/* PI mutexes */
+extern void pi_inversion_test(void);
+extern void pi_mutex_test(void);
+
+/* Futex */
+extern void futex_test(void);
+
+/* RCU */
+extern void rcu_test(void);
+
+/* Fair scheduling */
+extern void cfs_test(void);
+extern void fairshare_test(void);
+
 // ! ||--------------------------------------------------------------------------------||
 // ! ||                                      UTILS                                     ||
 // ! ||--------------------------------------------------------------------------------||
 
 extern void task_dummy(void);
 
+/* Spinning kthreads sharing one CPU */
+#define WORKFLOW_SPIN_WARMUP_MS 50 // Every thread is set up before the window opens
+#define WORKFLOW_SPIN_WINDOW_MS 600
+#define WORKFLOW_SPIN_TOLERANCE 50 // Per mille of the window
+#define WORKFLOW_SPIN_MAX 8
+
+typedef void (*workflow_spin_setup_t)(uint32_t id);
+
+extern int32_t workflow_spin_window(uint32_t count, workflow_spin_setup_t setup, uint64_t *runtime, const char *name);
+
 #endif /* !__WORKFLOWS_H */
\ No newline at end of file
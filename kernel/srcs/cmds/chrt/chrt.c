@@ -0,0 +1,85 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   chrt.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:24:57 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:30:03 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <cmds/chrt.h>
+#include <multitasking/scheduler.h>
+
+static void __chrt_usage(void) {
+    printk("Usage: chrt [pid normal | pid fifo prio | pid rr prio | quantum ms | runtime us\n");
+    printk("\t     | latency us | granularity us | wakeup us]\n");
+    printk("\t- no argument: tunables, run queues and RT tasks\n");
+    printk("\t- prio: 1 .. %u, higher runs first\n", SCHED_RT_PRIO_MAX);
+    printk("\t- runtime: RT time per %u us period, >= period disables throttling\n", sched_rt_period_us);
+    printk("\t- latency, granularity, wakeup: CFS target latency, minimum and wakeup granularity\n");
+}
+
+/**
+ * @brief Parse a decimal argument
+ * @return false if the argument is missing or not a number
+ */
+static bool __chrt_parse(const char *arg, uint32_t *value) {
+    if (!arg || !*arg)
+        return (false);
+    *value = 0;
+    for (; *arg; arg++) {
+        if (*arg < '0' || *arg > '9')
+            return (false);
+        *value = *value * 10 + (uint32_t)(*arg - '0');
+    }
+    return (true);
+}
+
+static void __chrt_set(pid_t pid, const char *policy, const char *prio) {
+    uint32_t rt_priority = 0;
+    sched_policy_t p;
+
+    if (strcmp(policy, "normal") == 0)
+        p = SCHED_NORMAL;
+    else if (strcmp(policy, "fifo") == 0)
+        p = SCHED_FIFO;
+    else if (strcmp(policy, "rr") == 0)
+        p = SCHED_RR;
+    else {
+        __chrt_usage();
+        return;
+    }
+
+    if (p != SCHED_NORMAL && !__chrt_parse(prio, &rt_priority))
+        __chrt_usage();
+    else if (sched_setscheduler(pid, p, rt_priority))
+        printk("chrt: cannot set the policy of " _GREEN "[%d]" _END "\n", pid);
+}
+
+/**
+ * @brief Scheduling policy front end
+ */
+void chrt(const ksh_args_t *args) {
+    const char *arg = ksh_get_arg(args, 0);
+    uint32_t value;
+
+    if (arg == NULL)
+        sched_print_stats();
+    else if (strcmp(arg, "quantum") == 0 && __chrt_parse(ksh_get_arg(args, 1), &value) && value)
+        sched_rr_timeslice_ms = value;
+    else if (strcmp(arg, "runtime") == 0 && __chrt_parse(ksh_get_arg(args, 1), &value))
+        sched_rt_runtime_us = value;
+    else if (strcmp(arg, "latency") == 0 && __chrt_parse(ksh_get_arg(args, 1), &value) && value && value < 1000000)
+        sched_latency_ns = value * 1000;
+    else if (strcmp(arg, "granularity") == 0 && __chrt_parse(ksh_get_arg(args, 1), &value) && value && value < 1000000)
+        sched_min_granularity_ns = value * 1000;
+    else if (strcmp(arg, "wakeup") == 0 && __chrt_parse(ksh_get_arg(args, 1), &value) && value < 1000000)
+        sched_wakeup_granularity_ns = value * 1000;
+    else if (__chrt_parse(arg, &value) && ksh_get_arg(args, 1))
+        __chrt_set((pid_t)value, ksh_get_arg(args, 1), ksh_get_arg(args, 2));
+    else
+        __chrt_usage();
+}
@@ -0,0 +1,57 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fairshare.c                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:36:10 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:36:27 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <cmds/fairshare.h>
+#include <multitasking/sched_group.h>
+
+static void __fairshare_usage(void) {
+    printk("Usage: fairshare [id shares | mode uid|gid]\n");
+    printk("\t- no argument: groups, their shares, CPU usage and runnable tasks per CPU\n");
+    printk("\t- shares: %u .. %u, %u by default\n", SCHED_GROUP_SHARES_MIN, SCHED_GROUP_SHARES_MAX, SCHED_GROUP_SHARES_DEFAULT);
+}
+
+/**
+ * @brief Parse a decimal argument
+ * @return false if the argument is missing or not a number
+ */
+static bool __fairshare_parse(const char *arg, uint32_t *value) {
+    if (!arg || !*arg)
+        return (false);
+    *value = 0;
+    for (; *arg; arg++) {
+        if (*arg < '0' || *arg > '9')
+            return (false);
+        *value = *value * 10 + (uint32_t)(*arg - '0');
+    }
+    return (true);
+}
+
+/**
+ * @brief Fair-share groups front end
+ */
+void fairshare(const ksh_args_t *args) {
+    const char *arg = ksh_get_arg(args, 0);
+    const char *mode = ksh_get_arg(args, 1);
+    uint32_t id, shares;
+
+    if (arg == NULL)
+        sched_group_print();
+    else if (strcmp(arg, "mode") == 0 && mode && strcmp(mode, "uid") == 0)
+        sched_group_set_key(SCHED_GROUP_BY_UID);
+    else if (strcmp(arg, "mode") == 0 && mode && strcmp(mode, "gid") == 0)
+        sched_group_set_key(SCHED_GROUP_BY_GID);
+    else if (__fairshare_parse(arg, &id) && __fairshare_parse(ksh_get_arg(args, 1), &shares)) {
+        if (sched_group_set_shares(id, shares))
+            printk("fairshare: cannot set the shares of group " _GREEN "[%u]" _END "\n", id);
+    } else
+        __fairshare_usage();
+}
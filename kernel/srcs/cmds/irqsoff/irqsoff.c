@@ -0,0 +1,40 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   irqsoff.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:50:54 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:52:52 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <cmds/irqsoff.h>
+#include <system/irqsoff.h>
+
+static void __irqsoff_usage(void) {
+    printk("Usage: irqsoff [on | off | reset | dump]\n");
+    printk("\t- no argument: longest interrupts-off sections, histogram and worst callers\n");
+    printk("\t- dump: write the stats to the serial port (COM1)\n");
+}
+
+/**
+ * @brief Interrupts-off latency tracer front end
+ */
+void irqsoff(const ksh_args_t *args) {
+    const char *arg = ksh_get_arg(args, 0);
+
+    if (arg == NULL)
+        irqsoff_report();
+    else if (strcmp(arg, "on") == 0)
+        irqsoff_trace_enabled = true;
+    else if (strcmp(arg, "off") == 0)
+        irqsoff_trace_enabled = false;
+    else if (strcmp(arg, "reset") == 0)
+        irqsoff_reset();
+    else if (strcmp(arg, "dump") == 0)
+        irqsoff_dump_serial();
+    else
+        __irqsoff_usage();
+}
@@ -0,0 +1,22 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   lockstat.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:02:15 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:02:30 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <cmds/lockstat.h>
+#include <system/pi_mutex.h>
+
+/**
+ * @brief Display hold / wait times of the PI mutexes
+ */
+void lockstat(const ksh_args_t *args) {
+    __UNUSED(args);
+    pi_mutex_print_stats();
+}
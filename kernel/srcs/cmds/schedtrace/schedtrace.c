@@ -0,0 +1,40 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   schedtrace.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:13:21 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:13:30 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <cmds/schedtrace.h>
+#include <multitasking/sched_trace.h>
+
+static void __schedtrace_usage(void) {
+    printk("Usage: schedtrace [on | off | reset | dump]\n");
+    printk("\t- no argument: wakeup latency, run queue length and switches per task\n");
+    printk("\t- dump: write the raw trace to the serial port (COM1)\n");
+}
+
+/**
+ * @brief Scheduler latency tracer front end
+ */
+void schedtrace(const ksh_args_t *args) {
+    const char *arg = ksh_get_arg(args, 0);
+
+    if (arg == NULL)
+        sched_trace_report();
+    else if (strcmp(arg, "on") == 0)
+        sched_trace_enabled = true;
+    else if (strcmp(arg, "off") == 0)
+        sched_trace_enabled = false;
+    else if (strcmp(arg, "reset") == 0)
+        sched_trace_reset();
+    else if (strcmp(arg, "dump") == 0)
+        sched_trace_dump_serial();
+    else
+        __schedtrace_usage();
+}
@@ -0,0 +1,91 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   top.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:16:06 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:02:45 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <cmds/top.h>
+#include <multitasking/cpu_acct.h>
+#include <multitasking/process.h>
+#include <system/clocksource.h>
+#include <system/percpu.h>
+#include <system/rcu.h>
+#include <terminal.h>
+
+#include <asm/div64.h>
+
+static const char *top_states[TASK_STATE_COUNT] = {"running", "sleeping", "waiting", "stopped", "zombie", "blocked"};
+
+static uint32_t __top_parse_count(const char *arg) {
+    uint32_t count = 0;
+
+    if (!arg)
+        return (TOP_DEFAULT_REFRESH);
+    while (*arg >= '0' && *arg <= '9')
+        count = count * 10 + (uint32_t)(*arg++ - '0');
+    return (count ? count : TOP_DEFAULT_REFRESH);
+}
+
+static void __top_print_load(const char *label, uint32_t load) {
+    uint32_t frac = LOAD_FRAC(load);
+
+    printk(" %s " _YELLOW "%u.%s%u" _END, label, LOAD_INT(load), frac < 10 ? "0" : "", frac);
+}
+
+static void __top_print_task(task_t *task) {
+    uint32_t usage = get_cpu_load(task);
+
+    printk("Task " _GREEN "[%d]" _END " %s, prio %u, CPU " _YELLOW "%u.%u%s" _END
+           ", user %u ms, sys %u ms, switches %u\n",
+           task->pid, task->state < TASK_STATE_COUNT ? top_states[task->state] : "?", task->priority, usage / 10, usage % 10, "%",
+           (uint32_t)div_u64(cpu_acct_utime_ns(task), NSEC_PER_MSEC), (uint32_t)div_u64(cpu_acct_stime_ns(task), NSEC_PER_MSEC),
+           task->cpu_load.switches);
+}
+
+static void __top_print_idle(cpu_t *cpu) {
+    uint32_t usage = cpu_acct_idle_usage(cpu);
+
+    printk("CPU " _GREEN "[%u]" _END " idle " _YELLOW "%u.%u%s" _END ", idle %u ms, entered %u times\n", cpu->id, usage / 10, usage % 10, "%",
+           (uint32_t)div_u64(cpu_acct_idle_ns(cpu), NSEC_PER_MSEC), cpu->idle ? cpu->idle->cpu_load.switches : 0);
+}
+
+static void __top_refresh(void) {
+    printk("Load average:");
+    __top_print_load("1m", avenrun[0]);
+    __top_print_load("5m", avenrun[1]);
+    __top_print_load("15m", avenrun[2]);
+    printk(" | tasks: %u running, %u blocked\n", task_state_count(TASK_RUNNING), task_state_count(TASK_BLOCKED));
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        if (cpus[i].online)
+            __top_print_idle(&cpus[i]);
+    }
+
+    rcu_read_lock();
+    for (task_t *task = rcu_dereference(ready_queue); task; task = rcu_dereference(task->next))
+        __top_print_task(task);
+    rcu_read_unlock();
+}
+
+/**
+ * @brief Per-task CPU usage, refreshed every second
+ * @note : top [count], TOP_DEFAULT_REFRESH refreshes by default: the shell
+ *         has no way to poll the keyboard yet.
+ */
+void top(const ksh_args_t *args) {
+    uint32_t count = __top_parse_count(ksh_get_arg(args, 0));
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (i) {
+            kmsleep(TOP_REFRESH_MS);
+            CLEAR_SCREEN();
+        }
+        __top_refresh();
+    }
+}
@@ -6,12 +6,14 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/20 09:45:15 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 18:21:34 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:10:44 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <filesystem/initrd.h>
 #include <memory/memory.h>
+#include <system/rcu.h>
+#include <system/rwlock.h>
 
 InitrdHeader *initrd_header;    // The header.
 InitrdFileHeader *file_headers; // The list of file headers.
@@ -22,6 +24,10 @@ uint32_t nroot_nodes;           // Number of file nodes.
 
 struct dirent dirent;
 
+/* Directory tree (parent / childs links): node creation serializes on it,
+** lookups walk the tree locklessly in an RCU read section */
+static rwlock_t initrd_tree_lock = RWLOCK_INIT;
+
 static void initrd_flush(Ext2Inode *node) {
     __UNUSED(node);
 }
@@ -48,17 +54,23 @@ static struct dirent *initrd_readdir(Ext2Inode *node, uint32_t index) {
     return &dirent;
 }
 
-static Ext2Inode *initrd_finddir(Ext2Inode *node, char *name) {
+static Ext2Inode *__initrd_finddir(Ext2Inode *node, char *name) {
     if (node == NULL) {
         return NULL;
     } else if (!strcmp(name, node->name)) {
         return node;
     } else if (node->flags & FS_DIRECTORY && node->childs != NULL) {
-        for (uint32_t j = 0; j < node->n_children; j++) {
-            if (node->childs[j] == NULL) {
+        /* Count first: an array is never shorter than a count published after it */
+        uint32_t n_children = node->n_children;
+        Ext2Inode **childs;
+
+        __asm__ volatile("" ::: "memory");
+        childs = rcu_dereference(node->childs);
+        for (uint32_t j = 0; j < n_children; j++) {
+            if (childs[j] == NULL) {
                 continue;
             }
-            Ext2Inode *ret = initrd_finddir(node->childs[j], name);
+            Ext2Inode *ret = __initrd_finddir(childs[j], name);
 
             if (ret != NULL) {
                 return (ret);
@@ -68,6 +80,15 @@ static Ext2Inode *initrd_finddir(Ext2Inode *node, char *name) {
     return (NULL);
 }
 
+static Ext2Inode *initrd_finddir(Ext2Inode *node, char *name) {
+    Ext2Inode *ret;
+
+    rcu_read_lock();
+    ret = __initrd_finddir(node, name);
+    rcu_read_unlock();
+    return (ret);
+}
+
 static uint32_t initrd_read(Ext2Inode *node, uint32_t offset, uint32_t size, uint8_t *buffer) {
     InitrdFileHeader header = file_headers[node->inode];
     if (offset > header.length)
@@ -124,7 +145,9 @@ static uint32_t intird_mkdir(Ext2Inode *node, char *name, uint16_t permission) {
     new_dir->impl = 0;
 
     // Link the new directory to the parent directory (this is pseudocode and will depend on your specific FS layout)
+    uint32_t eflags = write_lock_irqsave(&initrd_tree_lock);
     link_directory(node, new_dir);
+    write_unlock_irqrestore(&initrd_tree_lock, eflags);
 
     return 0;
 }
@@ -169,17 +192,25 @@ static void create_node(Ext2Inode *parent, const char *name, uint32_t flags) {
     node->parent = parent;
     node->impl = 0;
     node->n_children = 0;
+    node->childs = NULL;
 
-    int n = parent->n_children++;
+    // Add this node to parent's children Array: the new array is built
+    // aside, lookups only ever see the old or the new one. The old one is
+    // freed once no lookup can still be walking it
+    uint32_t n = parent->n_children;
+    Ext2Inode **childs = (Ext2Inode **)kmalloc((n + 1) * sizeof(Ext2Inode *));
+    Ext2Inode **old = parent->childs;
 
-    // Add this node to parent's children Array
-    if (parent->childs == NULL) {
-        parent->childs = (Ext2Inode **)kmalloc(sizeof(Ext2Inode *));
-        parent->childs[0] = node;
-    } else {
-        parent->childs = (Ext2Inode **)krealloc(parent->childs, parent->n_children * sizeof(Ext2Inode *));
-        parent->childs[n] = node;
-    }
+    if (old != NULL)
+        memcpy(childs, old, n * sizeof(Ext2Inode *));
+    childs[n] = node;
+
+    uint32_t eflags = write_lock_irqsave(&initrd_tree_lock);
+    rcu_assign_pointer(parent->childs, childs);
+    rcu_assign_pointer(parent->n_children, n + 1);
+    write_unlock_irqrestore(&initrd_tree_lock, eflags);
+
+    kfree_rcu(old);
     printk("Created node: "_GREEN
            "[%s] -> [%s]\n"_END,
            parent->name, node->name);
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 13:55:07 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 18:27:44 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:32:50 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -18,6 +18,7 @@
 
 #include <syscall/syscall.h>
 #include <system/bsod.h>
+#include <system/clocksource.h>
 #include <system/cmos.h>
 #include <system/cpu.h>
 #include <system/fpu.h>
@@ -25,6 +26,7 @@
 #include <system/idt.h>
 #include <system/ipc.h>
 #include <system/irq.h>
+#include <system/irqsoff.h>
 #include <system/isr.h>
 #include <system/kerrno.h>
 #include <system/mutex.h>
@@ -33,7 +35,7 @@
 #include <system/sections.h>
 #include <system/serial.h>
 #include <system/signal.h>
-#include <system/threads.h>
+#include <system/smp.h>
 #include <system/time.h>
 #include <system/tss.h>
 
@@ -44,6 +46,7 @@
 #include <multiboot/multiboot.h>
 
 #include <memory/kheap.h>
+#include <memory/kstack.h>
 #include <memory/memory.h>
 #include <memory/memory_map.h>
 #include <memory/paging.h>
@@ -84,9 +87,7 @@ static inline void ksh_header(void) {
 
 void kernel_log_info(const char *part, const char *name) {
     if (__DISPLAY_INIT_LOG__) {
-        tm_t tm = gettime();
-
-        uint64_t diff_time = difftime(&tm, &startup_tm);
+        uint64_t diff_time = get_system_time() - startup_time;
         printk(_END "[0:%02u] "_END
                     "- "_YELLOW
                     "[%s] " _END "- " _GREEN "[INIT] " _CYAN "%s " _END "\n",
@@ -106,8 +107,11 @@ static int init_kernel(hex_t magic_number, hex_t addr, uint32_t *kstack) {
     terminal_initialize();
     ksh_header();
 
+    /* Elapsed times logged below come from the clocksource */
     time_init();
+    clocksource_init();
     kernel_log_info("LOG", "TIME");
+    kernel_log_info("LOG", "CLOCKSOURCE");
 
     kernel_stack = kstack;
     initial_esp = (uint32_t)kstack;
@@ -155,6 +159,10 @@ static int init_kernel(hex_t magic_number, hex_t addr, uint32_t *kstack) {
     gdt_install();
     kernel_log_info("LOG", "GDT");
 
+    /* this_cpu() works from here */
+    irqsoff_init();
+    kernel_log_info("LOG", "IRQSOFF TRACER");
+
     idt_install();
     kernel_log_info("LOG", "IDT");
 
@@ -203,22 +211,22 @@ static int init_kernel(hex_t magic_number, hex_t addr, uint32_t *kstack) {
         __WARND("No multi boot modules found, kernel will not use filesystem.");
     }
 
+    smp_early_init();
+    kernel_log_info("LOG", "SMP DETECT");
+
     init_paging();
     kernel_log_info("LOG", "PAGING");
     kernel_log_info("LOG", "HEAP");
 
+    kstack_init();
+    kernel_log_info("LOG", "KSTACK");
+
     init_syscall();
     kernel_log_info("LOG", "SYSCALL");
 
     init_signals();
     kernel_log_info("LOG", "SIGNALS");
 
-    // SMP -> Wait KFS -> Threads, processus
-    // kpause();
-    // Require x64 Broadwell Intel (5th Gen) or higher
-    // smp_init();
-    // kernel_log_info("LOG", "SMP");
-
     // ksleep(1);
     // kheap_test();
     // kpause();
@@ -229,8 +237,9 @@ static int init_kernel(hex_t magic_number, hex_t addr, uint32_t *kstack) {
     init_tasking();
     kernel_log_info("LOG", "TASKING");
 
-    thread_init();
-    kernel_log_info("LOG", "THREADS");
+    /* APs need the scheduler to build their idle task */
+    smp_init();
+    kernel_log_info("LOG", "SMP");
 
     return (0);
 }
@@ -288,6 +297,13 @@ int kmain(hex_t magic_number, hex_t addr, uint32_t *kstack) {
 
     // threads_test();
     // process_test();
+    // context_switch_test();
+    // pi_inversion_test();
+    // pi_mutex_test();
+    // futex_test();
+    // rcu_test();
+    // cfs_test();
+    // fairshare_test();
 
     // uint32_t esp;
 
@@ -316,11 +332,12 @@ int kmain(hex_t magic_number, hex_t addr, uint32_t *kstack) {
 
         /*
         ** Task 0 -> Kernel
-        ** Must infinite loop
+        ** Reaps its children, blocked in waitpid: the idle task gets the CPU
         */
 
-        while (1) {
-        }
+        while (task_waitpid(-1, NULL, 0) >= 0)
+            ;
+        task_park();
     }
     return (0);
 }
\ No newline at end of file
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/11/17 14:11:32 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/26 15:55:22 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:40:40 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -15,10 +15,45 @@
 #include <memory/shared.h>
 
 #include <system/panic.h>
+#include <system/percpu.h>
+#include <system/spinlock.h>
 
 uint32_t placement_addr = (uint32_t)(uint32_t *)(&__kernel_section_end);
 heap_t *kheap = NULL;
 
+/* Serialises the heap between CPUs (and interrupt handlers of the same CPU) */
+static spinlock_t kheap_lock = SPINLOCK_INIT;
+static volatile int32_t kheap_lock_owner = -1; // CPU holding kheap_lock
+static uint32_t kheap_lock_depth = 0;
+
+/**
+ * @brief Take the heap lock
+ * @note : Recursive on the owning CPU: growing the heap may create a page
+ *         table, which is itself allocated from the heap.
+ */
+static uint32_t __kheap_lock(void) {
+    uint32_t eflags;
+    int32_t cpu;
+
+    GET_EFLAGS(eflags);
+    ASM_CLI();
+    cpu = (int32_t)this_cpu()->id;
+    if (kheap_lock_owner != cpu) {
+        spinlock_acquire(&kheap_lock);
+        kheap_lock_owner = cpu;
+    }
+    kheap_lock_depth++;
+    return (eflags);
+}
+
+static void __kheap_unlock(uint32_t eflags) {
+    if (--kheap_lock_depth == 0) {
+        kheap_lock_owner = -1;
+        spinlock_release(&kheap_lock);
+    }
+    SET_EFLAGS(eflags);
+}
+
 static void *__kbrk(uint32_t size) {
     void *addr = NULL;
 
@@ -49,6 +84,7 @@ static void *__kbrk_int(uint32_t size, bool align, uint32_t *phys) {
 static void *__kmalloc_int(uint32_t size, bool align, uint32_t *phys) {
     /* If Heap exists -> Heap Algorithm with Virtual Memory */
     if (kheap) {
+        uint32_t eflags = __kheap_lock();
         void *addr = kheap_alloc(size, align, kheap);
         if (phys) {
             page_t *page = get_page((uint32_t)addr, kernel_directory);
@@ -63,6 +99,7 @@ static void *__kmalloc_int(uint32_t size, bool align, uint32_t *phys) {
                 placement_addr += PAGE_SIZE;
             }
         }
+        __kheap_unlock(eflags);
         return (addr);
     }
     /* Either, use physical Memory */
@@ -108,8 +145,11 @@ static void *__kcalloc(uint32_t count, uint32_t size) {
 }
 
 static void __kfree(void *ptr) {
-    if (kheap)
+    if (kheap) {
+        uint32_t eflags = __kheap_lock();
         kheap_free(ptr, kheap);
+        __kheap_unlock(eflags);
+    }
 }
 
 static uint8_t header_t_less_than(void *a, void *b) {
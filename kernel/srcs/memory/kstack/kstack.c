@@ -0,0 +1,169 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   kstack.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:45:49 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 02:45:49 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <memory/frames.h>
+#include <memory/kstack.h>
+
+#include <multitasking/kthread.h>
+#include <multitasking/process.h>
+
+#include <system/idt.h>
+#include <system/panic.h>
+#include <system/percpu.h>
+#include <system/serial.h>
+#include <system/spinlock.h>
+
+static spinlock_t kstack_lock = SPINLOCK_INIT;
+
+static uint32_t kstack_next_slot = 0;          // First slot never mapped
+static uint16_t kstack_pool[KSTACK_SLOTS];     // Freed slots, still mapped
+static uint32_t kstack_pool_count = 0;
+static uint32_t kstack_in_use = 0;
+
+static inline uint32_t __kstack_slot_base(uint32_t slot) {
+    return (KSTACK_REGION_START + slot * KSTACK_SLOT_SIZE);
+}
+
+/**
+ * @brief Map the stack pages of a slot (its guard page stays unmapped)
+ */
+static void __kstack_map_slot(uint32_t slot) {
+    uint32_t stack = __kstack_slot_base(slot) + KSTACK_GUARD_SIZE;
+
+    for (uint32_t addr = stack; addr < stack + KSTACK_SIZE; addr += PAGE_SIZE) {
+        page_t *page = create_page(addr, kernel_directory);
+
+        alloc_frame(page, 1, 1);
+        flush_tlb_entry(addr);
+    }
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 INITIALIZATION                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Create the page tables of the kernel stack region
+ * @note : Called by init_paging() before the first clone: page tables
+ *         created later would not be shared with the existing directories.
+ */
+void kstack_init_region(page_directory_t *dir) {
+    for (uint32_t addr = KSTACK_REGION_START; addr < KSTACK_REGION_END; addr += PAGE_SIZE * PAGE_TABLE_SIZE)
+        create_page(addr, dir);
+}
+
+/**
+ * @brief Catch kernel stack overflows on the BSP
+ * @note : The APs install their double fault task in percpu_init_ap().
+ */
+void kstack_init(void) {
+    percpu_install_double_fault(this_cpu(), gdt);
+    idt_set_task_gate(8, PERCPU_DF_TSS_SELECTOR);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   ALLOCATION                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Allocate a kernel stack
+ * @return Lowest address of the stack (the top is stack + KSTACK_SIZE), 0 on failure
+ */
+uint32_t kstack_alloc(void) {
+    uint32_t eflags = spinlock_acquire_irqsave(&kstack_lock);
+    uint32_t slot;
+
+    if (kstack_pool_count) {
+        slot = kstack_pool[--kstack_pool_count];
+        kstack_in_use++;
+        spinlock_release_irqrestore(&kstack_lock, eflags);
+        return (__kstack_slot_base(slot) + KSTACK_GUARD_SIZE);
+    }
+
+    if (kstack_next_slot >= KSTACK_SLOTS) {
+        spinlock_release_irqrestore(&kstack_lock, eflags);
+        __THROW("kstack_alloc : no kernel stack left (%d in use)", 0, KSTACK_SLOTS);
+    }
+    slot = kstack_next_slot++;
+    kstack_in_use++;
+    spinlock_release_irqrestore(&kstack_lock, eflags);
+
+    /* The slot is ours, map it outside of the lock */
+    __kstack_map_slot(slot);
+    return (__kstack_slot_base(slot) + KSTACK_GUARD_SIZE);
+}
+
+/**
+ * @brief Give a kernel stack back to the pool
+ */
+void kstack_free(uint32_t stack) {
+    uint32_t offset = stack - KSTACK_REGION_START - KSTACK_GUARD_SIZE;
+    uint32_t eflags;
+
+    if (!stack)
+        return;
+    if (stack < KSTACK_REGION_START + KSTACK_GUARD_SIZE || stack >= KSTACK_REGION_END || offset % KSTACK_SLOT_SIZE)
+        __WARN_NO_RETURN("kstack_free : %p is not a kernel stack", (void *)stack);
+
+    eflags = spinlock_acquire_irqsave(&kstack_lock);
+    kstack_pool[kstack_pool_count++] = (uint16_t)(offset / KSTACK_SLOT_SIZE);
+    kstack_in_use--;
+    spinlock_release_irqrestore(&kstack_lock, eflags);
+}
+
+kstack_stats_t kstack_get_stats(void) {
+    return ((kstack_stats_t){kstack_next_slot, kstack_in_use, kstack_pool_count});
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                               OVERFLOW DETECTION                               ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Check if an address is in the guard page of a kernel stack
+ */
+bool kstack_is_guard(uint32_t addr) {
+    if (addr < KSTACK_REGION_START || addr >= KSTACK_REGION_END)
+        return (false);
+    return (((addr - KSTACK_REGION_START) % KSTACK_SLOT_SIZE) < KSTACK_GUARD_SIZE);
+}
+
+/**
+ * @brief Report a kernel stack overflow on the console and the serial port
+ */
+void kstack_overflow_report(uint32_t addr, uint32_t eip, uint32_t esp) {
+    task_t *task = this_cpu()->current;
+    const char *name = (task && task->kthread) ? task->kthread->name : "-";
+
+    printk(_RED "Kernel stack overflow" _END " on CPU %u: task [%d] (%s), addr: %p, eip: %p, esp: %p\n",
+           this_cpu()->id, task ? task->pid : -1, name, (void *)addr, (void *)eip, (void *)esp);
+    qemu_printf("Kernel stack overflow on CPU %u: task [%d] (%s), addr: %p, eip: %p, esp: %p\n",
+                this_cpu()->id, task ? task->pid : -1, name, (void *)addr, (void *)eip, (void *)esp);
+}
+
+/**
+ * @brief Double fault task
+ * @note : Entered through the #DF task gate, on its own stack and TSS: the
+ *         faulting context is saved in the CPU TSS. Never returns.
+ */
+void kstack_double_fault(void) {
+    tss_entry_t *tss = this_cpu()->tss;
+    uint32_t cr2 = get_cr2();
+
+    if (kstack_is_guard(tss->esp) || kstack_is_guard(cr2)) {
+        kstack_overflow_report(cr2, tss->eip, tss->esp);
+        __PANIC("Kernel stack overflow");
+    }
+    __PANIC("Double fault");
+    for (;;)
+        __asm__ volatile("cli; hlt");
+}
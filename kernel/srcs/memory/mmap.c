@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/06/02 16:58:09 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/06/02 17:40:36 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:40:40 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -16,8 +16,8 @@
 #include <memory/paging.h>
 
 #include <multitasking/process.h>
+#include <system/percpu.h>
 
-extern task_t *current_task;
 extern task_t *ready_queue;
 
 void *mmap(void *addr, uint32_t length, int prot, int flags) {
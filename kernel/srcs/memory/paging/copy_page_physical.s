@@ -1,3 +1,7 @@
+; void copy_page_physical(uint32_t src, uint32_t dst)
+;
+; Copies a frame with paging off: interrupts must stay disabled meanwhile,
+; no handler can run without its mappings. One page only, a short window.
 [GLOBAL copy_page_physical]
 copy_page_physical:
     push ebx
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/11/17 14:39:30 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/24 12:14:25 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:40:40 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -14,10 +14,13 @@
 #include <memory/kheap.h>
 
 #include <system/panic.h>
+#include <system/spinlock.h>
 
 uint32_t n_frames = 0;
 uint32_t *frames = NULL;
 
+static spinlock_t frames_lock = SPINLOCK_INIT;
+
 static void set_frame(uint32_t frame_addr) {
     uint32_t frame = frame_addr / PAGE_SIZE;
     uint32_t idx = INDEX_FROM_BIT(frame);
@@ -51,11 +54,13 @@ void alloc_frame(page_t *page, int is_kernel, int is_writeable) {
     if (page->frame != 0) {
         return;
     } else {
+        uint32_t eflags = spinlock_acquire_irqsave(&frames_lock);
         uint32_t idx = first_frame();
         if (idx == 0xFFFFFFFF) {
             __PANIC("No free frames!");
         }
         set_frame(idx * PAGE_SIZE);
+        spinlock_release_irqrestore(&frames_lock, eflags);
         page->present = 1;
         page->rw = (is_writeable) ? 1 : 0;
         page->user = (is_kernel) ? 0 : 1;
@@ -68,7 +73,9 @@ void free_frame(page_t *page) {
     if (!(frame = page->frame)) {
         return;
     } else {
+        uint32_t eflags = spinlock_acquire_irqsave(&frames_lock);
         clear_frame(frame);
+        spinlock_release_irqrestore(&frames_lock, eflags);
         page->frame = 0x0;
     }
 }
@@ -6,10 +6,11 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/11/17 14:59:44 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/05/30 12:37:23 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:47:01 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
+#include <memory/kstack.h>
 #include <memory/paging.h>
 #include <memory/memory.h>
 #include <system/panic.h>
@@ -44,7 +45,12 @@ void page_fault(struct regs *r)
            faulting_address);
     printk("");
 
-    if (faulting_address == 0x0)
+    if (kstack_is_guard(faulting_address))
+    {
+        kstack_overflow_report(faulting_address, r->eip, r->esp);
+        __PANIC("Kernel stack overflow");
+    }
+    else if (faulting_address == 0x0)
     {
         __PANIC("Page fault at NULL pointer");
     }
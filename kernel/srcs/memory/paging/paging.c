@@ -6,20 +6,28 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/11/17 14:34:06 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 18:25:20 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:33:57 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <memory/frames.h>
 #include <memory/kheap.h>
+#include <memory/kstack.h>
 #include <memory/paging.h>
 
+#include <system/percpu.h>
 #include <system/serial.h>
 
 page_directory_t *kernel_directory = NULL;
-page_directory_t *current_directory = NULL;
 bool paging_enabled = false;
 
+/* Device memory to identity map in the kernel directory (LAPIC, ...) */
+static struct s_mmio_region {
+    uint32_t base;
+    uint32_t size;
+} __mmio_regions[PAGING_MAX_MMIO_REGIONS];
+static uint32_t __mmio_count = 0;
+
 // ! ||--------------------------------------------------------------------------------||
 // ! ||                            UTILS - TRANSLATE ADDRESS                           ||
 // ! ||--------------------------------------------------------------------------------||
@@ -380,6 +388,9 @@ page_directory_t *clone_page_directory(page_directory_t *src) {
         __THROW("Failed to obtain physical address of new page directory!", NULL);
     }
 
+    /* Held by the task it is cloned for */
+    dir->refcount = 1;
+
     /* Go through each page table. If the page table is in the kernel directory, do not make a new copy */
     for (int32_t i = 0; i < PAGE_TABLE_SIZE; i++) {
         if (!src->tables[i])
@@ -436,6 +447,25 @@ void destroy_page_directory(page_directory_t *dir) {
     }
 }
 
+/**
+ * @brief Take a reference on a page directory
+ * @note : Kernel threads and idle tasks have no directory of their own, they
+ *         hold one on the directory they borrow for as long as they run on it.
+ */
+void page_directory_get(page_directory_t *dir) {
+    __atomic_add_fetch(&dir->refcount, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Drop a reference, the last one destroys the directory
+ * @note : A directory loaded in CR3 is always referenced by the task running
+ *         on it, so it is never destroyed under a CPU.
+ */
+void page_directory_put(page_directory_t *dir) {
+    if (dir && !__atomic_sub_fetch(&dir->refcount, 1, __ATOMIC_SEQ_CST))
+        destroy_page_directory(dir);
+}
+
 void flush_tlb_entry(uint32_t addr) {
     __asm__ volatile("invlpg (%0)" ::"r"(addr)
                      : "memory");
@@ -467,6 +497,44 @@ void switch_page_directory(page_directory_t *dir) {
 // ! ||                                   INIT PAGING                                  ||
 // ! ||--------------------------------------------------------------------------------||
 
+/**
+ * @brief Reserve a device memory range, identity mapped by init_paging()
+ * @note : Must be called before init_paging(): the range is mapped in the
+ *         kernel directory before it is cloned, so every address space
+ *         shares the same page tables for it.
+ */
+void paging_reserve_mmio(uint32_t base, uint32_t size) {
+    if (kernel_directory)
+        __THROW_NO_RETURN("paging_reserve_mmio : paging already initialized");
+    if (__mmio_count >= PAGING_MAX_MMIO_REGIONS)
+        __THROW_NO_RETURN("paging_reserve_mmio : too many regions");
+
+    __mmio_regions[__mmio_count].base = base & PAGE_MASK;
+    __mmio_regions[__mmio_count].size = size + (base & ~PAGE_MASK);
+    __mmio_count++;
+}
+
+/**
+ * @brief Identity map the reserved device memory, uncached
+ * @note : No frame is allocated, the physical pages are not RAM.
+ */
+static void __map_mmio_regions(page_directory_t *dir) {
+    for (uint32_t r = 0; r < __mmio_count; r++) {
+        for (uint32_t off = 0; off < __mmio_regions[r].size; off += PAGE_SIZE) {
+            uint32_t addr = __mmio_regions[r].base + off;
+            page_t *page = get_page(addr, dir);
+
+            if (!page)
+                page = create_page(addr, dir);
+            page->present = 1;
+            page->rw = 1;
+            page->user = 0;
+            page->frame = addr / PAGE_SIZE;
+            *(uint32_t *)page |= PAGE_CACHE_DISABLE | PAGE_WRITETHROUGH;
+        }
+    }
+}
+
 void init_paging(void) {
     init_frames();
 
@@ -476,12 +544,19 @@ void init_paging(void) {
         __PANIC("Failed to allocate memory for kernel directory");
     memset(kernel_directory, 0, sizeof(page_directory_t));
     kernel_directory->physicalAddr = (uint32_t)kernel_directory->tablesPhysical;
+    kernel_directory->refcount = 1; // Never released
 
     // Map kernel heap area
     for (uint32_t i = KHEAP_START; i < (KHEAP_START + KHEAP_INITIAL_SIZE); i += PAGE_SIZE) {
         create_page(i, kernel_directory);
     }
 
+    // Device memory: its page tables must be allocated before the identity mapping below
+    __map_mmio_regions(kernel_directory);
+
+    // Kernel stacks region: page tables only, shared by every clone
+    kstack_init_region(kernel_directory);
+
     // Allocate frames for all memory used before kmalloc is available
     for (uint32_t i = 0; i < (placement_addr + PAGE_SIZE); i += PAGE_SIZE) {
         const page_t *page = get_page(i, kernel_directory);
@@ -0,0 +1,97 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   slab.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:49:24 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 02:52:48 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <memory/kheap.h>
+#include <memory/paging.h>
+#include <memory/slab.h>
+
+/**
+ * @brief Carve a new slab into free objects
+ * @note : Called with the cache lock held and interrupts disabled.
+ */
+static bool __kmem_cache_grow(kmem_cache_t *cache) {
+    uint8_t *slab = (uint8_t *)kmalloc_a(SLAB_SIZE);
+
+    if (!slab)
+        return (false);
+
+    for (uint32_t i = 0; i < cache->objs_per_slab; ++i) {
+        void **obj = (void **)(slab + i * cache->obj_size);
+
+        *obj = cache->free;
+        cache->free = obj;
+    }
+    cache->nr_slabs++;
+    cache->nr_free += cache->objs_per_slab;
+    return (true);
+}
+
+/**
+ * @brief Set up a cache of objects of 'obj_size' bytes
+ */
+void kmem_cache_init(kmem_cache_t *cache, const char *name, uint32_t obj_size) {
+    if (obj_size < sizeof(void *))
+        obj_size = sizeof(void *);
+    obj_size = (obj_size + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1);
+    if (obj_size > SLAB_SIZE)
+        __PANIC("kmem_cache_init : object larger than a slab");
+
+    memset(cache, 0, sizeof(kmem_cache_t));
+    cache->name = name;
+    cache->obj_size = obj_size;
+    cache->objs_per_slab = SLAB_SIZE / obj_size;
+    cache->lock = SPINLOCK_INIT;
+}
+
+/**
+ * @brief Allocate an object (not zeroed)
+ * @return object, NULL if the heap is exhausted
+ */
+void *kmem_cache_alloc(kmem_cache_t *cache) {
+    uint32_t eflags = spinlock_acquire_irqsave(&cache->lock);
+    void **obj;
+
+    if (!cache->free && !__kmem_cache_grow(cache)) {
+        spinlock_release_irqrestore(&cache->lock, eflags);
+        __THROW("kmem_cache_alloc : cache '%s' cannot grow", NULL, cache->name);
+    }
+    obj = (void **)cache->free;
+    cache->free = *obj;
+    cache->nr_free--;
+    cache->nr_in_use++;
+    spinlock_release_irqrestore(&cache->lock, eflags);
+    return ((void *)obj);
+}
+
+/**
+ * @brief Give an object back to its cache
+ */
+void kmem_cache_free(kmem_cache_t *cache, void *obj) {
+    uint32_t eflags;
+
+    if (!obj)
+        return;
+
+    eflags = spinlock_acquire_irqsave(&cache->lock);
+    *(void **)obj = cache->free;
+    cache->free = obj;
+    cache->nr_free++;
+    cache->nr_in_use--;
+    spinlock_release_irqrestore(&cache->lock, eflags);
+}
+
+void kmem_cache_print(kmem_cache_t *cache) {
+    printk("Cache "_GREEN
+           "%s"_END
+           ": object %u bytes, %u slabs, %u in use, %u free\n",
+           cache->name, cache->obj_size, cache->nr_slabs, cache->nr_in_use, cache->nr_free);
+}
@@ -0,0 +1,189 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   cpu_acct.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:15:16 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:38:37 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/cpu_acct.h>
+#include <multitasking/process.h>
+
+#include <system/clocksource.h>
+#include <system/percpu.h>
+#include <system/rcu.h>
+
+#include <asm/div64.h>
+
+uint32_t avenrun[3] = {0, 0, 0};
+
+static uint64_t cpu_acct_last_sample = 0;
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    CHARGING                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Charge the time since the last stamp to the current mode of 'task'
+ */
+static void __cpu_acct_charge(task_t *task, uint64_t now) {
+    uint64_t delta = now > task->cpu_load.stamp ? now - task->cpu_load.stamp : 0;
+
+    if (task->cpu_load.user_mode)
+        task->cpu_load.utime += delta;
+    else
+        task->cpu_load.stime += delta;
+    task->cpu_load.stamp = now;
+}
+
+/**
+ * @brief 'prev' leaves the CPU, 'next' gets it (schedule)
+ * @note : Also called when prev keeps the CPU: its slice is charged anyway.
+ */
+void cpu_acct_switch(task_t *prev, task_t *next) {
+    uint64_t now = sched_clock();
+
+    __cpu_acct_charge(prev, now);
+    if (next != prev) {
+        next->cpu_load.stamp = now;
+        next->cpu_load.switches++;
+    }
+}
+
+/**
+ * @brief int 0x80 from user mode: the time so far was user time
+ */
+void cpu_acct_syscall_enter(task_t *task) {
+    __cpu_acct_charge(task, sched_clock());
+    task->cpu_load.user_mode = false;
+}
+
+void cpu_acct_syscall_exit(task_t *task) {
+    __cpu_acct_charge(task, sched_clock());
+    task->cpu_load.user_mode = true;
+}
+
+/**
+ * @brief The task jumps to ring 3 for the first time
+ */
+void cpu_acct_user_enter(task_t *task) {
+    cpu_acct_syscall_exit(task);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    SAMPLING                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Run time of a task, with the slice in progress if it is on a CPU
+ * @note : Approximate for a task running on another CPU: its stamp may move
+ *         while we read it.
+ */
+static uint64_t __cpu_acct_total(task_t *task, uint64_t now) {
+    uint64_t total = task->cpu_load.utime + task->cpu_load.stime;
+
+    if (task->on_cpu && now > task->cpu_load.stamp)
+        total += now - task->cpu_load.stamp;
+    return (total);
+}
+
+static uint32_t __ns_to_us(uint64_t ns) {
+    uint64_t us = div_u64(ns, NSEC_PER_USEC);
+
+    return (us >> 32 ? 0xFFFFFFFF : (uint32_t)us);
+}
+
+static void __cpu_acct_sample_task(task_t *task, uint64_t now, uint32_t period_us) {
+    uint64_t total = __cpu_acct_total(task, now);
+    uint64_t used = total > task->cpu_load.sample ? total - task->cpu_load.sample : 0;
+    uint32_t used_us = __ns_to_us(sched_clock_to_ns(used));
+    uint64_t usage = div_u64((uint64_t)used_us * 1000, period_us);
+
+    task->cpu_load.sample = total;
+    task->cpu_load.usage = usage > 1000 ? 1000 : (uint32_t)usage;
+}
+
+/**
+ * @brief CPU usage of every task and idle time of every CPU over the last
+ *        sample period (permille)
+ */
+static void __cpu_acct_sample(void) {
+    uint64_t now = sched_clock();
+    uint32_t period_us = __ns_to_us(sched_clock_to_ns(now - cpu_acct_last_sample));
+
+    cpu_acct_last_sample = now;
+    if (!period_us)
+        return;
+
+    rcu_read_lock();
+    for (task_t *task = rcu_dereference(ready_queue); task; task = rcu_dereference(task->next))
+        __cpu_acct_sample_task(task, now, period_us);
+    rcu_read_unlock();
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        if (cpus[i].online && cpus[i].idle)
+            __cpu_acct_sample_task(cpus[i].idle, now, period_us);
+    }
+}
+
+static uint32_t __calc_load(uint32_t load, uint32_t exp, uint32_t active) {
+    uint64_t newload = (uint64_t)load * exp + (uint64_t)active * (FIXED_1 - exp);
+
+    /* Round up while the load grows, it would never reach 'active' otherwise */
+    if (active >= load)
+        newload += FIXED_1 - 1;
+    return ((uint32_t)(newload >> FSHIFT));
+}
+
+/**
+ * @brief Decay the load averages towards the runnable tasks count
+ */
+static void __cpu_acct_calc_load(void) {
+    uint32_t active = task_state_count(TASK_RUNNING) * FIXED_1;
+
+    avenrun[0] = __calc_load(avenrun[0], EXP_1, active);
+    avenrun[1] = __calc_load(avenrun[1], EXP_5, active);
+    avenrun[2] = __calc_load(avenrun[2], EXP_15, active);
+}
+
+/**
+ * @brief Timer hook (BSP, interrupts disabled)
+ */
+void cpu_acct_tick(uint64_t jiffies) {
+    uint32_t rem;
+
+    div_u64_rem(jiffies, CPU_ACCT_SAMPLE_FREQ, &rem);
+    if (rem == 0)
+        __cpu_acct_sample();
+    div_u64_rem(jiffies, CPU_ACCT_LOAD_FREQ, &rem);
+    if (rem == 0)
+        __cpu_acct_calc_load();
+}
+
+uint64_t cpu_acct_utime_ns(task_t *task) {
+    return (sched_clock_to_ns(task->cpu_load.utime));
+}
+
+uint64_t cpu_acct_stime_ns(task_t *task) {
+    return (sched_clock_to_ns(task->cpu_load.stime));
+}
+
+/**
+ * @brief Time a CPU spent in its idle task, halted or about to halt
+ */
+uint64_t cpu_acct_idle_ns(cpu_t *cpu) {
+    if (!cpu->idle)
+        return (0);
+    return (sched_clock_to_ns(__cpu_acct_total(cpu->idle, sched_clock())));
+}
+
+/**
+ * @brief Idle time of a CPU over the last sample period (permille)
+ */
+uint32_t cpu_acct_idle_usage(cpu_t *cpu) {
+    return (cpu->idle ? cpu->idle->cpu_load.usage : 0);
+}
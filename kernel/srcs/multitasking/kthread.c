@@ -0,0 +1,309 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   kthread.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:42:40 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:34:12 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/kthread.h>
+#include <multitasking/sched_trace.h>
+#include <multitasking/scheduler.h>
+
+#include <memory/kstack.h>
+#include <memory/memory.h>
+#include <system/clocksource.h>
+#include <system/panic.h>
+#include <system/preempt.h>
+
+#include <asm/asm.h>
+#include <asm/div64.h>
+
+/* Protects the kthread_t <-> task_t link and the exit/join handshake.
+   Lock order: tasklist_lock, then kthread_lock (see kthread_task_freed()) */
+static spinlock_t kthread_lock = SPINLOCK_INIT;
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  THREAD ENTRY                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief First code run by a kernel thread
+ * @note : Reached from __switch_to() with interrupts disabled (see
+ *         task_init_switch_frame()).
+ */
+static void __kthread_entry(void) {
+    kthread_t *kthread;
+
+    schedule_tail();
+    ASM_STI();
+
+    kthread = kthread_self();
+    kthread_exit(kthread->fn(kthread->arg));
+}
+
+/**
+ * @brief Snapshot the CPU time of a running thread
+ * @note : The current slice is only charged when the task is switched out,
+ *         add it here for the thread running this code.
+ */
+static void __kthread_account(kthread_t *kthread, task_t *task) {
+    uint64_t cycles = task->cpu_load.utime + task->cpu_load.stime;
+
+    if (task->on_cpu && task == get_current_task())
+        cycles += sched_clock() - task->cpu_load.stamp;
+    kthread->cpu_time = sched_clock_to_ns(cycles);
+    kthread->switches = task->cpu_load.switches;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    FUNCTIONS                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+static kthread_t *__kthread_create(kthread_fn_t fn, void *arg, const char *name, uint32_t cpus_allowed) {
+    kthread_t *kthread;
+    task_t *task;
+
+    if (!fn)
+        __THROW("kthread_create : fn is NULL", NULL);
+    if (!(kthread = (kthread_t *)kmalloc(sizeof(kthread_t))))
+        __THROW("kthread_create : kmalloc failed", NULL);
+    if (!(task = task_alloc())) {
+        kfree(kthread);
+        __THROW("kthread_create : task_alloc failed", NULL);
+    }
+    memset(kthread, 0, sizeof(kthread_t));
+    wait_queue_init(&kthread->exit_wait);
+
+    if (!(task->kernel_stack = kstack_alloc())) {
+        task_free_struct(task);
+        kfree(kthread);
+        __THROW("kthread_create : kstack_alloc failed", NULL);
+    }
+    if ((task->pid = kthread->pid = pid_alloc()) < 0) {
+        kstack_free(task->kernel_stack);
+        task_free_struct(task);
+        kfree(kthread);
+        __THROW("kthread_create : pid_alloc failed", NULL);
+    }
+
+    kthread->task = task;
+    kthread->fn = fn;
+    kthread->arg = arg;
+    strncpy(kthread->name, name ? name : "kthread", KTHREAD_NAME_LEN - 1);
+
+    /* Same CPU from reading it to admitting the thread there */
+    preempt_disable();
+
+    task->page_directory = NULL;
+    task->active_directory = kernel_directory;
+    task->state = TASK_RUNNING;
+    task->or_priority = task->priority = TASK_PRIORITY_MEDIUM;
+    task->cpu = get_current_task()->cpu;
+    task->cpus_allowed = cpus_allowed;
+    task->kthread = kthread;
+    task_init_switch_frame(task, &__kthread_entry);
+    task_tree_link(get_current_task(), task);
+
+    sched_trace_fork(get_current_task(), task);
+    task_admit(task);
+
+    preempt_enable();
+    return (kthread);
+}
+
+/**
+ * @brief Create and start a kernel thread running fn(arg)
+ * @param name Name of the thread (truncated to KTHREAD_NAME_LEN - 1)
+ * @return kthread_t* to join or detach, NULL on failure
+ * @note : The value returned by fn is the exit code of the thread, as if
+ *         kthread_exit() was called.
+ */
+kthread_t *kthread_create(kthread_fn_t fn, void *arg, const char *name) {
+    return (__kthread_create(fn, arg, name, ~0U));
+}
+
+/**
+ * @brief kthread_create() for a thread bound to one CPU: homed there and
+ *        never stolen by another CPU
+ */
+kthread_t *kthread_create_on_cpu(kthread_fn_t fn, void *arg, const char *name, uint32_t cpu) {
+    if (cpu >= cpu_count || !cpus[cpu].online)
+        __THROW("kthread_create_on_cpu : CPU %u is not online", NULL, cpu);
+    return (__kthread_create(fn, arg, name, 1U << cpu));
+}
+
+/**
+ * @brief Give up an exited kthread_t (kthread_lock held)
+ * @return true if the caller frees it: the task is reaped already
+ * @note : While the zombie task exists, its exit path may still use the
+ *         kthread_t (exit_wait), the reaper frees it then.
+ */
+static bool __kthread_release(kthread_t *kthread) {
+    if (kthread->task) {
+        kthread->released = true;
+        return (false);
+    }
+    return (true);
+}
+
+/**
+ * @brief Wait for a kernel thread to exit and release it
+ * @param exit_code Filled with the exit code of the thread (may be NULL)
+ * @return 0 on success, -1 if the thread cannot be joined
+ * @note : Sleeps on the thread exit_wait queue, using no CPU.
+ */
+int32_t kthread_join(kthread_t *kthread, int32_t *exit_code) {
+    uint32_t eflags;
+    bool release;
+
+    if (!kthread)
+        __WARN("kthread_join : kthread is NULL", -1);
+    if (kthread == kthread_self())
+        __WARN("kthread_join : thread [%d] cannot join itself", -1, kthread->pid);
+
+    /* Under the lock: kthread_detach() cannot free it meanwhile */
+    eflags = spinlock_acquire_irqsave(&kthread_lock);
+    if (kthread->detached || kthread->joined) {
+        spinlock_release_irqrestore(&kthread_lock, eflags);
+        __WARN("kthread_join : thread [%d] is not joinable", -1, kthread->pid);
+    }
+    kthread->joined = true;
+    spinlock_release_irqrestore(&kthread_lock, eflags);
+
+    wait_event(&kthread->exit_wait, kthread->exited);
+
+    if (exit_code)
+        *exit_code = kthread->exit_code;
+
+    eflags = spinlock_acquire_irqsave(&kthread_lock);
+    release = __kthread_release(kthread);
+    spinlock_release_irqrestore(&kthread_lock, eflags);
+
+    if (release)
+        kfree(kthread);
+    return (0);
+}
+
+/**
+ * @brief Let a kernel thread release itself when it exits
+ * @note : The kthread_t must not be used by the caller afterwards.
+ */
+void kthread_detach(kthread_t *kthread) {
+    uint32_t eflags;
+    bool release = false;
+
+    if (!kthread)
+        return;
+
+    eflags = spinlock_acquire_irqsave(&kthread_lock);
+    if (!kthread->joined && !kthread->detached) {
+        kthread->detached = true;
+        if (kthread->exited)
+            release = __kthread_release(kthread);
+    }
+    spinlock_release_irqrestore(&kthread_lock, eflags);
+
+    if (release)
+        kfree(kthread);
+}
+
+/**
+ * @brief Terminate the calling kernel thread
+ * @note : The task becomes a zombie and is freed by the scheduler once it is
+ *         off the CPU, its exit code stays in the kthread_t.
+ */
+void kthread_exit(int32_t exit_code) {
+    task_t *task = get_current_task();
+    kthread_t *kthread = task->kthread;
+
+    ASM_CLI();
+    task->exit_code = exit_code;
+
+    if (kthread) {
+        spinlock_acquire(&kthread_lock);
+        __kthread_account(kthread, task);
+        kthread->exit_code = exit_code;
+        kthread->exited = true;
+        if (kthread->detached)
+            kthread->released = true;
+        spinlock_release(&kthread_lock);
+
+        /* Not freed before this task is reaped, even if the joiner is done */
+        wake_up_all(&kthread->exit_wait);
+    }
+
+    task_set_state(task, TASK_ZOMBIE);
+    schedule();
+
+    __PANIC("kthread_exit : zombie thread scheduled again");
+    for (;;)
+        ;
+}
+
+/**
+ * @brief Get the kernel thread running this code (NULL in a process)
+ */
+kthread_t *kthread_self(void) {
+    return (get_current_task()->kthread);
+}
+
+/**
+ * @brief Get the CPU time used by a kernel thread (ns)
+ */
+uint64_t kthread_cpu_time(kthread_t *kthread) {
+    uint32_t eflags;
+    uint64_t cpu_time;
+
+    if (!kthread)
+        return (0);
+
+    eflags = spinlock_acquire_irqsave(&kthread_lock);
+    if (!kthread->exited && kthread->task)
+        __kthread_account(kthread, kthread->task);
+    cpu_time = kthread->cpu_time;
+    spinlock_release_irqrestore(&kthread_lock, eflags);
+    return (cpu_time);
+}
+
+/**
+ * @brief Called by free_task() when a kernel thread task is reaped
+ */
+void kthread_task_freed(task_t *task) {
+    uint32_t eflags = spinlock_acquire_irqsave(&kthread_lock);
+    kthread_t *release = NULL;
+
+    if (task->kthread) {
+        if (task->kthread->released)
+            release = task->kthread;
+        task->kthread->task = NULL;
+        task->kthread = NULL;
+    }
+    spinlock_release_irqrestore(&kthread_lock, eflags);
+    kfree(release);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 UTILS - DISPLAY                                ||
+// ! ||--------------------------------------------------------------------------------||
+
+void kthread_print(kthread_t *kthread) {
+    uint64_t cpu_time = kthread_cpu_time(kthread);
+
+    if (!kthread)
+        return;
+    printk("Kthread "_GREEN
+           "[%d]"_END
+           " %s: %s, CPU: "_GREEN
+           "%u us"_END
+           ", Switches: "_GREEN
+           "%u"_END
+           "\n",
+           kthread->pid, kthread->name,
+           kthread->exited ? "exited" : "running",
+           (uint32_t)div_u64(cpu_time, 1000), kthread->switches);
+}
@@ -0,0 +1,149 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pid.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:47:54 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:10:44 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/process.h>
+#include <multitasking/scheduler.h>
+
+#include <system/rwlock.h>
+#include <system/spinlock.h>
+
+/*
+** PIDs are tracked in a bitmap (1 bit per pid, pid 0 is the idle tasks).
+** Allocation starts at a cursor just after the last pid handed out and
+** wraps to INIT_PID: pids are not reused right away and the search skips
+** a full word (32 pids) at a time.
+**
+** Live tasks are indexed by pid in a hash table chained through
+** task->pid_next, so get_task() no longer walks the task lists. Lookups
+** far outnumber fork/exit: updaters serialize on pid_hash_lock, lookups
+** take no lock at all and only need an RCU read section (the task_t is
+** freed one grace period after pid_hash_remove(), see free_task()).
+*/
+
+#define PID_BITMAP_WORDS (PID_MAX / 32)
+
+static spinlock_t pid_lock = SPINLOCK_INIT;
+static rwlock_t pid_hash_lock = RWLOCK_INIT;
+
+static uint32_t pid_bitmap[PID_BITMAP_WORDS] = {0x1}; // pid 0: idle tasks
+static pid_t pid_cursor = INIT_PID;
+static uint32_t pid_count = 0;
+
+static task_t *pid_hash[PID_HASH_SIZE];
+
+#define __PID_HASH(pid) ((uint32_t)(pid) & (PID_HASH_SIZE - 1))
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 PID ALLOCATION                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Allocate the first free pid from the cursor
+ * @return pid, -1 if every pid is in use
+ */
+pid_t pid_alloc(void) {
+    uint32_t eflags = spinlock_acquire_irqsave(&pid_lock);
+    uint32_t word = (uint32_t)pid_cursor / 32;
+    uint32_t mask = 0xFFFFFFFF << ((uint32_t)pid_cursor % 32);
+
+    /* One more word than the bitmap: the cursor word is seen twice when wrapping */
+    for (uint32_t i = 0; i <= PID_BITMAP_WORDS; ++i) {
+        uint32_t free = ~pid_bitmap[word] & mask;
+
+        if (free) {
+            pid_t pid = (pid_t)(word * 32 + __builtin_ctz(free));
+
+            pid_bitmap[word] |= (1U << (pid % 32));
+            pid_cursor = (pid + 1 < PID_MAX) ? pid + 1 : INIT_PID;
+            pid_count++;
+            spinlock_release_irqrestore(&pid_lock, eflags);
+            return (pid);
+        }
+        mask = 0xFFFFFFFF;
+        word = (word + 1) % PID_BITMAP_WORDS;
+    }
+    spinlock_release_irqrestore(&pid_lock, eflags);
+
+    __THROW("pid_alloc : no free PIDs", -1);
+}
+
+/**
+ * @brief Give a pid back to the bitmap
+ */
+void pid_free(pid_t pid) {
+    uint32_t eflags;
+
+    if (pid <= 0 || pid >= PID_MAX)
+        return;
+
+    eflags = spinlock_acquire_irqsave(&pid_lock);
+    if (pid_bitmap[pid / 32] & (1U << (pid % 32))) {
+        pid_bitmap[pid / 32] &= ~(1U << (pid % 32));
+        pid_count--;
+    }
+    spinlock_release_irqrestore(&pid_lock, eflags);
+}
+
+/**
+ * @brief Number of pids in use
+ */
+uint32_t pid_used(void) {
+    return (pid_count);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    PID HASH                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Index a task by its pid
+ */
+void pid_hash_add(task_t *task) {
+    uint32_t eflags = write_lock_irqsave(&pid_hash_lock);
+    uint32_t bucket = __PID_HASH(task->pid);
+
+    task->pid_next = pid_hash[bucket];
+    rcu_assign_pointer(pid_hash[bucket], task);
+    write_unlock_irqrestore(&pid_hash_lock, eflags);
+}
+
+/**
+ * @brief Remove a task from the pid index
+ */
+void pid_hash_remove(task_t *task) {
+    uint32_t eflags = write_lock_irqsave(&pid_hash_lock);
+    task_t **link = &pid_hash[__PID_HASH(task->pid)];
+
+    while (*link && *link != task)
+        link = &(*link)->pid_next;
+    /* pid_next is kept: a lookup standing on the task goes on */
+    if (*link)
+        rcu_assign_pointer(*link, task->pid_next);
+    write_unlock_irqrestore(&pid_hash_lock, eflags);
+}
+
+/**
+ * @brief Find a live task by pid
+ * @return task_t*, NULL if no task has this pid
+ * @note : Lockless. The task stays valid while the caller is in an RCU
+ *         read section.
+ */
+task_t *pid_hash_find(pid_t pid) {
+    task_t *task;
+
+    rcu_read_lock();
+    task = rcu_dereference(pid_hash[__PID_HASH(pid)]);
+    while (task && task->pid != pid)
+        task = rcu_dereference(task->pid_next);
+    rcu_read_unlock();
+    return (task);
+}
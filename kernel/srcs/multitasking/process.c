@@ -6,17 +6,27 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/02/12 10:13:19 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 18:24:48 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:34:54 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <memory/frames.h>
 #include <memory/kheap.h>
+#include <memory/kstack.h>
 #include <memory/memory.h>
 
+#include <multitasking/cpu_acct.h>
+#include <multitasking/kthread.h>
 #include <multitasking/process.h>
+#include <multitasking/sched_group.h>
+#include <multitasking/sched_trace.h>
 #include <multitasking/scheduler.h>
+#include <multitasking/wait_queue.h>
+#include <syscall/futex.h>
 
+#include <system/fpu.h>
+#include <system/percpu.h>
+#include <system/preempt.h>
 #include <system/tss.h>
 
 #include <system/time.h>
@@ -25,16 +35,14 @@
 
 #include <kernel.h>
 
-task_t *current_task = NULL;
 uint32_t num_tasks = 0;
 
 task_t *ready_queue = NULL;
+static task_t *ready_queue_tail = NULL;
+rwlock_t ready_queue_lock = RWLOCK_INIT;
 task_t *waiting_queue;
 
 extern page_directory_t *kernel_directory;
-extern page_directory_t *current_directory;
-
-extern uint32_t read_eip(void);
 
 extern uint32_t initial_esp;
 
@@ -122,133 +130,181 @@ void init_tasking(void) {
     __ready_queue_init();
 
     /* Initialise the first task (kernel task) */
-    current_task = ready_queue = (task_t *)kmalloc_a(sizeof(task_t));
-
-    if (!(current_task))
-        __THROW_NO_RETURN("init_tasking : kmalloc failed");
-
-    memset(current_task, 0, sizeof(task_t));
-
-    // current_task->pid = next_pid++;
-    current_task->pid = find_first_free_pid();
-    current_task->ppid = 0;
-    current_task->esp = current_task->ebp = 0;
-    current_task->eip = 0;
-    current_task->page_directory = current_directory;
-    current_task->next = current_task->prev = NULL;
-    if (!(current_task->kernel_stack = (uint32_t)kmalloc_a(KERNEL_STACK_SIZE)))
-        __THROW_NO_RETURN("init_tasking : kmalloc_a failed");
-    current_task->state = TASK_RUNNING;
-    current_task->owner = current_task->effective_owner = 0;
-    current_task->task_id = (struct task_id_t){0, 0, 0, 0};
-    current_task->cpu_load = (process_cpu_load_t){0, 0, 0};
-    current_task->signal_queue = NULL;
-    current_task->or_priority = current_task->priority = TASK_PRIORITY_LOW;
-    current_task->zombie_hungry = 0;
-
-    __process_sectors(current_task);
+    task_t *task = task_alloc();
+
+    if (!(task))
+        __THROW_NO_RETURN("init_tasking : task_alloc failed");
+
+    // task->pid = next_pid++;
+    task->pid = pid_alloc();
+    task->ppid = 0;
+    task->pgid = task->pid; // Root of the process tree, leads the first group
+    task->esp = 0; // Saved on the first switch
+    task->page_directory = task->active_directory = current_directory;
+    task->next = task->prev = NULL;
+    if (!(task->kernel_stack = kstack_alloc()))
+        __THROW_NO_RETURN("init_tasking : kstack_alloc failed");
+    task->state = TASK_RUNNING;
+    task->owner = task->effective_owner = 0;
+    task->task_id = (struct task_id_t){0, 0, 0, 0};
+    task->cpu_load = (process_cpu_load_t){0};
+    task->or_priority = task->priority = TASK_PRIORITY_LOW;
+    wait_queue_init(&task->child_exit);
+    task->cpu = this_cpu()->id;
+    task->on_cpu = true;
+
+    __process_sectors(task);
+
+    this_cpu()->current = task;
 
     /* Init waiting queue */
     __waiting_queue_init();
+    task_admit(task);
+
+    /* Idle task of the BSP (the APs get theirs in ap_main) */
+    sched_init_idle(this_cpu(), false);
     ASM_STI();
 }
 
+/**
+ * @brief Clone the address space of the forking task
+ * @note : Called by __task_fork_context() while the child switch frame is
+ *         live on the stack, so the stack copy made here resumes the child
+ *         inside task_fork().
+ */
+static void __task_fork_commit(void *arg) {
+    task_t *new_task = (task_t *)arg;
+
+    new_task->page_directory = clone_page_directory(current_directory);
+    new_task->active_directory = new_task->page_directory;
+}
+
 int32_t task_fork(void) {
     // printk("\t- Fork\n");
 
-    uint32_t eip, esp, ebp;
     task_t *parent_task, *new_task;
-    page_directory_t *directory;
-
-    /* We are modifying kernel structures, and so cannot preempt */
-    ASM_CLI();
+    uint32_t eflags;
 
     /* Take a pointer to this process' task struct for later reference */
-    parent_task = (task_t *)current_task;
-
-    /* Clone the address space */
-    if (!(directory = clone_page_directory(current_directory)))
-        __THROW("task_fork : clone_page_directory failed", 1);
+    parent_task = get_current_task();
 
     /* Create a new process */
-    if (!(new_task = (task_t *)kmalloc_a(sizeof(task_t))))
-        __THROW("task_fork : kmalloc failed", 1);
-
-    memset(new_task, 0, sizeof(task_t));
+    if (!(new_task = task_alloc()))
+        __THROW("task_fork : task_alloc failed", 1);
 
     // new_task->pid = next_pid++;
-    new_task->pid = find_first_free_pid();
-    new_task->esp = new_task->ebp = 0;
-    new_task->eip = 0;
-    new_task->page_directory = directory;
-    new_task->kernel_stack = (uint32_t)kmalloc_a(KERNEL_STACK_SIZE); // Todo: Enable after debug
-    // new_task->kernel_stack = (uint32_t)kmalloc_debug(KERNEL_STACK_SIZE, true, NULL);
+    if ((new_task->pid = pid_alloc()) < 0) {
+        task_free_struct(new_task);
+        __THROW("task_fork : pid_alloc failed", 1);
+    }
+    new_task->esp = 0;
+    new_task->page_directory = new_task->active_directory = NULL;
+    new_task->kernel_stack = kstack_alloc();
     new_task->next = NULL;
     new_task->prev = NULL; // Set prev task when added to ready queue
     new_task->exit_code = 0;
     new_task->state = TASK_RUNNING;
     new_task->owner = new_task->effective_owner = 0;
-    new_task->task_id = (struct task_id_t){0, 0, 0, 0};
-    new_task->cpu_load = (process_cpu_load_t){0, 0, 0};
-    new_task->signal_queue = NULL;
+    /* Credentials and fair-share group are inherited, like on UNIX */
+    new_task->task_id = parent_task->task_id;
+    new_task->sched_group = parent_task->sched_group;
+    new_task->cpu_load = (process_cpu_load_t){0};
+    /* Actions and blocked signals are inherited, pending ones are not */
+    new_task->sig_pending = 0;
+    new_task->sig_blocked = parent_task->sig_blocked;
+    memcpy(new_task->sigactions, parent_task->sigactions, sizeof(new_task->sigactions));
     new_task->or_priority = new_task->priority = TASK_PRIORITY_MEDIUM;
-    new_task->zombie_hungry = 0;
-
-    __process_sectors(new_task);
-
-    if (!(current_task->kernel_stack))
+    /* The scheduling policy is inherited, like on UNIX */
+    new_task->policy = parent_task->policy;
+    new_task->rt_priority = parent_task->rt_priority;
+    new_task->fair_priority = TASK_PRIORITY_MEDIUM;
+    if (new_task->policy != SCHED_NORMAL)
+        new_task->or_priority = new_task->priority = TASK_PRIORITY_REALTIME;
+    wait_queue_init(&new_task->child_exit);
+    new_task->cpu = parent_task->cpu;
+    new_task->cpus_allowed = parent_task->cpus_allowed;
+
+    if (!(new_task->kernel_stack)) {
+        pid_free(new_task->pid);
+        task_free_struct(new_task);
         __THROW("task_fork : failed to alloc kernel task", 1);
-
-    /* If we reached the max tasks, then, add it to the wait queue */
-    if (get_task_count() >= MAX_TASKS) {
-        new_task->state = TASK_WAITING;
-        __waiting_queue_add_task(new_task);
-    }
-    /* Either, add it to the ready queue */
-    else {
-        __ready_queue_add_task(new_task);
     }
 
-    // printk("\t- Prev Task [%d] -> Task [%d] -> Next Task [%d]\n", tmp_task->pid, new_task->pid, new_task->next == NULL ? -1 : new_task->next->pid);
+    /*
+    ** Interrupts only go off while the child frame is taken and the address
+    ** space cloned: the child resumes from this frame with them disabled,
+    ** until schedule_tail() released the task it was switched from.
+    ** The rest of fork is preemptible, the structures it fills are locked
+    ** by their owners and the child is unreachable until task_admit().
+    */
+    GET_EFLAGS(eflags);
+    ASM_CLI();
 
     /* This will be the entry point for the new process */
-    eip = read_eip();
-
-    // printk("\t- EIP : %x\n", eip);
-    // printk("\t- current_task == parent_task : %d\n", current_task == parent_task);
-
-    /* We could be the parent or the child here - check */
-    if (current_task == parent_task) {
-        /* We are the parent, so set up the esp/ebp/eip for our child */
-        __asm__ __volatile__("mov %%esp, %0"
-                             : "=r"(esp));
-        __asm__ __volatile__("mov %%ebp, %0"
-                             : "=r"(ebp));
-        new_task->esp = esp;
-        new_task->ebp = ebp;
-        new_task->eip = eip;
-        new_task->ppid = parent_task->pid;
-
-        ASM_STI();
-
-        return (new_task->pid);
-    } else {
+    if (__task_fork_context(&new_task->esp, &__task_fork_commit, new_task)) {
         /* We are the child */
+        schedule_tail();
         ASM_STI();
         return (0);
     }
+    SET_EFLAGS(eflags);
+
+    /* We are the parent */
+    if (!new_task->page_directory) {
+        kstack_free(new_task->kernel_stack);
+        pid_free(new_task->pid);
+        task_free_struct(new_task);
+        __THROW("task_fork : clone_page_directory failed", 1);
+    }
+
+    __process_sectors(new_task);
+
+    /* The parent FPU state may live in the registers of this CPU */
+    preempt_disable();
+    fpu_fork(parent_task, new_task);
+    preempt_enable();
+
+    /* Reachable from its parent as soon as it is admitted */
+    task_tree_link(parent_task, new_task);
+
+    /* Stamp before it can run: its first run is timed as a wakeup */
+    sched_trace_fork(parent_task, new_task);
+    task_admit(new_task);
+
+    return (new_task->pid);
+}
+
+/**
+ * @brief Build the first switch frame of a task that never ran
+ * @note : Same layout as the frames pushed by __switch_to() (see switch_to.s),
+ *         on top of the task kernel stack. 'entry' runs with interrupts
+ *         disabled and must call schedule_tail() first.
+ */
+void task_init_switch_frame(task_t *task, void (*entry)(void)) {
+    uint32_t *sp = (uint32_t *)(task->kernel_stack + KERNEL_STACK_SIZE);
+
+    *--sp = 0x0;             // Return address of entry (must not return)
+    *--sp = (uint32_t)entry; // ret of __switch_to
+    *--sp = 0x0;             // ebp
+    *--sp = 0x0;             // ebx
+    *--sp = 0x0;             // esi
+    *--sp = 0x0;             // edi
+    *--sp = 0x2;             // eflags (IF clear, reserved bit 1 set)
+    task->esp = (uint32_t)sp;
 }
 
 __attribute__((pure)) page_directory_t *get_task_directory(void) {
-    return current_task->page_directory;
+    return get_current_task()->page_directory;
 }
 
 void set_task_uid(task_t *task, uint32_t uid) {
     task->task_id.uid = uid;
+    sched_group_attach(task);
 }
 
 void set_task_gid(task_t *task, uint32_t gid) {
     task->task_id.gid = gid;
+    sched_group_attach(task);
 }
 
 void set_task_euid(task_t *task, uint32_t euid) {
@@ -260,101 +316,53 @@ void set_task_egid(task_t *task, uint32_t egid) {
 }
 
 pid_t getpid(void) {
-    return current_task->pid;
+    return get_current_task()->pid;
 }
 
 int32_t getppid(void) {
-    return current_task->ppid;
+    return get_current_task()->ppid;
 }
 
 task_t *get_current_task(void) {
-    return (task_t *)current_task;
+    return (this_cpu()->current);
 }
 
 task_t *get_task(int32_t pid) {
-    task_t *tmp_task = (task_t *)ready_queue;
-
-    if (!tmp_task) {
-        return NULL;
-    }
-
-    /* Find the process in the proc. list */
-    while (tmp_task->pid != pid) {
-        tmp_task = tmp_task->next;
-        if (!tmp_task)
-            break;
-    }
-    return tmp_task;
+    return (pid_hash_find(pid));
 }
 
 int32_t init_task(void func(void)) {
 
     int32_t ret = task_fork();
-    int32_t pid = getpid();
 
     /* If we are the child */
     if (!ret) {
         /* Execute the requested function */
         func();
-        /* Set task to running state */
-        // get_task(pid)->state = TASK_RUNNING;
-        /* Kill the current (child) process. On failure, freeze it */
-
-        if (get_task(pid)->state == TASK_RUNNING) {
-            __WARND("Task ended without calling task_exit");
-            if (kill_task(pid) != 0) {
-                printk("init_Task 1\n");
-                get_task(pid)->state = TASK_ZOMBIE;
-                printk("init_Task 2\n");
-                for (;;)
-                    ;
-            }
-        }
-        // Not sure about that, to check
-        else {
-            // __WARND("Task ended without calling task_exit");
-            // printk("init_Task 3\n");
-            // get_task(pid)->state = TASK_ZOMBIE;
-            // printk("init_Task 4\n");
-            for (;;)
-                ;
-        }
+
+        /* It returned instead of calling task_exit(): exit for it, never returns */
+        __WARND("Task ended without calling task_exit");
+        task_exit(0);
     }
     return ret;
 }
 
 /**
- * @brief Wait for a task to exit
- * @param pid
- * @return int32_t
- * @note : Wait for a task to exit and return its exit code
- *        If the task is still running, yield the CPU
+ * @brief Block the current task for good
+ * @note : For tasks whose work is done by interrupt handlers or children
+ *         (kernel task, shell): they leave the CPU to the idle task instead
+ *         of spinning. Nothing wakes parked_tasks, only a kill ends them.
  */
-int32_t task_wait(int32_t pid) {
-    task_t *task = get_task(pid);
-    if (!task) {
-        __WARN("task_wait : task not found for pid %d", -1, pid);
-    }
-
-    while (1) {
-        // If the task has exited, return its exit code
-        if (task->state == TASK_ZOMBIE) {
-            int exit_code = task->exit_code;
-            task->state = TASK_STOPPED;
-            printk("Task [%d] exited with code %d\n", pid, exit_code);
-            return exit_code;
-        } else {
-            // If the task is still running, yield the CPU
-            busy_wait((100 * TIMER_PHASE) / 1000);
-            // printk("Task [%d] state : %d\n", pid, task->state);
-        }
-    }
+void task_park(void) {
+    static wait_queue_t parked_tasks = WAIT_QUEUE_INIT;
 
-    return (-1);
+    for (;;)
+        wait_event_idle(&parked_tasks, false);
 }
 
 int32_t kill_task(int32_t pid) {
     task_t *tmp_task;
+    int32_t ret;
 
     if (!pid) {
         __WARN("kill_task : cannot kill kernel task", 0);
@@ -362,40 +370,33 @@ int32_t kill_task(int32_t pid) {
         __WARN("kill_task : cannot kill INIT task", 0);
     }
 
+    /* A concurrent reap frees the task one grace period after unhashing it */
+    rcu_read_lock();
     tmp_task = get_task(pid);
     if (!tmp_task) {
+        rcu_read_unlock();
         __THROW("kill_task : task not found for pid %d", 0, pid);
     }
 
     if (tmp_task->ppid != 0) {
-        /* If its stack is reachable, delete it */
-        if (tmp_task->kernel_stack) {
-            // kfree((void *)tmp_task->kernel_stack);
-            kfree_debug((void *)tmp_task->kernel_stack);
-            tmp_task->kernel_stack = 0x0;
-        }
-
-        /* Set all children to Zombies */
-        if (tmp_task->next) {
-            task_t *tmp = get_task(tmp_task->next->pid);
-            while (tmp) {
-                printk("[%d] -> Set task orphan [%d]\n", pid, tmp->pid);
-                tmp->state = TASK_ORPHAN;
+        /* The kernel stack may still be in use (it is the victim's own stack for
+           kernel threads), free_task() gives it back once the task is off the CPU */
 
-                // Todo: Unix system like : send SIGCHLD to parent to get exit code
-                // signal(tmp_task->ppid, SIGCHLD);
-                tmp = tmp->next;
-            }
+        /* Killing ourselves: never come back as a zombie */
+        if (tmp_task == get_current_task()) {
+            rcu_read_unlock();
+            task_exit(tmp_task->exit_code);
         }
 
-        tmp_task->state = TASK_ZOMBIE; // works to waitpid
+        ret = task_terminate(tmp_task);
+        rcu_read_unlock();
+        return (ret);
         // tmp_task->state = TASK_STOPPED; // works to stop while task immediatly
 
         // kmsleep(TASK_FREQUENCY);
         // busy_wait((1 * TIMER_PHASE) / 1000); // Wait 1 second
 
         // kpause();
-        return (pid);
 
         //  /* Relink the previous and next tasks around the one we're removing */
         // if (tmp_task->prev != NULL) {
@@ -427,6 +428,7 @@ int32_t kill_task(int32_t pid) {
         // kmsleep(TASK_FREQUENCY);
         // return (pid);
     } else {
+        rcu_read_unlock();
         __WARN("kill_task : cannot kill kernel task %d", 0, pid);
     }
 }
@@ -450,25 +452,36 @@ int32_t free_task(task_t *task) {
 
         pid_t task_pid = task->pid;
 
-        task->state = TASK_STOPPED;
+        /* Out of the process tree, children left (if any) go to INIT */
+        task_reparent_children(task);
+        task_tree_unlink(task);
 
-        /* Relink the previous and next tasks around the one we're removing */
-        if (task->prev != NULL) {
-            task->prev->next = task->next;
-        } else {
-            ready_queue = task->next;
-        }
-        if (task->next != NULL) {
-            task->next->prev = task->prev;
-        }
+        /* Unlink it from its wait queue, the ready and state lists, then from the PID index */
+        wait_queue_remove_task(task);
+        futex_remove_task(task);
+        task_table_remove(task);
+        pid_hash_remove(task);
+        task->state = TASK_STOPPED;
 
-        // Todo: free page directory: Currently crash
-        destroy_page_directory(task->page_directory);
+        /* Kernel threads and idle tasks still running on it keep it alive */
+        page_directory_put(task->page_directory);
 
         kfree(task->sectors.bss_segment);
         kfree(task->sectors.data_segment);
+        fpu_release(task);
+
+        kstack_free(task->kernel_stack);
+        task->kernel_stack = 0x0;
+
+        if (task->kthread)
+            kthread_task_freed(task);
+
+        /* Unlinked, but get_task() or a ready list walk may still hold it */
+        task_free_struct_rcu(task);
+        pid_free(task_pid);
 
-        kfree((void *)task);
+        /* A slot is free, admit a waiting task if any */
+        task_admit_waiting();
 
         // busy_wait((100 * TIMER_PHASE) / 1000); // Wait 1 second
         // kmsleep(TASK_FREQUENCY);
@@ -488,43 +501,56 @@ int32_t kill_all_tasks(void) {
     return (0);
 }
 
-void lock_task(task_t *task) {
-    ASM_CLI();
-    task->state = TASK_WAITING;
-    task->next = waiting_queue;
-    waiting_queue = task;
-    ASM_STI();
-}
+/**
+ * @brief Make a task a zombie: children to INIT, parent notified
+ * @return Its pid
+ * @note : Does not switch away from it, the scheduler drops the zombies it
+ *         picks (SIGKILL is delivered from there, see kill_handler()).
+ *         A task ending itself goes through task_exit().
+ */
+int32_t task_terminate(task_t *task) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    bool dead = task->state == TASK_ZOMBIE || task->state == TASK_STOPPED;
 
-void unlock_task(task_t *task) {
-    ASM_CLI();
-    if (waiting_queue) {
-        task_t *tmp = waiting_queue;
-        if (tmp == task) {
-            waiting_queue = tmp->next;
-        } else {
-            while (tmp->next && tmp->next != task)
-                tmp = tmp->next;
-            if (tmp->next) {
-                tmp->next = task->next;
-            }
-        }
-        task->next = NULL;
-        task->state = TASK_RUNNING;
-    }
-    ASM_STI();
+    /* Checked and set under the lock: two killers notify the parent once */
+    if (!dead)
+        task_set_state(task, TASK_ZOMBIE);
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+    if (dead)
+        return (task->pid);
+
+    /* Its children are adopted by INIT (Like UNIX System) */
+    task_reparent_children(task);
+    sched_trace_exit(task);
+    task_notify_parent(task);
+    return (task->pid);
 }
 
+/**
+ * @brief Terminate the calling task
+ * @note : The task becomes a zombie and switches away for good, like
+ *         kthread_exit(). Its parent reaps it with waitpid().
+ */
 void task_exit(int32_t retval) {
-    get_current_task()->exit_code = retval;
-    get_current_task()->state = TASK_ZOMBIE;
+    task_t *task = get_current_task();
+
+    if (task->kthread)
+        kthread_exit(retval);
+    if (task->pid <= INIT_PID)
+        __PANIC("task_exit : INIT task exited");
+
+    ASM_CLI();
+    task->exit_code = retval;
+    task_terminate(task);
+    schedule();
 
-    /* Kill task before task reach the scheduler */
-    kill_task(get_current_task()->pid);
+    __PANIC("task_exit : zombie task scheduled again");
+    for (;;)
+        ;
 }
 
 void switch_to_user_mode(void) {
-    tss_set_stack_pointer(current_task->kernel_stack + KERNEL_STACK_SIZE);
+    tss_set_stack_pointer(get_current_task()->kernel_stack + KERNEL_STACK_SIZE);
 
     /* Set up a stack structure for switching to user mode */
     // __asm__ __volatile__("cli; \
@@ -598,51 +624,42 @@ void switch_to_user_mode(void) {
     // "
     // : : : "ax", "eax"
     // );
+    cpu_acct_user_enter(get_current_task());
     switch_user_mode();
 
 }
-pid_t find_first_free_pid(void) {
-    pid_t pid = 1;
-    task_t *task = NULL;
+void task_set_priority(pid_t pid, task_priority_t priority) {
+    task_t *task;
 
-    // Safeguard against overflow
-    while (pid < PID_MAX) {
-        task = ready_queue;
-        while (task) {
-            if (task->pid == pid) {
-                pid++;
-                break;
-            }
-            task = task->next;
-        }
-        if (!task) {
-            task = waiting_queue;
-            while (task) {
-                if (task->pid == pid) {
-                    pid++;
-                    break;
-                }
-                task = task->next;
-            }
-        }
-        // If loop finished without a break, PID is free
-        if (!task) {
-            return (pid);
-        }
+    /* Realtime is a scheduling class of its own, not a fair priority */
+    if (priority == TASK_PRIORITY_REALTIME) {
+        if (sched_setscheduler(pid, SCHED_RR, SCHED_RT_PRIO_DEFAULT))
+            printk("Invalid PID: %d\n", pid);
+        return;
     }
 
-    // Log or handle the error - no free PIDs
-    __THROW("find_first_free_pid : no free PIDs", -1);
-}
-
-void task_set_priority(pid_t pid, task_priority_t priority) {
-    task_t *task = get_task(pid);
+    rcu_read_lock();
+    task = get_task(pid);
     if (!task) {
+        rcu_read_unlock();
         printk("Invalid PID: %d\n", pid);
         return;
     }
 
-    task->priority = priority;
+    if (task->policy != SCHED_NORMAL)
+        sched_setscheduler(pid, SCHED_NORMAL, 0);
+    /* Keep it once scheduled: the selector falls back to the base priority */
+    task->or_priority = priority;
+    task->priority = task_base_priority(task);
+    rcu_read_unlock();
+}
+
+/**
+ * @brief Priority a task falls back to once scheduled
+ * @note : Creation priority, or the one inherited through a PI mutex.
+ */
+task_priority_t task_base_priority(task_t *task) {
+    return (task->pi_boost > task->or_priority ? task->pi_boost : task->or_priority);
 }
 
 bool is_pid_valid(int pid) {
@@ -653,41 +670,12 @@ task_t *get_waiting_queue(void) {
     return waiting_queue;
 }
 
-uint32_t get_task_count(void) {
-    task_t *task = ready_queue;
-
-    uint32_t count = 0;
-    while (task) {
-        if (task->pid != 0 && task->pid != 1) {
-            count++;
-        }
-        task = task->next;
-    }
-    return count;
-}
-
-uint32_t get_waiting_task_count(void) {
-    task_t *task = waiting_queue;
-
-    uint32_t count = 0;
-    while (task) {
-        if (task->pid != 0 && task->pid != 1) {
-            count++;
-        }
-        task = task->next;
-    }
-    return count;
-}
-
-double get_cpu_load(task_t *task) {
-    return task->cpu_load.total_load_time;
-    uint64_t sys_time = get_system_time();
-    uint64_t elapsed_time = sys_time - task->cpu_load.start_time;
-
-    if (elapsed_time == 0) {
-        return 0.0;
-    }
-    return ((double)(task->cpu_load.load_time / elapsed_time) * 100.0);
+/**
+ * @brief CPU usage of a task over the last second, in permille
+ * @note : Sampled by the timer, see cpu_acct.c
+ */
+uint32_t get_cpu_load(task_t *task) {
+    return (task->cpu_load.usage);
 }
 
 // ! ||--------------------------------------------------------------------------------||
@@ -695,42 +683,50 @@ double get_cpu_load(task_t *task) {
 // ! ||--------------------------------------------------------------------------------||
 
 void __ready_queue_init(void) {
-    ready_queue = NULL;
+    ready_queue = ready_queue_tail = NULL;
 }
 
 void __ready_queue_add_task(task_t *task) {
-    if (!ready_queue) {
-        ready_queue = task;
-    } else {
-        task_t *tmp = ready_queue;
-        while (tmp->next) {
-            tmp = tmp->next;
-        }
-        tmp->next = task;
-        task->prev = tmp;
-    }
+    uint32_t eflags = write_lock_irqsave(&ready_queue_lock);
+
+    task->next = NULL;
+    task->prev = ready_queue_tail;
+    if (ready_queue_tail)
+        rcu_assign_pointer(ready_queue_tail->next, task);
+    else
+        rcu_assign_pointer(ready_queue, task);
+    ready_queue_tail = task;
+    write_unlock_irqrestore(&ready_queue_lock, eflags);
+    runqueue_enqueue(runqueue_select_cpu(task), task);
 }
 
 void __ready_queue_remove_task(task_t *task) {
-    if (!ready_queue) {
-        return;
-    } else {
-        task_t *tmp = ready_queue;
-        if (tmp == task) {
-            ready_queue = tmp->next;
-        } else {
-            while (tmp->next && tmp->next != task)
-                tmp = tmp->next;
-            if (tmp->next) {
-                tmp->next = task->next;
-            }
-        }
-        task->next = NULL;
+    uint32_t eflags = write_lock_irqsave(&ready_queue_lock);
+
+    if (task->prev)
+        task->prev->next = task->next;
+    else if (ready_queue == task)
+        ready_queue = task->next;
+    else {
+        write_unlock_irqrestore(&ready_queue_lock, eflags);
+        return; // Not on the ready list
     }
+    if (task->next)
+        task->next->prev = task->prev;
+    else
+        ready_queue_tail = task->prev;
+    /* 'next' is left alone: an RCU reader standing on the task goes on */
+    task->prev = NULL;
+    write_unlock_irqrestore(&ready_queue_lock, eflags);
+    runqueue_dequeue(task);
 }
 
 void __ready_queue_print(void) {
-    task_t *task = ready_queue;
+    task_t *task;
+
+    rcu_read_lock();
+    task = rcu_dereference(ready_queue);
+
     while (task) {
         printk("Task PID: "_GREEN
                "[%d]"_END
@@ -742,8 +738,9 @@ void __ready_queue_print(void) {
                "[%d]"_END
                "\n",
                task->pid, task->ppid, task->owner, task->state);
-        task = task->next;
+        task = rcu_dereference(task->next);
     }
+    rcu_read_unlock();
 }
 
 // ! ||--------------------------------------------------------------------------------||
@@ -814,21 +811,35 @@ void print_task_info(task_t *task) {
            "[%d]"_END
            ", State: "_GREEN
            "[%d]"_END
+           ", CPU: "_GREEN
+           "[%u.%u]"_END
            "\n",
-           task->pid, task->ppid, task->owner, task->state);
+           task->pid, task->ppid, task->owner, task->state, get_cpu_load(task) / 10, get_cpu_load(task) % 10);
 }
 
 void print_all_tasks() {
-    task_t *task = ready_queue;
+    task_t *task;
+
+    rcu_read_lock();
+    task = rcu_dereference(ready_queue);
+
     while (task) {
         print_task_info(task);
-        task = task->next;
+        task = rcu_dereference(task->next);
     }
+    rcu_read_unlock();
 }
 
 void print_parent_and_children(int pid) {
-    task_t *parent_task = get_task(pid);
-    if (!parent_task) {
+    task_t *parent_task;
+    uint32_t eflags;
+
+    /* The reapers free tasks without tasklist_lock, only after a grace period */
+    rcu_read_lock();
+    eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    if (!(parent_task = get_task(pid))) {
+        rspinlock_release_irqrestore(&tasklist_lock, eflags);
+        rcu_read_unlock();
         printk("Invalid PID: %d\n", pid);
         return;
     }
@@ -836,17 +847,8 @@ void print_parent_and_children(int pid) {
     print_task_info(parent_task);
 
     printk("Children:\n");
-    task_t *task = ready_queue;
-    while (task) {
-        if (task->ppid == pid) {
-            print_task_info(task);
-            if (task->next) {
-                print_parent_and_children(task->next->pid);
-            } else {
-                printk("No more children\n");
-                return;
-            }
-        }
-        task = task->next;
-    }
+    for (task_t *task = parent_task->children; task; task = task->sibling)
+        print_task_info(task);
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+    rcu_read_unlock();
 }
\ No newline at end of file
@@ -6,42 +6,27 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/10/23 20:33:35 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/25 14:01:28 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:52:40 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <multitasking/process.h>
 #include <multitasking/scheduler.h>
 
-extern task_t *ready_queue;
-
 int32_t __process_killer(void) {
-    // return (0); //tmp
-    task_t *tmp = ready_queue;
+    task_t *tmp = task_state_first(TASK_STOPPED);
 
     while (tmp) {
-        if (tmp->pid == 0 || tmp->pid == INIT_PID) {
-            tmp = tmp->next;
+        /* Never free a task still on a CPU: we may be on its stack */
+        if (tmp->pid == 0 || tmp->pid == INIT_PID || tmp->on_cpu) {
+            tmp = tmp->state_next;
             continue;
         }
-        if (tmp->state == TASK_STOPPED) {
-            task_t *next = tmp->next;
-            printk(_YELLOW "Killing task "_GREEN
-                           "[%d]"_END
-                           "\n",
-                   tmp->pid);
-            int ret = free_task(tmp);
-            printk("Ret: %d\n", ret);
-
-            if (ret) {
-            return (ret);
-            }
-
-            tmp = next;
-            return (ret);
-        } else {
-            tmp = tmp->next;
-        }
+        printk(_YELLOW "Killing task "_GREEN
+                       "[%d]"_END
+                       "\n",
+               tmp->pid);
+        return (free_task(tmp));
     }
     return (0);
-}
\ No newline at end of file
+}
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/20 22:32:32 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/22 13:01:23 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:40:29 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -15,62 +15,90 @@
 
 #include <multitasking/scheduler.h>
 
+/*
+** Per-task signal state (see signal.h):
+** - sig_pending is set by any CPU with an atomic OR, and cleared bit by bit
+**   with an atomic AND by the CPU delivering to the task
+** - sig_blocked and sigactions are only changed by the task itself or
+**   before it runs (fork)
+*/
+
 /**
- * @brief Add a signal to a task
- * @param task
- * @param signum
- * @param handler
- *
- * @note : Add signal to a specific task
- * @note : If the signal already exists, nothing will be done
+ * @brief Signals ignored by the task: nothing to do at delivery
  */
-void task_add_signal(task_t *task, int signum, void (*handler)(int)) {
-    signal_node_t *new_signal = (signal_node_t *)kmalloc(sizeof(signal_node_t));
-    new_signal->signum = signum;
-    new_signal->handler = handler;
-    new_signal->next = NULL;
-
-    if (task->signal_queue == NULL) {
-        task->signal_queue = new_signal;
-    } else {
-        signal_node_t *current = task->signal_queue;
-        while (current->next != NULL) {
-            current = current->next;
-        }
-        current->next = new_signal;
-    }
+static bool __signal_ignored(task_t *task, int32_t signum) {
+    sighandler_t handler = task->sigactions[signum].sa_handler;
+
+    if (handler == SIG_IGN)
+        return (true);
+    return (handler == SIG_DFL && signals[signum].action == NULL);
 }
 
 /**
- * @brief Remove a signal from a task
- * @param task
- * @param signum
- *
- * @note : Remove a signal from a specific task
- * @note : If the signal is not found, nothing will be done
+ * @brief Send a signal to a task
+ * @return 0, -1 if the signal number is invalid
+ * @note : A signal already pending is not queued again. Ignored signals are
+ *         dropped at once, unless blocked: the task may unblock them with a
+ *         handler installed.
  */
-void task_remove_signal(task_t *task, int signum) {
-    if (task->signal_queue == NULL) {
-        return;
-    }
+int32_t task_send_signal(task_t *task, int32_t signum) {
+    sigset_t mask;
 
-    if (task->signal_queue->signum == signum) {
-        signal_node_t *signal = task->signal_queue;
-        task->signal_queue = task->signal_queue->next;
-        kfree(signal);
-        return;
+    if (!signal_valid(signum))
+        return (-1);
+    mask = sigmask(signum);
+    if (!(task->sig_blocked & mask) && __signal_ignored(task, signum))
+        return (0);
+    __atomic_or_fetch(&task->sig_pending, mask, __ATOMIC_SEQ_CST);
+    return (0);
+}
+
+/**
+ * @brief Read and / or change the action of a signal
+ * @return 0, -1 if the signal is invalid or cannot be caught (SIGKILL, SIGSTOP)
+ * @note : Setting SIG_IGN discards the signal if it is pending.
+ */
+int32_t task_sigaction(task_t *task, int32_t signum, const sigaction_t *act, sigaction_t *oldact) {
+    if (!signal_valid(signum) || (act && (sigmask(signum) & SIG_UNBLOCKABLE)))
+        return (-1);
+    if (oldact)
+        *oldact = task->sigactions[signum];
+    if (act) {
+        task->sigactions[signum] = *act;
+        if (__signal_ignored(task, signum))
+            __atomic_and_fetch(&task->sig_pending, ~sigmask(signum), __ATOMIC_SEQ_CST);
     }
+    return (0);
+}
 
-    signal_node_t *current = task->signal_queue;
-    while (current->next != NULL) {
-        if (current->next->signum == signum) {
-            signal_node_t *signal = current->next;
-            current->next = current->next->next;
-            kfree(signal);
-            return;
-        }
-        current = current->next;
+/**
+ * @brief Read and / or change the blocked signals of a task
+ * @param how SIG_BLOCK, SIG_UNBLOCK or SIG_SETMASK
+ * @return 0, -1 if 'how' is invalid
+ * @note : SIGKILL and SIGSTOP are never blocked. Unblocked pending signals
+ *         are delivered at the next switch to the task.
+ */
+int32_t task_sigprocmask(task_t *task, int32_t how, const sigset_t *set, sigset_t *oldset) {
+    if (oldset)
+        *oldset = task->sig_blocked;
+    if (!set)
+        return (0);
+
+    switch (how) {
+    case SIG_BLOCK:
+        task->sig_blocked |= *set;
+        break;
+    case SIG_UNBLOCK:
+        task->sig_blocked &= ~*set;
+        break;
+    case SIG_SETMASK:
+        task->sig_blocked = *set;
+        break;
+    default:
+        return (-1);
     }
+    task->sig_blocked &= ~(SIG_UNBLOCKABLE | sigmask(0));
+    return (0);
 }
 
 // ! ||--------------------------------------------------------------------------------||
@@ -78,11 +106,10 @@ void task_remove_signal(task_t *task, int signum) {
 // ! ||--------------------------------------------------------------------------------||
 
 void task_print_signals(task_t *task) {
-    signal_node_t *current = task->signal_queue;
-    printk("Task: [%d] Signals: ", task->pid);
-    while (current != NULL) {
-        printk("[%d] ", current->signum);
-        current = current->next;
+    printk("Task: [%d] Signals: pending 0x%x, blocked 0x%x, handled", task->pid, task->sig_pending, task->sig_blocked);
+    for (int32_t signum = 1; signum < SIGNALS_COUNT; signum++) {
+        if (task->sigactions[signum].sa_handler != SIG_DFL)
+            printk(" [%d]", signum);
     }
     printk("\n");
 }
@@ -92,27 +119,54 @@ void task_print_signals(task_t *task) {
 // ! ||--------------------------------------------------------------------------------||
 
 /**
- * @brief Handle a signal
- *
- * @param current_task
+ * @brief Run the action of one signal
+ * @note : sa_mask (and the signal itself) are blocked while a task handler
+ *         runs, a signal sent meanwhile is delivered at the next switch.
+ */
+static void __signal_deliver(task_t *task, int32_t signum) {
+    sigaction_t *action = &task->sigactions[signum];
+    sighandler_t handler = action->sa_handler;
+    sigset_t blocked;
+
+    if (handler == SIG_IGN)
+        return;
+    if (handler == SIG_DFL) {
+        if (signals[signum].action)
+            signals[signum].action(task, signum);
+        return;
+    }
+
+    blocked = task->sig_blocked;
+    task->sig_blocked |= (action->sa_mask | sigmask(signum)) & ~SIG_UNBLOCKABLE;
+    handler(signum);
+    task->sig_blocked = blocked;
+}
+
+/**
+ * @brief Deliver the pending signals of a task that are not blocked
+ * @param task
  * @return void
  *
  * @note : This function must be called by the scheduler only !
+ * @note : Nothing pending costs a single AND. The signals deliverable on
+ *         entry are delivered once each, lowest number first: a signal sent
+ *         again by an action stays pending for the next switch.
  *
  * @see scheduler.c
  */
-void __signal_handler(task_t *current_task) {
-    if (current_task->signal_queue == NULL) {
-        return;
-    }
+void __signal_handler(task_t *task) {
+    sigset_t deliverable = task->sig_pending & ~task->sig_blocked;
 
-    signal_node_t *signal = current_task->signal_queue;
-    current_task->signal_queue = signal->next;
+    while (deliverable && task->state == TASK_RUNNING) {
+        int32_t signum = __builtin_ctz(deliverable);
+        sigset_t mask = sigmask(signum);
 
-    if (signal->handler != NULL) {
-        signal->handler(signal->signum);
+        deliverable &= ~mask;
+        /* Blocked or discarded by a previous action meanwhile */
+        if (task->sig_blocked & mask)
+            continue;
+        if (!(__atomic_fetch_and(&task->sig_pending, ~mask, __ATOMIC_SEQ_CST) & mask))
+            continue;
+        __signal_deliver(task, signum);
     }
-
-    /* Free and remove signal */
-    task_remove_signal(current_task, signal->signum);
-}
\ No newline at end of file
+}
@@ -6,57 +6,31 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/21 11:43:16 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/22 15:23:16 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:52:40 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <multitasking/process.h>
 #include <multitasking/scheduler.h>
 
-extern task_t *ready_queue;
-
-static bool __process_is_in_queue_list(task_t *current_task) {
-    task_t *tmp = ready_queue;
-
-    do {
-        if (tmp == current_task)
-            return (true);
-        tmp = tmp->next;
-        if (!tmp) {
-            tmp = ready_queue;
-        }
-    } while (tmp != ready_queue);
-    return (false);
-}
-
+/**
+ * @brief Wake up sleeping tasks
+ * @param current_task
+ *
+ * @note : Only walks the TASK_SLEEPING list of the task table
+ */
 void __process_sleeping(task_t *current_task) {
-    // If there are no tasks, return
-    if (!current_task)
-        return;
+    task_t *tmp = task_state_first(TASK_SLEEPING);
+    __UNUSED(current_task);
 
-    if (__process_is_in_queue_list(current_task) == false)
-        return;
+    while (tmp) {
+        /* Save the link first, waking the task moves it to another list */
+        task_t *next = tmp->state_next;
 
-    // Start from the beginning of the queue
-    task_t *tmp = current_task;
-
-    // Loop through all tasks
-    do {
-        // If the task is sleeping and its wake-up tick has passed, wake it up
-        if (tmp->state == TASK_SLEEPING && tmp->wake_up_tick <= timer_subtick) {
-            // printk("Process %d woke up\n", tmp->pid);
-            tmp->state = TASK_RUNNING;
+        if (tmp->wake_up_tick <= timer_subtick) {
             tmp->wake_up_tick = 0;
-        } else if (tmp->state == TASK_SLEEPING && tmp->wake_up_tick > timer_subtick) {
-            // printk("Process %d is sleeping for %d ticks / %d\n", tmp->pid, tmp->wake_up_tick, timer_subtick);
+            task_set_state(tmp, TASK_RUNNING);
         }
-
-        // Move to the next task
-        tmp = tmp->next;
-
-        if (!tmp)
-            tmp = ready_queue;
-
-        // If we've reached the end of the queue, break the loop
-    } while (tmp != current_task);
-}
\ No newline at end of file
+        tmp = next;
+    }
+}
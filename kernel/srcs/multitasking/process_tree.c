@@ -0,0 +1,213 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   process_tree.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 04:01:34 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:02:46 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/process.h>
+#include <multitasking/scheduler.h>
+#include <multitasking/wait_queue.h>
+
+/*
+** Process tree
+**
+** - Every task links in the children list of its parent: parent points up,
+**   children to the first child, sibling / sibling_prev chain the children
+**   of a same parent. Links are set at fork, before the task is admitted,
+**   and dropped by free_task()
+** - An exiting task gives its children to INIT (the kernel task), walking
+**   only its own children list. INIT is woken if one of them is already a
+**   zombie, it may be sleeping in waitpid()
+** - A process group lives in the subtree of its leader: setpgid() only
+**   joins a group led by an ancestor. Once the leader exited, its members
+**   are children of INIT and the group is looked for from there
+** - All of it is done under tasklist_lock
+*/
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                     LINKS                                      ||
+// ! ||--------------------------------------------------------------------------------||
+
+static void __tree_add(task_t *parent, task_t *child) {
+    child->parent = parent;
+    child->ppid = parent->pid;
+    child->sibling_prev = NULL;
+    child->sibling = parent->children;
+    if (parent->children)
+        parent->children->sibling_prev = child;
+    parent->children = child;
+}
+
+static void __tree_remove(task_t *task) {
+    if (task->sibling_prev)
+        task->sibling_prev->sibling = task->sibling;
+    else if (task->parent)
+        task->parent->children = task->sibling;
+    if (task->sibling)
+        task->sibling->sibling_prev = task->sibling_prev;
+    task->parent = NULL;
+    task->sibling = task->sibling_prev = NULL;
+}
+
+/**
+ * @brief Next task of a preorder walk of the subtree of 'root'
+ * @return NULL once the whole subtree was walked
+ */
+static task_t *__tree_next(task_t *task, task_t *root) {
+    if (task->children)
+        return (task->children);
+    while (task != root) {
+        if (task->sibling)
+            return (task->sibling);
+        task = task->parent;
+    }
+    return (NULL);
+}
+
+static bool __tree_is_ancestor(task_t *ancestor, task_t *task) {
+    for (task = task->parent; task; task = task->parent) {
+        if (task == ancestor)
+            return (true);
+    }
+    return (false);
+}
+
+/**
+ * @brief Make 'child' a child of 'parent', in the process group of its parent
+ * @note : Called by fork and kthread_create() before task_admit(). A NULL
+ *         parent (the kernel task) starts its own group.
+ */
+void task_tree_link(task_t *parent, task_t *child) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+
+    if (parent) {
+        __tree_add(parent, child);
+        child->pgid = parent->pgid;
+    } else {
+        child->ppid = 0;
+        child->pgid = child->pid;
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+}
+
+/**
+ * @brief Remove a task from its parent's children list (free_task)
+ */
+void task_tree_unlink(task_t *task) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+
+    __tree_remove(task);
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+}
+
+/**
+ * @brief Give the children of an exiting task to INIT
+ * @note : O(children). Without INIT (never after init_tasking), they are
+ *         left without parent and reaped as orphans.
+ */
+void task_reparent_children(task_t *task) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    task_t *init = get_task(INIT_PID);
+    task_t *child;
+    bool zombie = false;
+
+    if (task == init) {
+        rspinlock_release_irqrestore(&tasklist_lock, eflags);
+        return;
+    }
+    while ((child = task->children)) {
+        __tree_remove(child);
+        if (init)
+            __tree_add(init, child);
+        else
+            child->ppid = 0;
+        if (child->state == TASK_ZOMBIE && !child->kthread)
+            zombie = true;
+    }
+    if (zombie && init)
+        wake_up_all(&init->child_exit);
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 PROCESS GROUPS                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Move a task to another process group
+ * @param pid The caller or one of its children, 0 for the caller
+ * @param pgid Group to join, 0 to lead a new group named after 'pid'
+ * @return 0, -1 if the task or the group is invalid
+ * @note : The group must be led by an ancestor of the task (or be its own),
+ *         so that task_kill_pgrp() finds it in the leader's subtree.
+ */
+int32_t task_setpgid(pid_t pid, pid_t pgid) {
+    task_t *caller = get_current_task();
+    task_t *task, *leader;
+    int32_t ret = -1;
+    uint32_t eflags;
+
+    if (pgid < 0)
+        __WARN("task_setpgid : invalid group %d", -1, pgid);
+
+    eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    task = pid ? get_task(pid) : caller;
+    if (task && (task == caller || task->parent == caller)) {
+        if (!pgid || pgid == task->pid) {
+            task->pgid = task->pid;
+            ret = 0;
+        } else if ((leader = get_task(pgid)) && leader->pgid == pgid && __tree_is_ancestor(leader, task)) {
+            task->pgid = pgid;
+            ret = 0;
+        }
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+    return (ret);
+}
+
+/**
+ * @brief Process group of a task
+ * @param pid 0 for the caller
+ * @return The group id, -1 if there is no such task
+ */
+pid_t task_getpgid(pid_t pid) {
+    task_t *task;
+    pid_t pgid = -1;
+
+    rcu_read_lock();
+    if ((task = pid ? get_task(pid) : get_current_task()))
+        pgid = task->pgid;
+    rcu_read_unlock();
+    return (pgid);
+}
+
+/**
+ * @brief Send a signal to every process of a group
+ * @return Number of processes signaled, -1 if the group is empty
+ * @note : Only the subtree of the leader is walked, or the whole tree from
+ *         INIT if the leader exited. INIT and kernel threads are skipped.
+ */
+int32_t task_kill_pgrp(pid_t pgid, int32_t signum) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    task_t *root = get_task(pgid);
+    int32_t count = 0;
+
+    if (!root || root->pgid != pgid)
+        root = get_task(INIT_PID);
+    for (task_t *task = root; task; task = __tree_next(task, root)) {
+        if (task->pgid != pgid || task->pid <= INIT_PID || task->kthread)
+            continue;
+        if (task->state == TASK_ZOMBIE || task->state == TASK_STOPPED)
+            continue;
+        if (task_send_signal(task, signum) == 0)
+            count++;
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+    return (count ? count : -1);
+}
@@ -0,0 +1,131 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   process_wait.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:57:53 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:02:46 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/process.h>
+#include <multitasking/scheduler.h>
+#include <multitasking/wait_queue.h>
+
+/*
+** Parent / child exit handshake
+**
+** - An exiting child becomes a zombie, posts SIGCHLD to its parent and
+**   wakes the parent's child_exit queue
+** - waitpid() sleeps on its own child_exit queue until a matching child is
+**   a zombie, then reaps it at once: the exit code is returned and the task
+**   freed (or left to the killer if it is still switching out)
+** - Only the children list of the waiter is walked (see process_tree.c)
+** - Zombies nobody can wait for (kernel threads, orphans adopted by INIT
+**   while it does not wait) are reaped by the scheduler housekeeping, see
+**   process_zombies.c
+*/
+
+static bool __is_waitable_child(task_t *task, pid_t pid) {
+    return (!task->kthread && (pid == -1 || task->pid == pid));
+}
+
+/**
+ * @brief Claim an exited child of 'parent'
+ * @return Pid of the claimed child, 0 if matching children are still alive,
+ *         -1 if there are none
+ * @note : The claimed child goes TASK_STOPPED so no other waiter gets it, its
+ *         exit code is read under the lock (the killer may free it next).
+ */
+static pid_t __waitpid_claim(task_t *parent, pid_t pid, int32_t *exit_code) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    pid_t ret = -1;
+
+    for (task_t *task = parent->children; task; task = task->sibling) {
+        if (!__is_waitable_child(task, pid) || task->state == TASK_STOPPED)
+            continue;
+        if (task->state == TASK_ZOMBIE) {
+            ret = task->pid;
+            *exit_code = task->exit_code;
+            task_set_state(task, TASK_STOPPED);
+            break;
+        }
+        ret = 0;
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+    return (ret);
+}
+
+/**
+ * @brief Free a claimed child, unless it is still on its CPU
+ * @note : A child still switching out is freed by __process_killer().
+ */
+static void __waitpid_reap(pid_t pid) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    task_t *task = get_task(pid);
+
+    if (task && task->state == TASK_STOPPED && !task->on_cpu)
+        free_task(task);
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+}
+
+/**
+ * @brief Wait for a child to exit and reap it
+ * @param pid Child pid, or -1 for any child
+ * @param status Exit code of the child (may be NULL)
+ * @param options WNOHANG to return 0 instead of blocking
+ * @return Pid of the reaped child, 0 (WNOHANG, no child exited yet) or -1
+ *         if the caller has no such child
+ * @note : Blocks on the caller's child_exit queue, using no CPU.
+ */
+pid_t task_waitpid(pid_t pid, int32_t *status, int32_t options) {
+    task_t *parent = get_current_task();
+    int32_t exit_code = 0;
+    pid_t ret;
+
+    if (!parent || pid == 0 || pid < -1)
+        __WARN("task_waitpid : unsupported pid %d", -1, pid);
+
+    if (options & WNOHANG)
+        ret = __waitpid_claim(parent, pid, &exit_code);
+    else
+        wait_event_idle(&parent->child_exit, (ret = __waitpid_claim(parent, pid, &exit_code)) != 0);
+
+    if (ret <= 0)
+        return (ret);
+    if (status)
+        *status = exit_code;
+    __waitpid_reap(ret);
+    return (ret);
+}
+
+/**
+ * @brief Wait for a child to exit
+ * @return Exit code of the child, -1 if 'pid' is not a child of the caller
+ */
+int32_t task_wait(int32_t pid) {
+    int32_t status;
+
+    if (task_waitpid(pid, &status, 0) <= 0)
+        __WARN("task_wait : no child with pid %d", -1, pid);
+    return (status);
+}
+
+/**
+ * @brief Tell the parent of an exiting task
+ * @note : Called once the task is a zombie. Kernel threads are joined
+ *         instead (see kthread.c), they do not notify.
+ */
+void task_notify_parent(task_t *task) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    task_t *parent = task->parent;
+
+    /* Under the lock: the parent may be exiting and giving us to INIT */
+    if (parent && !task->kthread) {
+        task_send_signal(parent, SIGCHLD);
+        wake_up_all(&parent->child_exit);
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+}
@@ -6,55 +6,39 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/10/23 21:11:57 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/26 13:32:20 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:02:46 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <multitasking/process.h>
 #include <multitasking/scheduler.h>
 
-extern task_t *ready_queue;
-
+/**
+ * @brief Reap the zombies nobody will wait for
+ * @param current_task
+ *
+ * @note : Kernel threads (joined, not waited), tasks without parent and the
+ *         children INIT adopted while it sleeps elsewhere than in waitpid()
+ *         (it parks for good once it has no child left). Other zombies are
+ *         reaped by their parent's waitpid().
+ */
 int32_t __process_zombie(task_t *current_task) {
-    task_t *tmp = ready_queue;
-    __UNUSED(current_task);
+    task_t *tmp = task_state_first(TASK_ZOMBIE);
 
     while (tmp) {
-        if (tmp->pid == 0 || tmp->pid == INIT_PID) {
-            tmp = tmp->next;
-            continue;
-        }
-        if (tmp->state == TASK_ZOMBIE) {
-            if (tmp->zombie_hungry >= ZOMBIE_HUNGRY_DIE) {
-
-                task_t *next = tmp->next;
-                printk(_YELLOW "Killing task "_GREEN
-                               "[%d]"_END
-                               "\n",
-                       tmp->pid);
-
-                /* Secure, Kill task only if it's not the current task */
-                if (tmp->pid != current_task->pid) {
-                    int ret = free_task(tmp);
+        task_t *next = tmp->state_next;
+        task_t *parent = tmp->parent;
+        bool orphaned = !parent || parent->state == TASK_ZOMBIE || parent->state == TASK_STOPPED ||
+                        (parent->pid == INIT_PID && parent->wq && parent->wq != &parent->child_exit);
 
-                    if (ret)
-                        return ret;
-                }
-                tmp = next;
+        /* Secure, Kill task only if it's not on a CPU (current task included) */
+        if (tmp->pid > INIT_PID && tmp != current_task && !tmp->on_cpu && (tmp->kthread || orphaned)) {
+            int ret = free_task(tmp);
 
-            } else {
-                tmp->zombie_hungry += ZOMBIE_HUNGRY;
-                printk(_YELLOW "Task "_GREEN
-                               "[%d]"_YELLOW
-                               " is a zombie, waiting for it to die, Hungry: "_GREEN
-                               "[%d]"_END
-                               "\n",
-                       tmp->pid, tmp->zombie_hungry);
-                tmp = tmp->next;
-            }
-        } else {
-            tmp = tmp->next;
+            if (ret < 0)
+                return ret;
         }
+        tmp = next;
     }
     return (0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,180 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   runqueue.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:37:20 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:26:14 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/scheduler.h>
+
+#include <system/percpu.h>
+
+/*
+** Run queues:
+** - Every CPU owns a run queue holding the tasks homed on it, in any state
+** - A task only runs on the CPU of its run queue: task->cpu is both its home
+**   and the last CPU it ran on, so it keeps its caches (and FPU state) warm
+** - A run queue has one queue per scheduling class (see sched_class.h)
+** - A CPU with nothing runnable steals one task from the busiest run queue,
+**   highest class first
+** - task->cpus_allowed bounds both: a task is only homed on, or stolen by,
+**   a CPU of its mask (see kthread_create_on_cpu())
+** - The global ready_queue list is untouched: it stays the list of every
+**   task, walked by the BSP housekeeping (zombies, sleepers, ...)
+*/
+
+static void __runqueue_link(cpu_t *cpu, task_t *task) {
+    runqueue_t *rq = &cpu->rq;
+
+    /* Homed before the class enqueue: the fair class picks the group queue of task->cpu */
+    task->cpu = cpu->id;
+    task->sched_class = task_sched_class(task);
+    task->sched_class->enqueue(rq, task);
+    task->on_rq = true;
+    rq->nr_tasks++;
+}
+
+static void __runqueue_unlink(cpu_t *cpu, task_t *task) {
+    task->sched_class->dequeue(&cpu->rq, task);
+    task->on_rq = false;
+    cpu->rq.nr_tasks--;
+}
+
+/**
+ * @brief Add a task to the run queue of a CPU
+ */
+void runqueue_enqueue(cpu_t *cpu, task_t *task) {
+    uint32_t eflags = spinlock_acquire_irqsave(&cpu->rq.lock);
+
+    __runqueue_link(cpu, task);
+    if (task->state == TASK_RUNNING)
+        cpu->rq.nr_running++;
+    spinlock_release_irqrestore(&cpu->rq.lock, eflags);
+}
+
+/**
+ * @brief Remove a task from its run queue
+ * @note : The task must not be running: a running task cannot be stolen,
+ *         so task->cpu stays valid until the lock is taken.
+ */
+void runqueue_dequeue(task_t *task) {
+    cpu_t *cpu = &cpus[task->cpu];
+    uint32_t eflags = spinlock_acquire_irqsave(&cpu->rq.lock);
+
+    if (task->on_rq)
+        __runqueue_unlink(cpu, task);
+    spinlock_release_irqrestore(&cpu->rq.lock, eflags);
+}
+
+/**
+ * @brief Pick the CPU of a new (or re-admitted) task
+ * @note : The last CPU of the task is kept unless another one is clearly
+ *         less loaded (fork balancing without bouncing between equal CPUs).
+ *         Falls back to the BSP if no CPU of its mask is online.
+ */
+cpu_t *runqueue_select_cpu(task_t *task) {
+    cpu_t *best = &cpus[task->cpu < cpu_count ? task->cpu : 0];
+
+    if (!best->online || !runqueue_cpu_allowed(task, best)) {
+        best = NULL;
+        for (uint32_t i = 0; i < cpu_count && !best; i++) {
+            if (cpus[i].online && runqueue_cpu_allowed(task, &cpus[i]))
+                best = &cpus[i];
+        }
+        if (!best)
+            return (&cpus[0]);
+    }
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        cpu_t *cpu = &cpus[i];
+
+        if (cpu->online && runqueue_cpu_allowed(task, cpu) && cpu->rq.nr_running + 1 < best->rq.nr_running)
+            best = cpu;
+    }
+    return (best);
+}
+
+/**
+ * @brief Pull a runnable task from the busiest run queue
+ * @note : Called with interrupts disabled and no run queue lock held. Only
+ *         queues with a task waiting for the CPU are candidates, and never
+ *         a task still on a CPU or owning the FPU registers of its CPU (its
+ *         state would be left behind).
+ */
+task_t *runqueue_steal(cpu_t *cpu) {
+    cpu_t *busiest = NULL;
+    task_t *task;
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        cpu_t *victim = &cpus[i];
+
+        if (victim == cpu || !victim->online || victim->rq.nr_running < 2)
+            continue;
+        if (!busiest || victim->rq.nr_running > busiest->rq.nr_running)
+            busiest = victim;
+    }
+    if (!busiest)
+        return (NULL);
+
+    spinlock_acquire(&busiest->rq.lock);
+    task = NULL;
+    for_each_class(class) {
+        if ((task = class->steal(&busiest->rq, busiest->fpu_owner, cpu)))
+            break;
+    }
+    if (task) {
+        __runqueue_unlink(busiest, task);
+        busiest->rq.nr_running--;
+        task->on_cpu = true;
+    }
+    spinlock_release(&busiest->rq.lock);
+
+    if (!task)
+        return (NULL);
+
+    spinlock_acquire(&cpu->rq.lock);
+    __runqueue_link(cpu, task);
+    cpu->rq.nr_running++;
+    spinlock_release(&cpu->rq.lock);
+    cpu->steals++;
+    return (task);
+}
+
+/**
+ * @brief Lock the run queue a task is homed on
+ * @note : task->cpu may change (steal) until its run queue lock is held,
+ *         retry until the locked queue is still the task's one.
+ */
+cpu_t *task_rq_lock(task_t *task, uint32_t *eflags) {
+    cpu_t *cpu;
+
+    for (;;) {
+        cpu = &cpus[task->cpu];
+        *eflags = spinlock_acquire_irqsave(&cpu->rq.lock);
+        if (task->cpu == cpu->id)
+            return (cpu);
+        spinlock_release_irqrestore(&cpu->rq.lock, *eflags);
+    }
+}
+
+void task_rq_unlock(cpu_t *cpu, uint32_t eflags) {
+    spinlock_release_irqrestore(&cpu->rq.lock, eflags);
+}
+
+/**
+ * @brief Link / unlink a task in the queue of its class, run queue locked
+ * @note : Used around policy changes (sched_setscheduler()): unlink with
+ *         the old policy and RT priority, link with the new ones.
+ */
+void runqueue_link_locked(cpu_t *cpu, task_t *task) {
+    __runqueue_link(cpu, task);
+}
+
+void runqueue_unlink_locked(cpu_t *cpu, task_t *task) {
+    __runqueue_unlink(cpu, task);
+}
@@ -0,0 +1,503 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   sched_fair.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:22:29 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:26:15 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+
+#include <multitasking/sched_group.h>
+#include <multitasking/scheduler.h>
+
+#include <system/clocksource.h>
+
+#include <asm/div64.h>
+
+/*
+** Fair class (CFS): SCHED_NORMAL tasks
+**
+** - Every entity accumulates a virtual runtime: its runtime (sched_clock())
+**   scaled by SCHED_WEIGHT_NICE_0 / weight. Queued entities sit in a
+**   red-black tree by vruntime, the leftmost one (lowest vruntime) runs next
+** - Entities are tasks (weight from their task_priority_t) and fair-share
+**   groups (weight from their shares, see sched_group.h): the pick walks
+**   down from the top level queue through the group queues to a task
+** - The running entity of a queue (cfs_rq->curr) is out of its tree. It
+**   keeps the CPU until it ran its slice: its share (weight / load) of the
+**   period, the period is sched_latency_ns, stretched to
+**   nr_running * sched_min_granularity_ns
+** - A woken entity is placed at min_vruntime minus half a latency at most
+**   (sleepers get a bounded credit) and preempts the running one when it is
+**   more than sched_wakeup_granularity_ns behind at the first common level
+** - Task vruntimes are relative to min_vruntime while a task is not homed
+**   on a run queue: a migrated task keeps its lag
+*/
+
+uint32_t sched_latency_ns = SCHED_LATENCY_NS;
+uint32_t sched_min_granularity_ns = SCHED_MIN_GRANULARITY_NS;
+uint32_t sched_wakeup_granularity_ns = SCHED_WAKEUP_GRANULARITY_NS;
+
+/* Weights of the nice levels 5, 0, -5 and -10 (x1.25 per nice level) */
+static const uint32_t sched_prio_to_weight[TASK_PRIORITY_REALTIME + 1] = {
+    [TASK_PRIORITY_LOW] = 335,
+    [TASK_PRIORITY_MEDIUM] = SCHED_WEIGHT_NICE_0,
+    [TASK_PRIORITY_HIGH] = 3121,
+    [TASK_PRIORITY_REALTIME] = 9548, // Not a fair priority: RT waiters boost into the RT class
+};
+
+#define for_each_sched_entity(se) for (; se; se = se->parent)
+
+static inline uint32_t __fair_weight(task_t *task) {
+    return (sched_prio_to_weight[task->priority <= TASK_PRIORITY_REALTIME ? task->priority : TASK_PRIORITY_MEDIUM]);
+}
+
+static inline bool __vruntime_before(uint64_t a, uint64_t b) {
+    return ((int64_t)(a - b) < 0);
+}
+
+static inline sched_entity_t *__se_of(rb_node_t *node) {
+    return (node ? rb_entry(node, sched_entity_t, run_node) : NULL);
+}
+
+static inline task_t *__task_of(sched_entity_t *se) {
+    return (rb_entry(se, task_t, se));
+}
+
+/**
+ * @brief Scale a runtime to virtual runtime for a given weight
+ */
+static inline uint64_t __calc_delta_fair(uint64_t delta_ns, uint32_t weight) {
+    if (weight == SCHED_WEIGHT_NICE_0)
+        return (delta_ns);
+    return (div_u64(delta_ns * SCHED_WEIGHT_NICE_0, weight ? weight : 1));
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    TIMELINE                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+static void __timeline_insert(cfs_rq_t *cfs, sched_entity_t *se) {
+    rb_node_t **link = &cfs->timeline.node, *parent = NULL;
+    bool leftmost = true;
+
+    while (*link) {
+        parent = *link;
+        if (__vruntime_before(se->vruntime, __se_of(parent)->vruntime)) {
+            link = &parent->left;
+        } else {
+            link = &parent->right;
+            leftmost = false;
+        }
+    }
+    rb_link_node(&se->run_node, parent, link);
+    rb_insert_color(&se->run_node, &cfs->timeline, leftmost);
+}
+
+/**
+ * @brief Move min_vruntime forward to the lowest queued vruntime
+ */
+static void __update_min_vruntime(cfs_rq_t *cfs) {
+    sched_entity_t *left = __se_of(rb_first(&cfs->timeline));
+    sched_entity_t *curr = cfs->curr && cfs->curr->queued ? cfs->curr : NULL;
+    uint64_t vruntime = cfs->min_vruntime;
+
+    if (curr)
+        vruntime = curr->vruntime;
+    if (left && (!curr || __vruntime_before(left->vruntime, vruntime)))
+        vruntime = left->vruntime;
+    if (__vruntime_before(cfs->min_vruntime, vruntime))
+        cfs->min_vruntime = vruntime;
+}
+
+/**
+ * @brief Charge the running entity of a queue for the time since exec_start
+ */
+static void __update_curr(cfs_rq_t *cfs) {
+    sched_entity_t *curr = cfs->curr;
+    uint64_t now, delta;
+
+    if (!curr)
+        return;
+
+    now = sched_clock();
+    delta = sched_clock_to_ns(now - cfs->exec_start);
+    cfs->exec_start = now;
+
+    curr->sum_exec_ns += delta;
+    curr->vruntime += __calc_delta_fair(delta, curr->weight);
+    __update_min_vruntime(cfs);
+}
+
+/**
+ * @brief Account a runnable entity, in the tree unless it is running
+ */
+static void __enqueue_entity(cfs_rq_t *cfs, sched_entity_t *se) {
+    se->queued = true;
+    cfs->nr_running++;
+    cfs->load += se->weight;
+    if (se != cfs->curr)
+        __timeline_insert(cfs, se);
+}
+
+static void __dequeue_entity(cfs_rq_t *cfs, sched_entity_t *se) {
+    if (se != cfs->curr)
+        rb_erase(&se->run_node, &cfs->timeline);
+    if (cfs->skip == se)
+        cfs->skip = NULL;
+    se->queued = false;
+    cfs->nr_running--;
+    cfs->load -= se->weight;
+}
+
+static void __reweight_entity(cfs_rq_t *cfs, sched_entity_t *se, uint32_t weight) {
+    if (se->queued)
+        cfs->load = cfs->load - se->weight + weight;
+    se->weight = weight;
+}
+
+/**
+ * @brief Time slice of an entity: its share of the scheduling period
+ */
+static uint64_t __sched_slice(cfs_rq_t *cfs, sched_entity_t *se) {
+    uint64_t period = sched_latency_ns;
+    uint32_t load = cfs->load ? cfs->load : se->weight;
+
+    if (sched_min_granularity_ns && cfs->nr_running > sched_latency_ns / sched_min_granularity_ns)
+        period = (uint64_t)cfs->nr_running * sched_min_granularity_ns;
+    return (div_u64(period * se->weight, load ? load : 1));
+}
+
+/**
+ * @brief Vruntime of a waking entity: no less than min_vruntime - latency / 2
+ */
+static void __place_entity(cfs_rq_t *cfs, sched_entity_t *se) {
+    uint64_t credit = sched_latency_ns / 2;
+    uint64_t vruntime = cfs->min_vruntime > credit ? cfs->min_vruntime - credit : 0;
+
+    if (__vruntime_before(se->vruntime, vruntime))
+        se->vruntime = vruntime;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  GROUP WEIGHT                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Weight of a group entity: the group shares, split between CPUs by load
+ * @note : The loads of the other CPUs are read unlocked, it is an estimate.
+ */
+static void __update_group(sched_entity_t *se) {
+    task_group_t *tg = se->my_q->tg;
+    uint32_t load = se->my_q->load, total = 0;
+    uint32_t shares = tg->shares, weight = shares;
+
+    for (uint32_t i = 0; i < cpu_count; i++)
+        total += tg->cfs[i].load;
+    if (total && load < total)
+        weight = (uint32_t)div_u64((uint64_t)shares * load, total);
+    if (weight < SCHED_GROUP_SHARES_MIN)
+        weight = SCHED_GROUP_SHARES_MIN;
+    if (weight != se->weight)
+        __reweight_entity(se->cfs_rq, se, weight);
+}
+
+static void __update_groups(sched_entity_t *se) {
+    for_each_sched_entity(se) __update_group(se);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   TASK LEVEL                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Queue a runnable task, and its groups that were not queued yet
+ */
+static void __enqueue_task(task_t *task, bool wakeup) {
+    sched_entity_t *se = &task->se;
+
+    if (!se->queued)
+        se->weight = __fair_weight(task);
+
+    for_each_sched_entity(se) {
+        cfs_rq_t *cfs = se->cfs_rq;
+
+        if (se->queued)
+            break;
+        __update_curr(cfs);
+        if (wakeup || se->my_q)
+            __place_entity(cfs, se);
+        __enqueue_entity(cfs, se);
+        cfs->h_nr_running++;
+    }
+    for_each_sched_entity(se) se->cfs_rq->h_nr_running++;
+
+    __update_groups(task->se.parent);
+}
+
+/**
+ * @brief Dequeue a task, and its groups left without runnable tasks
+ */
+static void __dequeue_task(task_t *task) {
+    sched_entity_t *se = &task->se;
+
+    for_each_sched_entity(se) {
+        cfs_rq_t *cfs = se->cfs_rq;
+
+        __update_curr(cfs);
+        __dequeue_entity(cfs, se);
+        cfs->h_nr_running--;
+        if (cfs->nr_running) {
+            se = se->parent;
+            break;
+        }
+    }
+    for_each_sched_entity(se) se->cfs_rq->h_nr_running--;
+
+    __update_groups(task->se.parent);
+}
+
+static void __put_prev_entity(cfs_rq_t *cfs, sched_entity_t *se) {
+    if (cfs->curr != se)
+        return;
+    __update_curr(cfs);
+    cfs->curr = NULL;
+    if (se->queued)
+        __timeline_insert(cfs, se);
+}
+
+/**
+ * @brief Give the CPU to an entity, a new slice starts unless it is only kept
+ */
+static void __set_next_entity(cfs_rq_t *cfs, sched_entity_t *se, bool resched) {
+    if (se->queued && cfs->curr != se)
+        rb_erase(&se->run_node, &cfs->timeline);
+    if (cfs->last != se || resched)
+        se->prev_sum_exec_ns = se->sum_exec_ns;
+    cfs->curr = cfs->last = se;
+    cfs->exec_start = sched_clock();
+    if (cfs->skip == se)
+        cfs->skip = NULL;
+}
+
+/**
+ * @brief Leftmost entity of a queue, the one that yielded only if it is alone
+ * @note : Tasks still switching out (prev) are the only on_cpu ones of a tree.
+ */
+static sched_entity_t *__pick_entity(cfs_rq_t *cfs, task_t *prev) {
+    sched_entity_t *se = __se_of(rb_first(&cfs->timeline));
+
+    while (se && ((!se->my_q && __task_of(se)->on_cpu && __task_of(se) != prev) || (se == cfs->skip && rb_next(&se->run_node))))
+        se = __se_of(rb_next(&se->run_node));
+    return (se);
+}
+
+/**
+ * @brief Slice check of a running entity at its level
+ */
+static void __check_preempt_tick(cfs_rq_t *top, cfs_rq_t *cfs, sched_entity_t *curr) {
+    sched_entity_t *left;
+    uint64_t ideal = __sched_slice(cfs, curr);
+    uint64_t ran = curr->sum_exec_ns - curr->prev_sum_exec_ns;
+
+    if (ran > ideal) {
+        top->resched = true;
+        return;
+    }
+    /* Far ahead of the leftmost entity: let it catch up */
+    left = __se_of(rb_first(&cfs->timeline));
+    if (left && ran >= sched_min_granularity_ns && __vruntime_before(left->vruntime + ideal, curr->vruntime))
+        top->resched = true;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   CLASS OPS                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Home a task: attach its entity to its group queue on task->cpu
+ */
+static void __fair_enqueue(runqueue_t *rq, task_t *task) {
+    task_group_t *tg = task_group_of(task);
+    sched_entity_t *se = &task->se;
+
+    __UNUSED(rq);
+    se->cfs_rq = &tg->cfs[task->cpu];
+    se->parent = &tg->se[task->cpu];
+    se->my_q = NULL;
+    se->queued = false;
+    se->vruntime += se->cfs_rq->min_vruntime;
+    if (task->state == TASK_RUNNING)
+        __enqueue_task(task, false);
+}
+
+static void __fair_put_prev(runqueue_t *rq, task_t *prev) {
+    sched_entity_t *se = &prev->se;
+
+    __UNUSED(rq);
+    if (se->cfs_rq->curr == se) {
+        __update_curr(se->cfs_rq);
+        /* Priority changes are applied while the task is out of the tree */
+        if (se->queued)
+            __reweight_entity(se->cfs_rq, se, __fair_weight(prev));
+    }
+    for_each_sched_entity(se) __put_prev_entity(se->cfs_rq, se);
+}
+
+static void __fair_dequeue(runqueue_t *rq, task_t *task) {
+    sched_entity_t *se = &task->se;
+
+    /* Leaving while running (exit, policy change): drop it as curr first */
+    if (se->cfs_rq->curr == se)
+        __fair_put_prev(rq, task);
+    if (se->queued)
+        __dequeue_task(task);
+    se->vruntime = se->vruntime > se->cfs_rq->min_vruntime ? se->vruntime - se->cfs_rq->min_vruntime : 0;
+}
+
+/**
+ * @brief Walk down from the top level queue to a task
+ * @note : put_prev() already put prev back in the trees, prev keeps the CPU
+ *         while its slice lasts.
+ */
+static task_t *__fair_pick_next(runqueue_t *rq, task_t *prev) {
+    cfs_rq_t *cfs = &rq->cfs;
+    sched_entity_t *se;
+
+    if (!cfs->nr_running)
+        return (NULL);
+    if (prev->on_rq && prev->sched_class == &fair_sched_class && prev->se.queued && !cfs->resched)
+        return (prev);
+
+    do {
+        if (!(se = __pick_entity(cfs, prev)))
+            return (NULL);
+        cfs = se->my_q;
+    } while (cfs);
+    return (__task_of(se));
+}
+
+static task_t *__fair_steal_from(cfs_rq_t *cfs, task_t *exclude, cpu_t *thief) {
+    task_t *task;
+
+    for (rb_node_t *node = rb_first(&cfs->timeline); node; node = rb_next(node)) {
+        sched_entity_t *se = __se_of(node);
+
+        if (se->my_q) {
+            if ((task = __fair_steal_from(se->my_q, exclude, thief)))
+                return (task);
+        } else if (!(task = __task_of(se))->on_cpu && task != exclude && runqueue_cpu_allowed(task, thief)) {
+            return (task);
+        }
+    }
+    return (NULL);
+}
+
+static task_t *__fair_steal(runqueue_t *rq, task_t *exclude, cpu_t *thief) {
+    return (__fair_steal_from(&rq->cfs, exclude, thief));
+}
+
+static void __fair_set_next(runqueue_t *rq, task_t *next) {
+    sched_entity_t *se = &next->se;
+
+    for_each_sched_entity(se) __set_next_entity(se->cfs_rq, se, rq->cfs.resched);
+    rq->cfs.resched = false;
+}
+
+/**
+ * @brief Tick of a running fair task: charge every level, end used slices
+ */
+static void __fair_task_tick(runqueue_t *rq, task_t *curr) {
+    sched_entity_t *se = &curr->se;
+
+    for_each_sched_entity(se) {
+        cfs_rq_t *cfs = se->cfs_rq;
+
+        if (cfs->curr != se)
+            return;
+        __update_curr(cfs);
+        if (se->my_q)
+            __update_group(se);
+        __check_preempt_tick(&rq->cfs, cfs, se);
+    }
+}
+
+static void __fair_task_woken(runqueue_t *rq, task_t *task) {
+    __UNUSED(rq);
+    if (!task->se.queued)
+        __enqueue_task(task, true);
+}
+
+static void __fair_task_sleep(runqueue_t *rq, task_t *task) {
+    __UNUSED(rq);
+    if (task->se.queued)
+        __dequeue_task(task);
+}
+
+static void __fair_yield_task(runqueue_t *rq, task_t *curr) {
+    sched_entity_t *se = &curr->se;
+
+    for_each_sched_entity(se) se->cfs_rq->skip = se;
+    rq->cfs.resched = true;
+}
+
+/**
+ * @brief A woken task preempts curr if it is a wakeup granularity behind
+ * @note : Compared at the first level where both have an entity in the same
+ *         queue: a task of another group preempts through its group.
+ */
+static bool __fair_check_preempt(runqueue_t *rq, task_t *curr, task_t *task) {
+    sched_entity_t *se = &curr->se, *pse = &task->se;
+
+    if (se->cfs_rq->curr != se)
+        return (false);
+    while (se->cfs_rq != pse->cfs_rq) {
+        se = se->parent;
+        pse = pse->parent;
+        if (!se || !pse)
+            return (false);
+    }
+    __update_curr(se->cfs_rq);
+    if (!__vruntime_before(pse->vruntime + __calc_delta_fair(sched_wakeup_granularity_ns, pse->weight), se->vruntime))
+        return (false);
+    rq->cfs.resched = true;
+    return (true);
+}
+
+const sched_class_t fair_sched_class = {
+    .name = "fair",
+    .next = NULL,
+    .enqueue = __fair_enqueue,
+    .dequeue = __fair_dequeue,
+    .pick_next = __fair_pick_next,
+    .steal = __fair_steal,
+    .put_prev = __fair_put_prev,
+    .set_next = __fair_set_next,
+    .task_tick = __fair_task_tick,
+    .task_woken = __fair_task_woken,
+    .task_sleep = __fair_task_sleep,
+    .yield_task = __fair_yield_task,
+    .check_preempt = __fair_check_preempt,
+};
+
+/**
+ * @brief Set up the entity and queue of a group on a CPU
+ */
+void sched_group_init_cpu(task_group_t *tg, uint32_t cpu) {
+    cfs_rq_t *cfs = &tg->cfs[cpu];
+    sched_entity_t *se = &tg->se[cpu];
+
+    *cfs = (cfs_rq_t){0};
+    cfs->tg = tg;
+    cfs->cpu = cpu;
+
+    *se = (sched_entity_t){0};
+    se->weight = tg->shares;
+    se->cfs_rq = &cpus[cpu].rq.cfs;
+    se->my_q = cfs;
+    se->parent = NULL;
+}
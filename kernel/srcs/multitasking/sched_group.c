@@ -0,0 +1,162 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   sched_group.c                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:35:33 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:36:26 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/sched_group.h>
+#include <multitasking/scheduler.h>
+
+#include <memory/kheap.h>
+
+#include <system/rcu.h>
+#include <system/spinlock.h>
+
+/*
+** Fair-share groups:
+** - Every fair task belongs to the group of its uid (or gid), default_task_group
+**   (id 0, root) holds the tasks that never changed credentials
+** - A group gets CPU time by its shares against the other groups with
+**   runnable tasks, whatever its number of tasks: a user running 10 tasks
+**   gets as much as a user running 1 at equal shares
+** - Groups are linked on sched_groups, created on first use and never freed:
+**   a task entity may still point to the queues of a group it just left
+*/
+
+task_group_t default_task_group = {.id = 0, .shares = SCHED_GROUP_SHARES_DEFAULT};
+sched_group_key_t sched_group_key = SCHED_GROUP_BY_UID;
+
+static task_group_t *sched_groups = &default_task_group;
+static spinlock_t sched_groups_lock = SPINLOCK_INIT;
+
+static void __sched_group_setup(task_group_t *tg) {
+    for (uint32_t i = 0; i < PERCPU_MAX_CPUS; i++)
+        sched_group_init_cpu(tg, i);
+}
+
+/**
+ * @brief Set up the queues of the default group, before the first task
+ */
+void sched_group_init(void) {
+    __sched_group_setup(&default_task_group);
+}
+
+static task_group_t *__sched_group_find(uint32_t id) {
+    for (task_group_t *tg = sched_groups; tg; tg = tg->next) {
+        if (tg->id == id)
+            return (tg);
+    }
+    return (NULL);
+}
+
+/**
+ * @brief Group of an id, created on first use
+ * @note : Allocates, call from process context. NULL if out of memory.
+ */
+task_group_t *sched_group_get(uint32_t id) {
+    task_group_t *tg, *new_tg;
+    uint32_t eflags;
+
+    eflags = spinlock_acquire_irqsave(&sched_groups_lock);
+    tg = __sched_group_find(id);
+    spinlock_release_irqrestore(&sched_groups_lock, eflags);
+    if (tg)
+        return (tg);
+
+    if (!(new_tg = (task_group_t *)kmalloc(sizeof(task_group_t))))
+        __THROW("sched_group_get : kmalloc failed", NULL);
+    new_tg->id = id;
+    new_tg->shares = SCHED_GROUP_SHARES_DEFAULT;
+    __sched_group_setup(new_tg);
+
+    /* Created by someone else meanwhile: keep theirs */
+    eflags = spinlock_acquire_irqsave(&sched_groups_lock);
+    if (!(tg = __sched_group_find(id))) {
+        new_tg->next = sched_groups;
+        sched_groups = tg = new_tg;
+        new_tg = NULL;
+    }
+    spinlock_release_irqrestore(&sched_groups_lock, eflags);
+
+    if (new_tg)
+        kfree(new_tg);
+    return (tg);
+}
+
+task_group_t *task_group_of(task_t *task) {
+    return (task->sched_group ? task->sched_group : &default_task_group);
+}
+
+/**
+ * @brief Move a task to the group of its credentials
+ * @note : Called when its uid / gid changes, the task stays in its group if
+ *         the new one cannot be allocated.
+ */
+void sched_group_attach(task_t *task) {
+    uint32_t id = sched_group_key == SCHED_GROUP_BY_GID ? task->task_id.gid : task->task_id.uid;
+    task_group_t *tg;
+
+    if ((tg = sched_group_get(id)))
+        sched_move_task(task, tg);
+}
+
+/**
+ * @brief Set the shares of a group, -1 if out of range
+ * @note : Applied to the group entities at their next tick or enqueue.
+ */
+int32_t sched_group_set_shares(uint32_t id, uint32_t shares) {
+    task_group_t *tg;
+
+    if (shares < SCHED_GROUP_SHARES_MIN || shares > SCHED_GROUP_SHARES_MAX)
+        return (-1);
+    if (!(tg = sched_group_get(id)))
+        return (-1);
+    tg->shares = shares;
+    return (0);
+}
+
+/**
+ * @brief Group tasks by uid or gid, every task is moved to its new group
+ */
+void sched_group_set_key(sched_group_key_t key) {
+    sched_group_key = key;
+
+    rcu_read_lock();
+    for (task_t *task = rcu_dereference(ready_queue); task; task = rcu_dereference(task->next))
+        sched_group_attach(task);
+    rcu_read_unlock();
+}
+
+/**
+ * @brief Groups, their runnable tasks per CPU and the CPU usage of their members
+ */
+void sched_group_print(void) {
+    uint32_t eflags;
+
+    printk("Fair-share groups by " _GREEN "%s" _END "\n", sched_group_key == SCHED_GROUP_BY_GID ? "gid" : "uid");
+
+    eflags = spinlock_acquire_irqsave(&sched_groups_lock);
+    for (task_group_t *tg = sched_groups; tg; tg = tg->next) {
+        uint32_t usage = 0;
+
+        rcu_read_lock();
+        for (task_t *task = rcu_dereference(ready_queue); task; task = rcu_dereference(task->next)) {
+            if (task_group_of(task) == tg && task->policy == SCHED_NORMAL)
+                usage += get_cpu_load(task);
+        }
+        rcu_read_unlock();
+
+        printk("Group " _GREEN "[%u]" _END ": shares %u, CPU " _YELLOW "%u.%u%s" _END ", runnable", tg->id, tg->shares, usage / 10,
+               usage % 10, "%");
+        for (uint32_t i = 0; i < cpu_count; i++)
+            printk(" %u", tg->cfs[i].h_nr_running);
+        printk("\n");
+    }
+    spinlock_release_irqrestore(&sched_groups_lock, eflags);
+}
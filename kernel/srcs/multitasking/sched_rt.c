@@ -0,0 +1,264 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   sched_rt.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:22:17 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:26:15 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/scheduler.h>
+
+#include <system/clocksource.h>
+
+#include <asm/div64.h>
+
+/*
+** Realtime class
+**
+** - Levels are task_rt_prio(): the RT priority of the task, or the one a
+**   PI mutex waiter lent it (a boosted SCHED_NORMAL task runs as FIFO)
+** - One FIFO per priority level and a bitmap of the non-empty levels: the
+**   pick takes the head of the highest level, in constant time
+** - Only runnable tasks are queued: a task leaves its FIFO when it stops
+**   being RUNNING (task_sleep) and goes back to the tail when woken
+** - SCHED_FIFO tasks keep their place, SCHED_RR tasks go to the tail of
+**   their level once their slice is used (sched_rr_timeslice_ms)
+** - A higher level preempts the running task at once (see sched_wakeup())
+** - Throttling: RT tasks of a CPU may not run more than sched_rt_runtime_us
+**   per sched_rt_period_us, the rest of the period goes to the lower classes
+*/
+
+uint32_t sched_rr_timeslice_ms = SCHED_RR_TIMESLICE_MS;
+uint32_t sched_rt_period_us = SCHED_RT_PERIOD_US;
+uint32_t sched_rt_runtime_us = SCHED_RT_RUNTIME_US;
+
+static inline bool __rt_throttling(void) {
+    return (sched_rt_runtime_us < sched_rt_period_us);
+}
+
+static inline uint64_t __rr_timeslice_ns(void) {
+    return ((uint64_t)sched_rr_timeslice_ms * NSEC_PER_MSEC);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                     QUEUES                                     ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Link a runnable task at the tail of its level
+ */
+static void __rt_queue(rt_rq_t *rt, task_t *task) {
+    uint32_t level = task_rt_prio(task);
+
+    task->rt_level = level;
+    task->rt_next = NULL;
+    task->rt_prev = rt->tail[level];
+    if (rt->tail[level])
+        rt->tail[level]->rt_next = task;
+    else
+        rt->head[level] = task;
+    rt->tail[level] = task;
+    rt->bitmap |= (1U << level);
+    rt->nr_running++;
+}
+
+/**
+ * @brief Unlink a task from the level it was queued at
+ */
+static void __rt_unqueue(rt_rq_t *rt, task_t *task) {
+    uint32_t level = task->rt_level;
+
+    if (task->rt_prev)
+        task->rt_prev->rt_next = task->rt_next;
+    else
+        rt->head[level] = task->rt_next;
+    if (task->rt_next)
+        task->rt_next->rt_prev = task->rt_prev;
+    else
+        rt->tail[level] = task->rt_prev;
+    task->rt_next = task->rt_prev = NULL;
+    task->rt_level = 0;
+    if (!rt->head[level])
+        rt->bitmap &= ~(1U << level);
+    rt->nr_running--;
+}
+
+/**
+ * @brief Move a task to the tail of its level
+ * @note : The tick may land between a task leaving RUNNING and its
+ *         task_sleep hook: it is never queued back then.
+ */
+static void __rt_requeue_tail(rt_rq_t *rt, task_t *task) {
+    if (task->rt_level && rt->tail[task->rt_level] == task)
+        return;
+    if (task->rt_level)
+        __rt_unqueue(rt, task);
+    if (task->state == TASK_RUNNING)
+        __rt_queue(rt, task);
+}
+
+/**
+ * @brief Home a task: queued at once if it is runnable
+ */
+static void __rt_enqueue(runqueue_t *rq, task_t *task) {
+    task->rt_level = 0;
+    if (task->state == TASK_RUNNING)
+        __rt_queue(&rq->rt, task);
+}
+
+static void __rt_dequeue(runqueue_t *rq, task_t *task) {
+    if (task->rt_level)
+        __rt_unqueue(&rq->rt, task);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   THROTTLING                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Start a new throttling period once the current one is over
+ */
+static void __rt_update_period(rt_rq_t *rt, uint64_t now) {
+    if (sched_clock_to_ns(now - rt->period_start) < (uint64_t)sched_rt_period_us * NSEC_PER_USEC)
+        return;
+    rt->period_start = now;
+    rt->runtime_ns = 0;
+    rt->throttled = false;
+}
+
+/**
+ * @brief Charge the running RT task for the time since exec_start
+ * @note : Consumes the SCHED_RR slice and the RT runtime of the period.
+ */
+static void __rt_update_curr(runqueue_t *rq, task_t *curr) {
+    rt_rq_t *rt = &rq->rt;
+    uint64_t now = sched_clock();
+    uint64_t delta = sched_clock_to_ns(now - rt->exec_start);
+
+    rt->exec_start = now;
+    __rt_update_period(rt, now);
+
+    if (curr->policy == SCHED_RR)
+        curr->rt_slice_ns = curr->rt_slice_ns > delta ? curr->rt_slice_ns - delta : 0;
+
+    if (!__rt_throttling())
+        return;
+    rt->runtime_ns += delta;
+    if (!rt->throttled && rt->runtime_ns >= (uint64_t)sched_rt_runtime_us * NSEC_PER_USEC) {
+        rt->throttled = true;
+        rt->throttles++;
+    }
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   CLASS OPS                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Head of the highest non-empty level
+ * @note : Returns NULL while the run queue is throttled. The only queued
+ *         task that may be on a CPU is prev, still switching out (a head
+ *         on another CPU is passed, see the fair class).
+ */
+static task_t *__rt_pick_next(runqueue_t *rq, task_t *prev) {
+    rt_rq_t *rt = &rq->rt;
+
+    __rt_update_period(rt, sched_clock());
+    if (rt->throttled)
+        return (NULL);
+
+    for (uint32_t bits = rt->bitmap; bits;) {
+        uint32_t level = 31 - __builtin_clz(bits);
+        task_t *task = rt->head[level];
+
+        while (task && task->on_cpu && task != prev)
+            task = task->rt_next;
+        if (task)
+            return (task);
+        bits &= ~(1U << level);
+    }
+    return (NULL);
+}
+
+/**
+ * @brief First runnable RT task that may leave this run queue
+ */
+static task_t *__rt_steal(runqueue_t *rq, task_t *exclude, cpu_t *thief) {
+    for (uint32_t bits = rq->rt.bitmap; bits;) {
+        uint32_t level = 31 - __builtin_clz(bits);
+
+        for (task_t *task = rq->rt.head[level]; task; task = task->rt_next) {
+            if (!task->on_cpu && task != exclude && runqueue_cpu_allowed(task, thief))
+                return (task);
+        }
+        bits &= ~(1U << level);
+    }
+    return (NULL);
+}
+
+static void __rt_put_prev(runqueue_t *rq, task_t *prev) {
+    __rt_update_curr(rq, prev);
+}
+
+static void __rt_set_next(runqueue_t *rq, task_t *next) {
+    rq->rt.exec_start = sched_clock();
+    if (next->policy == SCHED_RR && !next->rt_slice_ns)
+        next->rt_slice_ns = __rr_timeslice_ns();
+}
+
+/**
+ * @brief Tick of a running RT task: rotate SCHED_RR tasks with a used slice
+ */
+static void __rt_task_tick(runqueue_t *rq, task_t *curr) {
+    __rt_update_curr(rq, curr);
+
+    if (curr->policy != SCHED_RR || curr->rt_slice_ns)
+        return;
+    curr->rt_slice_ns = __rr_timeslice_ns();
+    __rt_requeue_tail(&rq->rt, curr);
+}
+
+/**
+ * @brief A woken task goes to the tail of its level
+ */
+static void __rt_task_woken(runqueue_t *rq, task_t *task) {
+    __rt_requeue_tail(&rq->rt, task);
+}
+
+/**
+ * @brief A task that stopped being RUNNING leaves its level
+ */
+static void __rt_task_sleep(runqueue_t *rq, task_t *task) {
+    __rt_dequeue(rq, task);
+}
+
+/**
+ * @brief sched_yield() of an RT task: last of its level
+ */
+static void __rt_yield_task(runqueue_t *rq, task_t *curr) {
+    __rt_requeue_tail(&rq->rt, curr);
+}
+
+static bool __rt_check_preempt(runqueue_t *rq, task_t *curr, task_t *task) {
+    return (!rq->rt.throttled && task_rt_prio(task) > task_rt_prio(curr));
+}
+
+const sched_class_t rt_sched_class = {
+    .name = "rt",
+    .next = &fair_sched_class,
+    .enqueue = __rt_enqueue,
+    .dequeue = __rt_dequeue,
+    .pick_next = __rt_pick_next,
+    .steal = __rt_steal,
+    .put_prev = __rt_put_prev,
+    .set_next = __rt_set_next,
+    .task_tick = __rt_task_tick,
+    .task_woken = __rt_task_woken,
+    .task_sleep = __rt_task_sleep,
+    .yield_task = __rt_yield_task,
+    .check_preempt = __rt_check_preempt,
+};
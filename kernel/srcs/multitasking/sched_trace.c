@@ -0,0 +1,389 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   sched_trace.c                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:12:49 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:18:15 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/process.h>
+#include <multitasking/sched_trace.h>
+
+#include <system/clocksource.h>
+#include <system/cpu.h>
+#include <system/percpu.h>
+#include <system/serial.h>
+#include <system/spinlock.h>
+
+#include <asm/asm.h>
+#include <asm/div64.h>
+
+typedef struct s_sched_trace_cpu {
+    spinlock_t lock; // Owner CPU against report / dump
+    sched_trace_event_t events[SCHED_TRACE_EVENTS];
+    uint32_t head;  // Next slot
+    uint32_t count; // Events in the ring
+    uint32_t lost;  // Events overwritten
+
+    uint32_t latency_hist[SCHED_TRACE_HIST_BUCKETS];
+    uint64_t latency_total_ns;
+    uint64_t latency_max_ns;
+    uint32_t latency_count;
+} sched_trace_cpu_t;
+
+static sched_trace_cpu_t sched_trace_cpus[PERCPU_MAX_CPUS];
+
+volatile bool sched_trace_enabled = true;
+
+static const char *sched_trace_names[SCHED_TRACE_TYPE_COUNT] = {"switch", "wakeup", "fork", "exit"};
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   RING BUFFER                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Lock the ring of this CPU
+ * @note : Interrupts go off first: the task must not migrate between
+ *         reading its CPU and taking the ring.
+ */
+static sched_trace_cpu_t *__sched_trace_lock(cpu_t **cpu, uint32_t *eflags) {
+    sched_trace_cpu_t *tc;
+
+    GET_EFLAGS(*eflags);
+    ASM_CLI();
+    *cpu = this_cpu();
+    tc = &sched_trace_cpus[(*cpu)->id];
+    spinlock_acquire(&tc->lock);
+    return (tc);
+}
+
+static void __sched_trace_unlock(sched_trace_cpu_t *tc, uint32_t eflags) {
+    spinlock_release(&tc->lock);
+    SET_EFLAGS(eflags);
+}
+
+static void __sched_trace_event(sched_trace_cpu_t *tc, cpu_t *cpu, sched_trace_type_t type, int32_t pid, int32_t arg, uint64_t now) {
+    sched_trace_event_t *ev = &tc->events[tc->head];
+
+    ev->tsc = now;
+    ev->type = (uint8_t)type;
+    ev->cpu = (uint8_t)cpu->id;
+    ev->nr_running = (uint16_t)cpu->rq.nr_running;
+    ev->pid = pid;
+    ev->arg = arg;
+
+    tc->head = (tc->head + 1) % SCHED_TRACE_EVENTS;
+    if (tc->count < SCHED_TRACE_EVENTS)
+        tc->count++;
+    else
+        tc->lost++;
+}
+
+/**
+ * @brief Oldest event of a ring, the others follow modulo SCHED_TRACE_EVENTS
+ */
+static uint32_t __sched_trace_first(const sched_trace_cpu_t *tc) {
+    return ((tc->head + SCHED_TRACE_EVENTS - tc->count) % SCHED_TRACE_EVENTS);
+}
+
+static uint32_t __ns_to_us(uint64_t ns) {
+    uint64_t us = div_u64(ns, NSEC_PER_USEC);
+
+    return (us >> 32 ? 0xFFFFFFFF : (uint32_t)us);
+}
+
+static void __sched_trace_latency(sched_trace_cpu_t *tc, uint64_t ns) {
+    uint32_t us = __ns_to_us(ns);
+    uint32_t bucket = us ? 32 - __builtin_clz(us) : 0;
+
+    if (bucket >= SCHED_TRACE_HIST_BUCKETS)
+        bucket = SCHED_TRACE_HIST_BUCKETS - 1;
+    tc->latency_hist[bucket]++;
+    tc->latency_total_ns += ns;
+    tc->latency_count++;
+    if (ns > tc->latency_max_ns)
+        tc->latency_max_ns = ns;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   TRACEPOINTS                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief 'next' replaces 'prev' on this CPU (schedule)
+ * @note : Closes the wakeup latency of 'next'. TSCs are assumed in sync
+ *         between CPUs, as ktime_get() does.
+ */
+void sched_trace_switch(task_t *prev, task_t *next) {
+    sched_trace_cpu_t *tc;
+    uint32_t eflags;
+    uint64_t now;
+    cpu_t *cpu;
+
+    if (!sched_trace_enabled) {
+        next->sched_wakeup_tsc = 0;
+        return;
+    }
+
+    tc = __sched_trace_lock(&cpu, &eflags);
+    now = sched_clock();
+    __sched_trace_event(tc, cpu, SCHED_TRACE_SWITCH, next->pid, prev->pid, now);
+    if (next->sched_wakeup_tsc) {
+        uint64_t woken = next->sched_wakeup_tsc;
+
+        next->sched_wakeup_tsc = 0;
+        __sched_trace_latency(tc, now > woken ? sched_clock_to_ns(now - woken) : 0);
+    }
+    __sched_trace_unlock(tc, eflags);
+}
+
+/**
+ * @brief 'task' became runnable (wait queues, sleep expiry, admission)
+ * @note : Keeps the first stamp if the task is woken again before running.
+ */
+void sched_trace_wakeup(task_t *task) {
+    sched_trace_cpu_t *tc;
+    uint32_t eflags;
+    uint64_t now;
+    cpu_t *cpu;
+
+    if (!sched_trace_enabled)
+        return;
+
+    tc = __sched_trace_lock(&cpu, &eflags);
+    now = sched_clock();
+    if (!task->sched_wakeup_tsc)
+        task->sched_wakeup_tsc = now;
+    __sched_trace_event(tc, cpu, SCHED_TRACE_WAKEUP, task->pid, cpu->current ? cpu->current->pid : 0, now);
+    __sched_trace_unlock(tc, eflags);
+}
+
+/**
+ * @brief 'child' was forked: its first run is timed like a wakeup
+ */
+void sched_trace_fork(task_t *parent, task_t *child) {
+    sched_trace_cpu_t *tc;
+    uint32_t eflags;
+    uint64_t now;
+    cpu_t *cpu;
+
+    if (!sched_trace_enabled)
+        return;
+
+    tc = __sched_trace_lock(&cpu, &eflags);
+    now = sched_clock();
+    child->sched_wakeup_tsc = now;
+    __sched_trace_event(tc, cpu, SCHED_TRACE_FORK, child->pid, parent ? parent->pid : 0, now);
+    __sched_trace_unlock(tc, eflags);
+}
+
+void sched_trace_exit(task_t *task) {
+    sched_trace_cpu_t *tc;
+    uint32_t eflags;
+    cpu_t *cpu;
+
+    if (!sched_trace_enabled)
+        return;
+
+    tc = __sched_trace_lock(&cpu, &eflags);
+    __sched_trace_event(tc, cpu, SCHED_TRACE_EXIT, task->pid, task->exit_code, sched_clock());
+    __sched_trace_unlock(tc, eflags);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                     REPORT                                     ||
+// ! ||--------------------------------------------------------------------------------||
+
+typedef struct s_sched_trace_task_count {
+    int32_t pid;
+    uint32_t switches;
+} sched_trace_task_count_t;
+
+void sched_trace_reset(void) {
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        sched_trace_cpu_t *tc = &sched_trace_cpus[i];
+        uint32_t eflags = spinlock_acquire_irqsave(&tc->lock);
+
+        tc->head = tc->count = tc->lost = 0;
+        bzero((uint8_t *)tc->latency_hist, sizeof(tc->latency_hist));
+        tc->latency_total_ns = tc->latency_max_ns = 0;
+        tc->latency_count = 0;
+        spinlock_release_irqrestore(&tc->lock, eflags);
+    }
+}
+
+static void __sched_trace_report_latency(void) {
+    uint32_t hist[SCHED_TRACE_HIST_BUCKETS] = {0};
+    uint64_t total = 0, max = 0;
+    uint32_t count = 0, peak = 1;
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        sched_trace_cpu_t *tc = &sched_trace_cpus[i];
+        uint32_t eflags = spinlock_acquire_irqsave(&tc->lock);
+
+        for (uint32_t b = 0; b < SCHED_TRACE_HIST_BUCKETS; b++)
+            hist[b] += tc->latency_hist[b];
+        total += tc->latency_total_ns;
+        count += tc->latency_count;
+        if (tc->latency_max_ns > max)
+            max = tc->latency_max_ns;
+        spinlock_release_irqrestore(&tc->lock, eflags);
+    }
+
+    printk(_GREEN "Wakeup to run latency" _END ": " _YELLOW "%u" _END " samples, avg %u us, max %u us\n",
+           count, count ? __ns_to_us(div_u64(total, count)) : 0, __ns_to_us(max));
+    if (!count)
+        return;
+
+    for (uint32_t b = 0; b < SCHED_TRACE_HIST_BUCKETS; b++) {
+        if (hist[b] > peak)
+            peak = hist[b];
+    }
+    for (uint32_t b = 0; b < SCHED_TRACE_HIST_BUCKETS; b++) {
+        uint32_t width = (uint32_t)div_u64((uint64_t)hist[b] * 40, peak);
+
+        if (!hist[b])
+            continue;
+        if (b == SCHED_TRACE_HIST_BUCKETS - 1)
+            printk("\t>= %u us\t%u\t", 1U << (b - 1), hist[b]);
+        else
+            printk("\t<  %u us\t%u\t", 1U << b, hist[b]);
+        while (width--)
+            printk("#");
+        printk("\n");
+    }
+}
+
+/**
+ * @brief Run queue length of each CPU over the span of its ring
+ * @note : The ring span is cut in SCHED_TRACE_RQ_SLOTS slots, each shows
+ *         the average length seen by the switches in it.
+ */
+static void __sched_trace_report_runqueues(void) {
+    printk(_GREEN "Run queue length" _END " (average per slot, oldest first):\n");
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        sched_trace_cpu_t *tc = &sched_trace_cpus[i];
+        uint32_t sum[SCHED_TRACE_RQ_SLOTS] = {0}, samples[SCHED_TRACE_RQ_SLOTS] = {0};
+        uint32_t eflags = spinlock_acquire_irqsave(&tc->lock);
+        uint32_t first = __sched_trace_first(tc);
+        uint32_t span_us = 0;
+
+        if (tc->count) {
+            uint64_t start = tc->events[first].tsc;
+
+            span_us = __ns_to_us(sched_clock_to_ns(tc->events[(tc->head + SCHED_TRACE_EVENTS - 1) % SCHED_TRACE_EVENTS].tsc - start));
+            for (uint32_t n = 0; n < tc->count; n++) {
+                const sched_trace_event_t *ev = &tc->events[(first + n) % SCHED_TRACE_EVENTS];
+                uint32_t slot;
+
+                if (ev->type != SCHED_TRACE_SWITCH)
+                    continue;
+                slot = (uint32_t)div_u64((uint64_t)__ns_to_us(sched_clock_to_ns(ev->tsc - start)) * SCHED_TRACE_RQ_SLOTS, span_us + 1);
+                sum[slot] += ev->nr_running;
+                samples[slot]++;
+            }
+        }
+        spinlock_release_irqrestore(&tc->lock, eflags);
+
+        printk("\tCPU " _YELLOW "%u" _END " (%u ms/slot):", i, span_us / SCHED_TRACE_RQ_SLOTS / 1000);
+        for (uint32_t s = 0; s < SCHED_TRACE_RQ_SLOTS; s++) {
+            if (samples[s])
+                printk(" %u", sum[s] / samples[s]);
+            else
+                printk(" -");
+        }
+        printk("\n");
+    }
+}
+
+/**
+ * @brief Context switches per second of each task, over the traced span
+ */
+static void __sched_trace_report_switches(void) {
+    sched_trace_task_count_t tasks[SCHED_TRACE_TOP_TASKS];
+    uint64_t start = 0, end = 0;
+    uint32_t nr_tasks = 0, span_us;
+    bool any = false;
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        sched_trace_cpu_t *tc = &sched_trace_cpus[i];
+        uint32_t eflags = spinlock_acquire_irqsave(&tc->lock);
+        uint32_t first = __sched_trace_first(tc);
+
+        for (uint32_t n = 0; n < tc->count; n++) {
+            const sched_trace_event_t *ev = &tc->events[(first + n) % SCHED_TRACE_EVENTS];
+            uint32_t t;
+
+            if (!any || ev->tsc < start)
+                start = ev->tsc;
+            if (!any || ev->tsc > end)
+                end = ev->tsc;
+            any = true;
+
+            if (ev->type != SCHED_TRACE_SWITCH || ev->pid == 0)
+                continue;
+            for (t = 0; t < nr_tasks && tasks[t].pid != ev->pid; t++)
+                ;
+            if (t == nr_tasks) {
+                if (nr_tasks == SCHED_TRACE_TOP_TASKS)
+                    continue;
+                tasks[nr_tasks++] = (sched_trace_task_count_t){ev->pid, 0};
+            }
+            tasks[t].switches++;
+        }
+        spinlock_release_irqrestore(&tc->lock, eflags);
+    }
+
+    span_us = any ? __ns_to_us(sched_clock_to_ns(end - start)) : 0;
+    printk(_GREEN "Context switches" _END " over %u ms:\n", span_us / 1000);
+    if (!span_us)
+        return;
+    for (uint32_t t = 0; t < nr_tasks; t++) {
+        printk("\tTask " _GREEN "[%d]" _END ": %u switches, " _YELLOW "%u" _END "/s\n", tasks[t].pid, tasks[t].switches,
+               (uint32_t)div_u64((uint64_t)tasks[t].switches * 1000000, span_us));
+    }
+}
+
+void sched_trace_report(void) {
+    printk("Scheduler trace: " _GREEN "%s" _END "\n", sched_trace_enabled ? "on" : "off");
+    __sched_trace_report_latency();
+    __sched_trace_report_runqueues();
+    __sched_trace_report_switches();
+}
+
+/**
+ * @brief Write every buffered event to COM1, one per line, oldest first
+ * @note : Tracing is paused meanwhile, serial output is slow. Format:
+ *         cpu tsc_hi tsc_lo event pid arg nr_running
+ */
+void sched_trace_dump_serial(void) {
+    bool enabled = sched_trace_enabled;
+
+    sched_trace_enabled = false;
+    qemu_printf("# sched_trace cpus=%u tsc_khz=%u events=%u\n", cpu_count, clocksource_get_tsc_khz(), SCHED_TRACE_EVENTS);
+    qemu_printf("# cpu tsc_hi tsc_lo event pid arg nr_running\n");
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        sched_trace_cpu_t *tc = &sched_trace_cpus[i];
+        uint32_t eflags = spinlock_acquire_irqsave(&tc->lock); // Wait for a writer in progress
+        uint32_t first = __sched_trace_first(tc);
+        uint32_t count = tc->count;
+
+        spinlock_release_irqrestore(&tc->lock, eflags);
+        if (tc->lost)
+            qemu_printf("# cpu %u lost %u events\n", i, tc->lost);
+        for (uint32_t n = 0; n < count; n++) {
+            const sched_trace_event_t *ev = &tc->events[(first + n) % SCHED_TRACE_EVENTS];
+
+            qemu_printf("%u %x %x %s %d %d %u\n", ev->cpu, (uint32_t)(ev->tsc >> 32), (uint32_t)ev->tsc,
+                        sched_trace_names[ev->type], ev->pid, ev->arg, ev->nr_running);
+        }
+    }
+    qemu_printf("# end\n");
+    sched_trace_enabled = enabled;
+}
@@ -6,19 +6,32 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/12/07 22:33:43 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 11:48:46 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:35:03 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
+#include <multitasking/cpu_acct.h>
+#include <multitasking/sched_group.h>
+#include <multitasking/sched_trace.h>
 #include <multitasking/scheduler.h>
-
-#include <system/time.h>
+#include <multitasking/watchdog.h>
+
+#include <memory/kstack.h>
+
+#include <system/apic.h>
+#include <system/clocksource.h>
+#include <system/fpu.h>
+#include <system/irqsoff.h>
+#include <system/percpu.h>
+#include <system/preempt.h>
+#include <system/rcu.h>
+#include <system/smp.h>
 #include <system/tss.h>
 
-extern task_t *current_task;
-extern task_t *ready_queue;
+#include <asm/asm.h>
+#include <asm/div64.h>
 
-static task_t *prev_task = NULL;
+extern task_t *ready_queue;
 
 /* Import Waiting Queue from scheduler.h:
 ** Defined in 'process.c'
@@ -27,7 +40,10 @@ extern task_t *waiting_queue;
 
 bool scheduler_initialized = false;
 
+rspinlock_t tasklist_lock = RSPINLOCK_INIT;
+
 void init_scheduler(void) {
+    sched_group_init();
     scheduler_initialized = true;
 }
 
@@ -44,7 +60,7 @@ void wait_for_scheduler_rounded(void) {
     pid_t next_pid;
 
     do {
-        __asm__ volatile("int $0x20");
+        task_yield();
         next_pid = get_current_task()->pid;
     } while (next_pid != current_pid);
 
@@ -89,146 +105,607 @@ void wait_for_scheduler_rounded(void) {
     // } while (any_task_has_signal);
 }
 
-void switch_task(void) {
-    if (!scheduler_initialized)
-        return;
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 CONTEXT SWITCH                                 ||
+// ! ||--------------------------------------------------------------------------------||
 
-    outportb(0x20, 0x20); // Send EOI to PIC
+sched_stats_t sched_stats = {0, 0, 0};
+
+/**
+ * @brief Switch from prev to next
+ * @note : Kernel threads have no page directory of their own and borrow the
+ *         previous task's one (lazy TLB): kernel mappings are shared by every
+ *         directory, so CR3 (and the TLB) is only touched when the address
+ *         space really changes. The borrower holds a reference on it until
+ *         schedule_tail() switched it away, its owner may be reaped meanwhile.
+ * @note : prev stays on_cpu until schedule_tail() runs on the next stack:
+ *         until then its frame is not saved and no other CPU may take it.
+ */
+static void switch_to(cpu_t *cpu, task_t *prev, task_t *next) {
+    page_directory_t *directory = next->page_directory ? next->page_directory : prev->active_directory;
+    uint32_t cr3 = 0;
+
+    if (!next->page_directory)
+        page_directory_get(directory);
+    next->active_directory = directory;
+    if (directory != current_directory) {
+        current_directory = directory;
+        cr3 = directory->physicalAddr;
+        sched_stats.cr3_reloads++;
+    } else {
+        sched_stats.cr3_skipped++;
+    }
+    sched_stats.switches++;
+
+    /* Change kernel stack over */
+    tss_set_stack_pointer(next->kernel_stack + KERNEL_STACK_SIZE);
+
+    /* Lazy FPU: the next FPU instruction traps, nothing is saved here */
+    fpu_switch(prev, next);
+
+    next->cpu = cpu->id;
+    cpu->current = next;
+    cpu->switch_prev = prev;
+    __switch_to(&prev->esp, next->esp, cr3);
+
+    /* We are 'next' now (or whoever switched back to this stack) */
+    schedule_tail();
+}
+
+/**
+ * @brief Release the task switched out on this CPU
+ * @note : First thing run by a task resuming from __switch_to(), including
+ *         new tasks (fork child, idle tasks).
+ */
+void schedule_tail(void) {
+    cpu_t *cpu = this_cpu();
+    task_t *prev = cpu->switch_prev;
+    page_directory_t *borrowed;
+
+    if (prev) {
+        /* Read before on_cpu drops: another CPU may run prev right after */
+        borrowed = prev->page_directory ? NULL : prev->active_directory;
+        prev->on_cpu = false;
+        cpu->switch_prev = NULL;
+        /* CR3 holds next's directory now */
+        page_directory_put(borrowed);
+    }
+}
+
+/**
+ * @brief Hand a picked task back to its class without running it
+ */
+static void __put_picked_task(cpu_t *cpu, task_t *task) {
+    spinlock_acquire(&cpu->rq.lock);
+    if (task->on_rq && task->sched_class->put_prev)
+        task->sched_class->put_prev(&cpu->rq, task);
+    spinlock_release(&cpu->rq.lock);
+}
 
-    uint32_t esp, ebp, eip;
+static void __set_next_task(runqueue_t *rq, task_t *next) {
+    next->on_cpu = true;
+    if (next->on_rq && next->sched_class->set_next)
+        next->sched_class->set_next(rq, next);
+}
+
+/**
+ * @brief Pick the task to run next on this CPU
+ * @note : Local run queue first, class by class, then a task stolen from
+ *         the busiest one, then the idle task. The task returned is marked
+ *         on_cpu.
+ */
+static task_t *__pick_next_task(cpu_t *cpu, task_t *prev) {
+    runqueue_t *rq = &cpu->rq;
+    task_t *next = NULL;
+
+    spinlock_acquire(&rq->lock);
+    if (prev->on_rq && prev->sched_class->put_prev)
+        prev->sched_class->put_prev(rq, prev);
+    for_each_class(class) {
+        if ((next = class->pick_next(rq, prev)))
+            break;
+    }
+    rq->nr_running = rq->rt.nr_running + rq->cfs.h_nr_running;
+    if (next)
+        __set_next_task(rq, next);
+    spinlock_release(&rq->lock);
+
+    if (!next && (next = runqueue_steal(cpu))) {
+        spinlock_acquire(&rq->lock);
+        __set_next_task(rq, next);
+        spinlock_release(&rq->lock);
+    }
+    if (!next)
+        next = cpu->idle ? cpu->idle : prev;
+    next->on_cpu = true;
+    return (next);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    IDLE TASK                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Idle loop, halt until the next interrupt
+ * @note : sti only takes effect after the next instruction: an interrupt
+ *         cannot land between sti and hlt, and its resched point switches
+ *         to the task it woke. Idle time is the run time of this task (see
+ *         cpu_acct.c).
+ */
+void cpu_idle(void) {
+    for (;;) {
+        ASM_CLI();
+        if (this_cpu()->need_resched) {
+            schedule();
+            continue;
+        }
+        irqsoff_trace_on(IRQSOFF_EFLAGS_IF, (void *)cpu_idle);
+        __asm__ volatile("sti\n\thlt");
+    }
+}
+
+static void __cpu_idle_entry(void) {
+    schedule_tail();
+    cpu_idle();
+}
+
+/**
+ * @brief Create the idle task of a CPU
+ * @param adopt_context The idle task is the running context (AP boot stack),
+ *        else it gets its own stack and starts in cpu_idle() (BSP)
+ * @note : Idle tasks share pid 0, they are in no task list nor run queue and
+ *         only run when the run queues have nothing runnable.
+ */
+void sched_init_idle(cpu_t *cpu, bool adopt_context) {
+    task_t *idle;
+
+    if (!(idle = task_alloc()))
+        __PANIC("sched_init_idle : task_alloc failed");
+
+    idle->pid = idle->ppid = 0;
+    idle->state = TASK_RUNNING;
+    idle->or_priority = idle->priority = TASK_PRIORITY_LOW;
+    idle->page_directory = NULL;
+    idle->active_directory = cpu->directory;
+    idle->cpu = cpu->id;
+    /* Already running on it: hold what switch_to() would have taken */
+    if (adopt_context)
+        page_directory_get(idle->active_directory);
+    idle->cpu_load.stamp = sched_clock();
+
+    if (adopt_context) {
+        idle->kernel_stack = cpu->boot_stack;
+        idle->on_cpu = true;
+        cpu->current = idle;
+    } else {
+        if (!(idle->kernel_stack = kstack_alloc()))
+            __PANIC("sched_init_idle : kstack_alloc failed");
+        task_init_switch_frame(idle, &__cpu_idle_entry);
+    }
+    cpu->idle = idle;
+}
+
+/**
+ * @brief Pick the next task and switch to it
+ * @note : Must be called with interrupts disabled. Returns when 'prev' is
+ *         scheduled again (or immediately if nothing else can run).
+ * @note : Every call outside an RCU read section is a quiescent state.
+ * @note : Deferred (need_resched) while preemption is disabled: ticks and
+ *         wake ups landing in a spinlock or preempt_disable() section switch
+ *         at its end.
+ */
+void schedule(void) {
+    cpu_t *cpu = this_cpu();
+    task_t *prev = cpu->current;
+    task_t *next;
 
     /* If we haven't initialised tasking yet, just return */
-    if (!current_task)
+    if (!scheduler_initialized || !prev)
         return;
 
-    /* Read esp, ebp now for saving later on */
-    __asm__ __volatile__("mov %%esp, %0"
-                         : "=r"(esp));
-    __asm__ __volatile__("mov %%ebp, %0"
-                         : "=r"(ebp));
+    /* Never switch inside an RCU read section or a preemption disabled
+       section, rcu_read_unlock() / preempt_enable() will */
+    if (cpu->rcu_nesting || cpu->preempt_count) {
+        cpu->need_resched = true;
+        return;
+    }
+    rcu_note_context_switch(cpu);
+    watchdog_touch(cpu);
 
-    eip = read_eip();
+    /* Housekeeping walks the per-state task lists: done by the BSP only */
+    if (cpu->id == 0) {
+        uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
 
-    /* Have we just switched tasks? */
-    if (eip == 0x12345)
-        return;
+        /* Kill stopped tasks */
+        int32_t killed_task = __process_killer();
 
-    // if (d_page_directory) {
-    //     destroy_page_directory(d_page_directory);
-    //     d_page_directory = NULL;
-    // }
+        if (killed_task)
+            printk("Killed task [%d]\n", killed_task);
 
-    // printk("Current Task: %d\n", current_task->pid);
+        /* Reap zombies (never one still on a CPU, we may be on its stack) */
+        __process_zombie(prev);
 
-    // Just before we switch away from the current task, update its cpu_time
-    if (prev_task) {
-        // uint64_t sys_time = get_system_time();
+        /* Wake up sleeping tasks, and blocked ones whose timed wait expired */
+        __process_sleeping(prev);
+        wait_queue_expire();
 
-        // prev_task->cpu_load.load_time = sys_time - prev_task->cpu_load.start_time;
-        prev_task->cpu_load.load_time += timer_subtick;
-        prev_task->cpu_load.total_load_time += prev_task->cpu_load.load_time;
+        rspinlock_release_irqrestore(&tasklist_lock, eflags);
+    }
+
+    /* Get the next task to run: wake ups up to here are seen by the pick */
+    cpu->need_resched = false;
+    next = __pick_next_task(cpu, prev);
 
-        // if (prev_task->pid > 1) {
-        //     printk("Time: %lu | task start time %lu\n", sys_time, prev_task->cpu_load.start_time);
+    /* Check if the next task has received a signal */
+    __signal_handler(next);
 
-        //     printk("- START Task %d: %lu\n", prev_task->pid, prev_task->cpu_load.start_time);
-        //     printk("- LOAD Task %d: %lu\n", prev_task->pid, prev_task->cpu_load.load_time);
-        //     printk("- CPU  Task %d: %lu\n", prev_task->pid, get_cpu_load(prev_task));
-        //     printk("- TOTAL Task %d: %lu\n", prev_task->pid, prev_task->cpu_load.total_load_time);
-        // }
+    /* Do not execute Zombie or Stopped tasks */
+    if (next->state != TASK_RUNNING) {
+        __put_picked_task(cpu, next);
+        if (next != prev)
+            next->on_cpu = false;
+        next = cpu->idle ? cpu->idle : prev;
+        next->on_cpu = true;
     }
 
-    /* No, we didn't switch tasks. Let's save some register values and switch */
-    current_task->eip = eip;
-    current_task->esp = esp;
-    current_task->ebp = ebp;
+    /* Charge prev for its slice, next starts its own */
+    cpu_acct_switch(prev, next);
 
-    /* Get the next task to run */
-    if (prev_task && current_task == prev_task)
-        current_task = current_task->next;
-    if (!current_task)
-        current_task = ready_queue;
+    if (next != prev) {
+        sched_trace_switch(prev, next);
+        switch_to(cpu, prev, next);
+    }
+}
 
-    current_task = __process_selector(current_task);
+/**
+ * @brief Timer tick of this CPU: class bookkeeping of the running task
+ * @note : SCHED_RR slices and RT throttling are charged here, then the
+ *         tick reschedules as before.
+ */
+void scheduler_tick(void) {
+    cpu_t *cpu = this_cpu();
+    task_t *curr = cpu->current;
 
-    // TODO: Debug
-    // if (current_task && current_task->state == TASK_STOPPED) {
-    //     kill_task(current_task->pid);
-    // }
+    if (!scheduler_initialized || !curr)
+        return;
 
-    // printk("Task = %d | State = %d\n", current_task->pid, current_task->state);
+    spinlock_acquire(&cpu->rq.lock);
+    if (curr->on_rq && curr->sched_class->task_tick)
+        curr->sched_class->task_tick(&cpu->rq, curr);
+    spinlock_release(&cpu->rq.lock);
 
-    // printk("Switching to task %d\n", current_task->pid);
+    schedule();
+}
 
-    /* If we fell off the end of the linked list start again at the beginning */
-    if (!current_task)
-        current_task = ready_queue;
+/**
+ * @brief Give up the CPU voluntarily
+ */
+void task_yield(void) {
+    uint32_t eflags;
+    cpu_t *cpu;
+    task_t *curr;
+
+    GET_EFLAGS(eflags);
+    ASM_CLI();
+    cpu = this_cpu();
+    if (scheduler_initialized && (curr = cpu->current) && curr->on_rq && curr->sched_class->yield_task) {
+        spinlock_acquire(&cpu->rq.lock);
+        curr->sched_class->yield_task(&cpu->rq, curr);
+        spinlock_release(&cpu->rq.lock);
+    }
+    schedule();
+    SET_EFLAGS(eflags);
+}
 
-    // printk("Switching to task %d\n", current_task->pid);
+/**
+ * @brief Timer entry point of the scheduler
+ * @note : The EOI is sent here: we may not return to the IRQ stub before
+ *         another task runs.
+ */
+void switch_task(void) {
+    if (!scheduler_initialized)
+        return;
 
-    /* Save the context of our current task */
-    prev_task = current_task;
+    outportb(0x20, 0x20); // Send EOI to PIC
 
-    // Just after we've switched to the new task, update its start_time
-    current_task->cpu_load.start_time = get_system_time();
-    prev_task->cpu_load.load_time = 0;
+    scheduler_tick();
+}
 
-    eip = current_task->eip;
-    esp = current_task->esp;
-    ebp = current_task->ebp;
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                               WAKEUP PREEMPTION                                ||
+// ! ||--------------------------------------------------------------------------------||
 
-    /* Make sure the memory manager knows we've changed page directory */
-    current_directory = current_task->page_directory;
+static bool __sched_class_above(const sched_class_t *a, const sched_class_t *b) {
+    for_each_class(class) {
+        if (class == b)
+            return (false);
+        if (class == a)
+            return (true);
+    }
+    return (false);
+}
 
-    /* Change kernel stack over */
-    tss_set_stack_pointer(current_task->kernel_stack + KERNEL_STACK_SIZE);
+/**
+ * @brief Should 'task', just woken, take the CPU from the task running there
+ * @note : Caller holds the run queue lock of 'cpu'.
+ */
+static bool __sched_check_preempt(cpu_t *cpu, task_t *task) {
+    task_t *curr = cpu->current;
+    const sched_class_t *class = task_sched_class(task);
+
+    if (!curr || curr == task || !cpu->online)
+        return (false);
+    if (curr == cpu->idle)
+        return (true);
+    if (class != task_sched_class(curr))
+        return (__sched_class_above(class, task_sched_class(curr)));
+    return (class->check_preempt && class->check_preempt(&cpu->rq, curr, task));
+}
 
-    // check if tasks < MAX_TASKS then, add task to ready_queue
-    __process_waiting();
+/**
+ * @brief Ask a CPU to schedule() as soon as possible
+ * @note : Other CPUs get a reschedule IPI, this CPU switches at its next
+ *         preemption point (end of IRQ, end of syscall, rcu_read_unlock()).
+ */
+void resched_cpu(cpu_t *cpu) {
+    cpu->need_resched = true;
+    if (smp_enabled && cpu != this_cpu())
+        lapic_send_resched(cpu->apic_id);
+}
 
-    // Todo: ...
-    /* Check if the current task has overflowed its stack */
-    __task_overflow_handler();
+/**
+ * @brief A task became RUNNING (see task_set_state())
+ * @note : Lets its class requeue it, then preempts the task running on its
+ *         CPU if the woken task must run first (RT over fair, higher RT
+ *         priority, anything over the idle task).
+ */
+void sched_wakeup(task_t *task) {
+    uint32_t eflags;
+    bool preempt;
+    cpu_t *cpu;
 
-    /* Kill stopped tasks */
-    int32_t killed_task = __process_killer();
+    if (!scheduler_initialized)
+        return;
 
-    // We just killed current task
-    if (killed_task) {
-        printk("Killed task [%d]\n", killed_task);
+    cpu = task_rq_lock(task, &eflags);
+    /* Hooks run outside tasklist_lock: trust the state, not the caller */
+    if (task->state != TASK_RUNNING) {
+        task_rq_unlock(cpu, eflags);
         return;
     }
+    if (task->on_rq && task->sched_class->task_woken)
+        task->sched_class->task_woken(&cpu->rq, task);
+    preempt = __sched_check_preempt(cpu, task);
+    task_rq_unlock(cpu, eflags);
 
-    /* Check if the current task is a zombie */
-    __process_zombie(current_task);
+    if (preempt)
+        resched_cpu(cpu);
+}
 
-    /* Check if the current task has received a signal */
-    __signal_handler(current_task);
+/**
+ * @brief A task left RUNNING (see task_set_state())
+ */
+void sched_sleep(task_t *task) {
+    uint32_t eflags;
+    cpu_t *cpu;
 
-    /* Check if the current task is sleeping */
-    __process_sleeping(current_task);
+    if (!scheduler_initialized)
+        return;
 
-    /* Revive Zombies / Orphans tasks and attach them to the INIT task (Like UNIX System) */
-    __orphans_collector(current_task);
+    cpu = task_rq_lock(task, &eflags);
+    if (task->state != TASK_RUNNING && task->on_rq && task->sched_class->task_sleep)
+        task->sched_class->task_sleep(&cpu->rq, task);
+    task_rq_unlock(cpu, eflags);
+}
 
-    /* Check if the current task has threads, then switch to the runnable thread */
-    __process_threads(current_task);
+/**
+ * @brief Switch now if a reschedule is pending on this CPU
+ * @note : End of interrupts and syscalls: interrupts are disabled, the
+ *         interrupted code is preempted unless it disabled preemption.
+ */
+void sched_resched_point(void) {
+    uint32_t eflags;
 
-    /* Do not execute Zombie or Stopped tasks */
-    if (current_task && (current_task->state == TASK_ZOMBIE || current_task->state == TASK_STOPPED))
+    if (!scheduler_initialized || !this_cpu()->need_resched || !preemptible())
+        return;
+
+    GET_EFLAGS(eflags);
+    ASM_CLI();
+    schedule();
+    SET_EFLAGS(eflags);
+}
+
+/**
+ * @brief Run the switch deferred by a preemption disabled section
+ * @note : preempt_enable(), rcu_read_unlock(). Left to the end of the
+ *         interrupt if interrupts are disabled (the section ended inside a
+ *         handler or an irqsave one).
+ */
+void preempt_schedule(void) {
+    uint32_t eflags;
+
+    if (!scheduler_initialized || !preemptible())
+        return;
+
+    GET_EFLAGS(eflags);
+    if (!(eflags & PREEMPT_EFLAGS_IF))
+        return;
+    ASM_CLI();
+    schedule();
+    SET_EFLAGS(eflags);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                SCHEDULING POLICY                               ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Take a task out of its class queue before a change of class, RT
+ *        level, weight or group (run queue locked)
+ * @return Whether it was homed, to give back to __sched_change_end()
+ * @note : The running task is charged to its old class first.
+ */
+static bool __sched_change_begin(cpu_t *cpu, task_t *task) {
+    bool queued = task->on_rq;
+
+    if (queued) {
+        if (cpu->current == task && task->sched_class->put_prev)
+            task->sched_class->put_prev(&cpu->rq, task);
+        runqueue_unlink_locked(cpu, task);
+    }
+    return (queued);
+}
+
+static void __sched_change_end(cpu_t *cpu, task_t *task, bool queued) {
+    if (queued) {
+        runqueue_link_locked(cpu, task);
+        if (cpu->current == task && task->sched_class->set_next)
+            task->sched_class->set_next(&cpu->rq, task);
+    }
+}
+
+/**
+ * @brief Change the policy (and RT priority) of a task, 0 for the current one
+ * @note : SCHED_NORMAL takes rt_priority 0, SCHED_FIFO / SCHED_RR take
+ *         1 .. SCHED_RT_PRIO_MAX. RT tasks also get TASK_PRIORITY_REALTIME,
+ *         which PI mutexes lend to the owners they wait on. The fair
+ *         priority is saved meanwhile and given back with SCHED_NORMAL.
+ */
+int32_t sched_setscheduler(pid_t pid, sched_policy_t policy, uint32_t rt_priority) {
+    uint32_t eflags;
+    bool queued;
+    task_t *task;
+    cpu_t *cpu;
+
+    if (policy > SCHED_RR || (policy == SCHED_NORMAL) != (rt_priority == 0) || rt_priority > SCHED_RT_PRIO_MAX)
+        return (-1);
+
+    rcu_read_lock();
+    if (!(task = pid ? get_task(pid) : get_current_task()) || task == this_cpu()->idle) {
+        rcu_read_unlock();
+        return (-1);
+    }
+
+    cpu = task_rq_lock(task, &eflags);
+    queued = __sched_change_begin(cpu, task);
+
+    if (policy != SCHED_NORMAL && task->policy == SCHED_NORMAL)
+        task->fair_priority = task->or_priority;
+    if (policy != SCHED_NORMAL)
+        task->or_priority = TASK_PRIORITY_REALTIME;
+    else if (task->policy != SCHED_NORMAL)
+        task->or_priority = task->fair_priority;
+    task->priority = task_base_priority(task);
+    task->policy = policy;
+    task->rt_priority = rt_priority;
+    task->rt_slice_ns = 0;
+
+    __sched_change_end(cpu, task, queued);
+    task_rq_unlock(cpu, eflags);
+
+    resched_cpu(cpu);
+    rcu_read_unlock();
+    return (0);
+}
+
+/**
+ * @brief Set what a task inherits through PI mutexes (see pi_mutex.c)
+ * @param pi_boost Fair priority of its highest waiter
+ * @param pi_rt_priority RT priority of its highest waiter, 0 if none is RT
+ * @note : An RT boost moves the task to the RT class at that level, a fair
+ *         task held by an RT waiter would else be starved by any RT task.
+ */
+void sched_set_pi_boost(task_t *task, task_priority_t pi_boost, uint32_t pi_rt_priority) {
+    uint32_t eflags;
+    bool queued;
+    cpu_t *cpu;
+
+    cpu = task_rq_lock(task, &eflags);
+    if (task->pi_boost == pi_boost && task->pi_rt_priority == pi_rt_priority) {
+        task_rq_unlock(cpu, eflags);
         return;
+    }
+    queued = __sched_change_begin(cpu, task);
+
+    task->pi_boost = pi_boost;
+    task->pi_rt_priority = pi_rt_priority;
+    task->priority = task_base_priority(task);
 
-    /* Switch to the new task's kernel stack */
-    /* 0x12345: just a magic number */
-    __asm__ __volatile__("		\
-    cli;			\
-	mov %0, %%ecx;		\
-	mov %1, %%esp;		\
-	mov %2, %%ebp;		\
-	mov %3, %%cr3;		\
-	mov $0x12345, %%eax;	\
-	sti;			\
-	jmp *%%ecx		"
-                         :
-                         : "r"(eip), "r"(esp), "r"(ebp), "r"(current_directory->physicalAddr));
+    __sched_change_end(cpu, task, queued);
+    task_rq_unlock(cpu, eflags);
+
+    if (queued)
+        resched_cpu(cpu);
+}
+
+/**
+ * @brief Move a task to another fair-share group
+ * @note : Same requeue as sched_setscheduler(): the task leaves the queues
+ *         of its old group before task->sched_group changes.
+ */
+void sched_move_task(task_t *task, task_group_t *tg) {
+    uint32_t eflags;
+    bool queued;
+    cpu_t *cpu;
+
+    cpu = task_rq_lock(task, &eflags);
+    if (task->sched_group == tg) {
+        task_rq_unlock(cpu, eflags);
+        return;
+    }
+    queued = __sched_change_begin(cpu, task);
+
+    task->sched_group = tg;
+
+    __sched_change_end(cpu, task, queued);
+    task_rq_unlock(cpu, eflags);
+
+    if (queued)
+        resched_cpu(cpu);
+}
+
+/**
+ * @brief Policy of a task, 0 for the current one, -1 if there is none
+ */
+int32_t sched_getscheduler(pid_t pid) {
+    int32_t policy = -1;
+    task_t *task;
+
+    rcu_read_lock();
+    if ((task = pid ? get_task(pid) : get_current_task()))
+        policy = (int32_t)task->policy;
+    rcu_read_unlock();
+    return (policy);
+}
+
+/**
+ * @brief Scheduler tunables, per-CPU class state and RT tasks
+ */
+void sched_print_stats(void) {
+    printk("CFS latency: " _GREEN "%u us" _END ", min granularity: " _GREEN "%u us" _END ", wakeup granularity: " _GREEN "%u us" _END "\n",
+           sched_latency_ns / 1000, sched_min_granularity_ns / 1000, sched_wakeup_granularity_ns / 1000);
+    printk("RR timeslice: " _GREEN "%u ms" _END ", RT runtime: " _GREEN "%u" _END " / " _GREEN "%u us" _END "%s\n",
+           sched_rr_timeslice_ms, sched_rt_runtime_us, sched_rt_period_us,
+           sched_rt_runtime_us >= sched_rt_period_us ? " (no throttling)" : "");
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        runqueue_t *rq = &cpus[i].rq;
+
+        if (!cpus[i].online)
+            continue;
+        printk("CPU " _GREEN "[%u]" _END ": fair %u running (load %u, min_vruntime %u ms), RT %u running, %s, throttled " _YELLOW "%u" _END " times\n",
+               i, rq->cfs.h_nr_running, rq->cfs.load, (uint32_t)div_u64(rq->cfs.min_vruntime, NSEC_PER_MSEC),
+               rq->rt.nr_running, rq->rt.throttled ? "throttled" : "not throttled", rq->rt.throttles);
+    }
+
+    rcu_read_lock();
+    for (task_t *task = rcu_dereference(ready_queue); task; task = rcu_dereference(task->next)) {
+        static const char *policies[] = {"SCHED_NORMAL (PI boosted)", "SCHED_FIFO", "SCHED_RR"};
+
+        if (!task_rt_prio(task))
+            continue;
+        printk("Task " _GREEN "[%d]" _END ": %s, priority " _YELLOW "%u" _END "%s, CPU %u\n", task->pid, policies[task->policy],
+               task_rt_prio(task), task->pi_rt_priority > task->rt_priority ? " (inherited)" : "", task->cpu);
+    }
+    rcu_read_unlock();
 }
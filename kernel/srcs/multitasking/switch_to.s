@@ -0,0 +1,90 @@
+; Context switch primitives
+;
+; Every switched-out task keeps the same frame on top of its stack:
+;
+;   [esp + 0x00] eflags
+;   [esp + 0x04] edi
+;   [esp + 0x08] esi
+;   [esp + 0x0C] ebx
+;   [esp + 0x10] ebp
+;   [esp + 0x14] return address
+;
+; Only callee-saved registers are stored: the C caller already spilled the
+; others. Anything building a stack for a new task (fork, kernel threads)
+; must lay out this exact frame.
+
+section .text
+
+; void __switch_to(uint32_t *prev_esp, uint32_t next_esp, uint32_t next_cr3)
+;
+; next_cr3 == 0 keeps the current address space (no TLB flush).
+; CR3 is reloaded only once the previous frame is saved and before the new
+; stack is loaded: processes share the same stack virtual range in
+; different directories, so no stack access may happen in between.
+global __switch_to
+__switch_to:
+	mov eax, [esp + 4]						; &prev->esp
+	mov edx, [esp + 8]						; next->esp
+	mov ecx, [esp + 12]						; next directory (physical) or 0
+
+	push ebp
+	push ebx
+	push esi
+	push edi
+	pushfd
+
+	mov [eax], esp							; Save previous stack
+
+	test ecx, ecx
+	jz .same_address_space
+	mov cr3, ecx
+.same_address_space:
+	mov esp, edx							; Load next stack
+
+	popfd
+	pop edi
+	pop esi
+	pop ebx
+	pop ebp
+	ret
+
+; int32_t __task_fork_context(uint32_t *child_esp, void (*commit)(void *), void *arg)
+;
+; Push a switch frame resuming at '.child', store its address in *child_esp
+; and call commit(arg) while the frame is still live, so the address space
+; clone done by commit() captures it. Returns 0 in the parent, 1 when the
+; child is switched to for the first time.
+global __task_fork_context
+__task_fork_context:
+	push ebp
+	mov ebp, esp
+	push ebx
+	push esi
+	push edi
+
+	push dword .child						; Child switch frame
+	push ebp
+	push ebx
+	push esi
+	push edi
+	pushfd
+
+	mov eax, [ebp + 8]
+	mov [eax], esp							; *child_esp = frame
+
+	push dword [ebp + 16]
+	call dword [ebp + 12]						; commit(arg)
+
+	lea esp, [ebp - 12]						; Drop arg + child frame
+	xor eax, eax
+	jmp .out
+
+.child:
+	mov eax, 1
+
+.out:
+	pop edi
+	pop esi
+	pop ebx
+	pop ebp
+	ret
@@ -0,0 +1,254 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   task_table.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:50:11 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:26:14 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <memory/slab.h>
+
+#include <multitasking/process.h>
+#include <multitasking/sched_trace.h>
+#include <multitasking/scheduler.h>
+
+/*
+** Task table
+**
+** - task_t come from a slab cache
+** - tasks are indexed by pid (see pid.c)
+** - every admitted task is linked in the list of its state, so the
+**   scheduler housekeeping only visits the tasks it has work for
+** - admission is bounded by task_max, tunable at runtime: tasks over the
+**   bound wait on the waiting queue and are admitted when a task is freed
+**   or the bound is raised, never by polling
+**
+** Lists and counters are protected by tasklist_lock.
+*/
+
+static kmem_cache_t task_cache;
+static bool task_cache_ready = false;
+
+static task_t *task_states[TASK_STATE_COUNT];
+static uint32_t task_states_count[TASK_STATE_COUNT];
+
+static uint32_t task_max = TASK_MAX_DEFAULT;
+static uint32_t task_admitted = 0; // Tasks on the ready list, kernel and INIT excluded
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  TASK STRUCTS                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Allocate a zeroed task_t
+ */
+task_t *task_alloc(void) {
+    task_t *task;
+
+    if (!task_cache_ready) {
+        kmem_cache_init(&task_cache, "task_t", sizeof(task_t));
+        task_cache_ready = true;
+    }
+    if (!(task = (task_t *)kmem_cache_alloc(&task_cache)))
+        return (NULL);
+    memset(task, 0, sizeof(task_t));
+    task->cpus_allowed = ~0U;
+    return (task);
+}
+
+void task_free_struct(task_t *task) {
+    kmem_cache_free(&task_cache, task);
+}
+
+static void __task_free_rcu(rcu_head_t *head) {
+    kmem_cache_free(&task_cache, rcu_entry(head, task_t, rcu));
+}
+
+/**
+ * @brief Free a task_t once no lockless reader (get_task, ready list) can
+ *        still be looking at it
+ */
+void task_free_struct_rcu(task_t *task) {
+    call_rcu(&task->rcu, &__task_free_rcu);
+}
+
+kmem_cache_t *task_get_cache(void) {
+    return (&task_cache);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   STATE LISTS                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+static void __task_state_link(task_t *task) {
+    task->list_state = task->state;
+    task->state_prev = NULL;
+    task->state_next = task_states[task->state];
+    if (task->state_next)
+        task->state_next->state_prev = task;
+    task_states[task->state] = task;
+    task_states_count[task->state]++;
+}
+
+static void __task_state_unlink(task_t *task) {
+    if (task->state_prev)
+        task->state_prev->state_next = task->state_next;
+    else
+        task_states[task->list_state] = task->state_next;
+    if (task->state_next)
+        task->state_next->state_prev = task->state_prev;
+    task->state_next = task->state_prev = NULL;
+    task_states_count[task->list_state]--;
+}
+
+/**
+ * @brief Change the state of a task
+ * @return false if the change was refused (dead task)
+ * @note : Every state change of an admitted task must go through here, it
+ *         moves the task to the list of its new state.
+ *         A dead task (zombie or stopped) is never revived, it only goes
+ *         from zombie to stopped when waitpid() claims it.
+ */
+bool task_set_state(task_t *task, task_state_t state) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    bool dead = task->state == TASK_ZOMBIE || task->state == TASK_STOPPED;
+    bool woken = state == TASK_RUNNING && task->state != TASK_RUNNING;
+    bool slept = state != TASK_RUNNING && task->state == TASK_RUNNING;
+
+    if (dead && state != TASK_STOPPED && state != task->state) {
+        rspinlock_release_irqrestore(&tasklist_lock, eflags);
+        return (false);
+    }
+
+    /* Every wake up goes through here: wait queues, sleep expiry, admission */
+    if (woken)
+        sched_trace_wakeup(task);
+    task->state = state;
+    if (task->in_task_table && task->list_state != state) {
+        __task_state_unlink(task);
+        __task_state_link(task);
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+
+    if (woken)
+        sched_wakeup(task);
+    else if (slept)
+        sched_sleep(task);
+    return (true);
+}
+
+/**
+ * @brief First task in a given state (caller holds tasklist_lock)
+ * @note : Follow task->state_next, save it before changing the task state.
+ */
+task_t *task_state_first(task_state_t state) {
+    return (task_states[state]);
+}
+
+uint32_t task_state_count(task_state_t state) {
+    return (task_states_count[state]);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    ADMISSION                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Make a new task visible to the scheduler
+ * @note : Used by init_tasking, fork and kernel threads. Over task_max, the
+ *         task waits on the waiting queue until task_admit_waiting().
+ */
+void task_admit(task_t *task) {
+    uint32_t eflags;
+
+    pid_hash_add(task);
+
+    eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    if (task->pid > INIT_PID && task_admitted >= task_max)
+        task->state = TASK_WAITING;
+    task->in_task_table = true;
+    __task_state_link(task);
+
+    if (task->state == TASK_WAITING) {
+        __waiting_queue_add_task(task);
+    } else {
+        __ready_queue_add_task(task);
+        if (task->pid > INIT_PID)
+            task_admitted++;
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+}
+
+/**
+ * @brief Admit waiting tasks while under the bound
+ * @note : Called when a task leaves the ready list or task_max changes.
+ */
+void task_admit_waiting(void) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+
+    while (waiting_queue && task_admitted < task_max) {
+        task_t *task = waiting_queue;
+
+        __waiting_queue_remove_task(task);
+        task_set_state(task, TASK_RUNNING);
+        __ready_queue_add_task(task);
+        task_admitted++;
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+}
+
+/**
+ * @brief Remove a task from the table (free_task)
+ */
+void task_table_remove(task_t *task) {
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+
+    if (task->in_task_table) {
+        /* Still waiting for admission: it never reached the ready list */
+        bool admitted = task->list_state != TASK_WAITING;
+
+        __task_state_unlink(task);
+        task->in_task_table = false;
+        if (admitted) {
+            __ready_queue_remove_task(task);
+            if (task->pid > INIT_PID)
+                task_admitted--;
+        } else {
+            __waiting_queue_remove_task(task);
+        }
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+}
+
+uint32_t task_get_max(void) {
+    return (task_max);
+}
+
+/**
+ * @brief Change the admission bound
+ * @note : Lowering it does not evict running tasks, new ones wait.
+ */
+void task_set_max(uint32_t max) {
+    if (!max)
+        return;
+    task_max = max;
+    task_admit_waiting();
+}
+
+/**
+ * @brief Number of tasks on the ready list (admitted)
+ */
+uint32_t get_task_count(void) {
+    return (task_admitted);
+}
+
+/**
+ * @brief Number of tasks waiting for admission
+ */
+uint32_t get_waiting_task_count(void) {
+    return (task_states_count[TASK_WAITING]);
+}
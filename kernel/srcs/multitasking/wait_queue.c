@@ -0,0 +1,305 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   wait_queue.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:53:58 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:23:18 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/process.h>
+#include <multitasking/scheduler.h>
+#include <multitasking/wait_queue.h>
+
+#include <system/percpu.h>
+#include <system/pit.h>
+
+/*
+** Lock order: tasklist_lock, then wq->lock. Wakers unlink the tasks under
+** wq->lock and only change their state once it is released.
+*/
+
+/* Tasks in a timed wait: the housekeeping has nothing to scan while 0 */
+static volatile uint32_t wq_timed_waiters = 0;
+
+void wait_queue_init(wait_queue_t *wq) {
+    *wq = (wait_queue_t)WAIT_QUEUE_INIT;
+}
+
+static void __wait_queue_link(wait_queue_t *wq, task_t *task) {
+    task->wq = wq;
+    task->wq_next = NULL;
+    task->wq_prev = wq->tail;
+    if (wq->tail)
+        wq->tail->wq_next = task;
+    else
+        wq->head = task;
+    wq->tail = task;
+    wq->nr_waiters++;
+}
+
+static void __wait_queue_unlink(wait_queue_t *wq, task_t *task) {
+    if (task->wq_prev)
+        task->wq_prev->wq_next = task->wq_next;
+    else
+        wq->head = task->wq_next;
+    if (task->wq_next)
+        task->wq_next->wq_prev = task->wq_prev;
+    else
+        wq->tail = task->wq_prev;
+    task->wq = NULL;
+    task->wq_next = task->wq_prev = NULL;
+    wq->nr_waiters--;
+}
+
+/**
+ * @brief Queue the current task and mark it TASK_BLOCKED
+ * @return eflags to give back to wait_queue_finish()
+ * @note : Interrupts stay disabled until wait_queue_finish(): the task must
+ *         not be preempted once blocked, before it is reachable by a waker.
+ *         Before tasking, nothing is queued and wait_event() spins.
+ */
+uint32_t wait_queue_prepare(wait_queue_t *wq, bool idle) {
+    task_t *task = get_current_task();
+    uint32_t eflags;
+
+    GET_EFLAGS(eflags);
+    ASM_CLI();
+    if (!scheduler_initialized || !task || task == this_cpu()->idle)
+        return (eflags);
+
+    task->wq_since = (uint32_t)timer_get_jiffies();
+    task->wq_idle = idle;
+    /* A dead task is not queued: wait_queue_sleep() switches it away for good */
+    if (!task_set_state(task, TASK_BLOCKED))
+        return (eflags);
+    spinlock_acquire(&wq->lock);
+    __wait_queue_link(wq, task);
+    spinlock_release(&wq->lock);
+    return (eflags);
+}
+
+/**
+ * @brief Give up the CPU until woken (interrupts disabled by wait_queue_prepare)
+ */
+void wait_queue_sleep(void) {
+    schedule();
+}
+
+/**
+ * @brief Leave the wait queue after wait_event() woke up (or did not sleep)
+ */
+void wait_queue_finish(wait_queue_t *wq, uint32_t eflags) {
+    task_t *task = get_current_task();
+
+    if (task && task->wq == wq) {
+        spinlock_acquire(&wq->lock);
+        if (task->wq == wq)
+            __wait_queue_unlink(wq, task);
+        spinlock_release(&wq->lock);
+    }
+    if (task && task->state == TASK_BLOCKED)
+        task_set_state(task, TASK_RUNNING);
+    SET_EFLAGS(eflags);
+}
+
+/**
+ * @brief Drop a task from the queue and the timed wait it is in (free_task)
+ */
+void wait_queue_remove_task(task_t *task) {
+    wait_queue_t *wq = task->wq;
+    uint32_t eflags;
+
+    if (task->wq_deadline) {
+        __atomic_sub_fetch(&wq_timed_waiters, 1, __ATOMIC_SEQ_CST);
+        task->wq_deadline = 0;
+    }
+    if (!wq)
+        return;
+    eflags = spinlock_acquire_irqsave(&wq->lock);
+    if (task->wq == wq)
+        __wait_queue_unlink(wq, task);
+    spinlock_release_irqrestore(&wq->lock, eflags);
+}
+
+/**
+ * @brief Make the unlinked tasks of a wake up runnable again
+ * @note : Only TASK_BLOCKED tasks are woken, a task killed meanwhile keeps
+ *         its state.
+ */
+static uint32_t __wake_up_list(task_t *list) {
+    uint32_t woken = 0;
+    uint32_t eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+
+    while (list) {
+        task_t *next = list->wq_next;
+
+        list->wq_next = NULL;
+        if (list->state == TASK_BLOCKED) {
+            task_set_state(list, TASK_RUNNING);
+            woken++;
+        }
+        list = next;
+    }
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+    return (woken);
+}
+
+/**
+ * @brief Wake one given task if it sleeps on the queue
+ * @return 1 if the task was taken off the queue
+ * @note : For wakers that track their waiters themselves (futex). A task not
+ *         queued yet must find its wake up condition true on its own.
+ */
+uint32_t wake_up_task(wait_queue_t *wq, task_t *task) {
+    uint32_t eflags = spinlock_acquire_irqsave(&wq->lock);
+    bool queued = task->wq == wq;
+
+    if (queued)
+        __wait_queue_unlink(wq, task);
+    spinlock_release_irqrestore(&wq->lock, eflags);
+    return (queued ? __wake_up_list(task) : 0);
+}
+
+/**
+ * @brief Wake the oldest task of the queue
+ * @return Number of tasks woken (0 or 1)
+ */
+uint32_t wake_up_one(wait_queue_t *wq) {
+    uint32_t eflags = spinlock_acquire_irqsave(&wq->lock);
+    task_t *task = wq->head;
+
+    if (task)
+        __wait_queue_unlink(wq, task);
+    spinlock_release_irqrestore(&wq->lock, eflags);
+    return (task ? __wake_up_list(task) : 0);
+}
+
+/**
+ * @brief Wake every task of the queue
+ * @return Number of tasks woken
+ */
+uint32_t wake_up_all(wait_queue_t *wq) {
+    uint32_t eflags = spinlock_acquire_irqsave(&wq->lock);
+    task_t *list = wq->head;
+
+    /* The whole FIFO becomes the local list, chained by wq_next */
+    for (task_t *task = list; task; task = task->wq_next) {
+        task->wq = NULL;
+        task->wq_prev = NULL;
+    }
+    wq->head = wq->tail = NULL;
+    wq->nr_waiters = 0;
+    spinlock_release_irqrestore(&wq->lock, eflags);
+    return (list ? __wake_up_list(list) : 0);
+}
+
+/**
+ * @brief Wake the highest priority task of the queue (oldest among equals)
+ * @return Number of tasks woken (0 or 1)
+ */
+uint32_t wake_up_highest(wait_queue_t *wq) {
+    uint32_t eflags = spinlock_acquire_irqsave(&wq->lock);
+    task_t *best = wq->head;
+
+    for (task_t *task = wq->head; task; task = task->wq_next) {
+        uint32_t rt = task_rt_prio(task), best_rt = task_rt_prio(best);
+
+        if (rt > best_rt || (rt == best_rt && task->priority > best->priority))
+            best = task;
+    }
+    if (best)
+        __wait_queue_unlink(wq, best);
+    spinlock_release_irqrestore(&wq->lock, eflags);
+    return (best ? __wake_up_list(best) : 0);
+}
+
+/**
+ * @brief Highest priority among the queued tasks
+ * @return -1 if the queue is empty
+ */
+int32_t wait_queue_max_priority(wait_queue_t *wq) {
+    uint32_t eflags = spinlock_acquire_irqsave(&wq->lock);
+    int32_t max = -1;
+
+    for (task_t *task = wq->head; task; task = task->wq_next) {
+        if ((int32_t)task->priority > max)
+            max = (int32_t)task->priority;
+    }
+    spinlock_release_irqrestore(&wq->lock, eflags);
+    return (max);
+}
+
+/**
+ * @brief Highest RT priority among the queued tasks
+ * @return 0 if the queue is empty or holds fair tasks only
+ */
+uint32_t wait_queue_max_rt_priority(wait_queue_t *wq) {
+    uint32_t eflags = spinlock_acquire_irqsave(&wq->lock);
+    uint32_t max = 0;
+
+    for (task_t *task = wq->head; task; task = task->wq_next) {
+        if (task_rt_prio(task) > max)
+            max = task_rt_prio(task);
+    }
+    spinlock_release_irqrestore(&wq->lock, eflags);
+    return (max);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  TIMED WAITS                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Deadline of a timed wait of 'ms' milliseconds from now
+ * @return timer_subtick value to give to wait_event_idle_deadline()
+ */
+uint32_t wait_queue_deadline(uint32_t ms) {
+    uint32_t ticks = (uint32_t)(((uint64_t)ms * TIMER_PHASE) / 1000);
+    uint32_t deadline = timer_subtick + (ticks ? ticks : 1);
+
+    /* 0 means no deadline */
+    return (deadline ? deadline : 1);
+}
+
+/**
+ * @brief Arm (or clear, deadline 0) the timed wait of the current task
+ */
+void wait_queue_set_deadline(uint32_t deadline) {
+    task_t *task = get_current_task();
+
+    if (!task || !deadline == !task->wq_deadline)
+        return;
+    if (deadline)
+        __atomic_add_fetch(&wq_timed_waiters, 1, __ATOMIC_SEQ_CST);
+    else
+        __atomic_sub_fetch(&wq_timed_waiters, 1, __ATOMIC_SEQ_CST);
+    task->wq_deadline = deadline;
+}
+
+bool wait_queue_expired(uint32_t deadline) {
+    return (deadline && (int32_t)(timer_subtick - deadline) >= 0);
+}
+
+/**
+ * @brief Wake the blocked tasks whose deadline passed
+ * @note : tasklist_lock held (scheduler housekeeping, BSP only). The woken
+ *         task sees its deadline expired and leaves its wait_event().
+ */
+void wait_queue_expire(void) {
+    task_t *task, *next;
+
+    if (!wq_timed_waiters)
+        return;
+    for (task = task_state_first(TASK_BLOCKED); task; task = next) {
+        wait_queue_t *wq = task->wq;
+
+        /* Save the link first, waking the task moves it to another list */
+        next = task->state_next;
+        if (wq && wait_queue_expired(task->wq_deadline))
+            wake_up_task(wq, task);
+    }
+}
@@ -0,0 +1,177 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   watchdog.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:56:08 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:57:44 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/process.h>
+#include <multitasking/scheduler.h>
+#include <multitasking/watchdog.h>
+
+#include <memory/kstack.h>
+
+#include <system/isr.h>
+#include <system/panic.h>
+#include <system/sections.h>
+#include <system/serial.h>
+
+#define WATCHDOG_SOFTLOCKUP_TICKS (WATCHDOG_SOFTLOCKUP_SECS * TIMER_PHASE)
+#define WATCHDOG_HUNG_TASK_TICKS (WATCHDOG_HUNG_TASK_SECS * TIMER_PHASE)
+#define WATCHDOG_HUNG_CHECK_TICKS (WATCHDOG_HUNG_CHECK_SECS * TIMER_PHASE)
+
+volatile bool watchdog_enabled = true;
+
+static uint32_t watchdog_hung_check = 0; // Jiffies of the last hung task scan (BSP only)
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                     REPORTS                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+static bool __watchdog_is_text(uint32_t addr) {
+    return (addr >= (uint32_t)&__kernel_text_section_start && addr < (uint32_t)&__kernel_text_section_end);
+}
+
+/**
+ * @brief Print the kernel text addresses found from 'sp' to the stack top
+ * @note : 'stack' is the base of the task kernel stack (kstack_alloc()). The
+ *         boot stack (BSP idle task) has no known bounds: only the page of
+ *         'sp' is scanned.
+ */
+static void __watchdog_stack_scan(uint32_t sp, uint32_t stack) {
+    uint32_t top, found = 0;
+
+    sp &= ~3U;
+    if (stack && sp >= stack && sp < stack + KSTACK_SIZE)
+        top = stack + KSTACK_SIZE;
+    else
+        top = (sp & ~(PAGE_SIZE - 1)) + PAGE_SIZE;
+
+    qemu_printf("  Stack scan from 0x%x:\n", sp);
+    for (uint32_t *word = (uint32_t *)sp; (uint32_t)word < top && found < WATCHDOG_STACK_ENTRIES; word++) {
+        if (__watchdog_is_text(*word)) {
+            qemu_printf("    ? 0x%x\n", *word);
+            found++;
+        }
+    }
+    if (!found)
+        qemu_printf("    (no kernel text address)\n");
+}
+
+static void __watchdog_panic(const char *reason) {
+#if __WATCHDOG_PANIC__ == true
+    __PANIC(reason);
+#else
+    __UNUSED(reason);
+#endif
+}
+
+/**
+ * @brief This CPU did not schedule for 'stuck' ticks, 'r' is what it was running
+ */
+static void __watchdog_soft_lockup(cpu_t *cpu, struct regs *r, uint32_t stuck) {
+    task_t *task = cpu->current;
+    bool user = (r->cs & 3) != 0;
+
+    qemu_printf("watchdog: soft lockup - CPU %u stuck for %u s, task [%d]\n", cpu->id, stuck / TIMER_PHASE, task ? task->pid : -1);
+    qemu_printf("  EIP: 0x%x (%s mode), preempt_count %u, rcu_nesting %u\n", r->eip, user ? "user" : "kernel",
+                cpu->preempt_count, cpu->rcu_nesting);
+    /* Same privilege: the interrupted stack goes on right after the frame */
+    if (!user)
+        __watchdog_stack_scan((uint32_t)&r->useresp, task ? task->kernel_stack : 0);
+    __watchdog_panic("watchdog: soft lockup");
+}
+
+/**
+ * @brief The timer of 'cpu' stopped (interrupts left disabled), seen by the BSP
+ */
+static void __watchdog_silent_cpu(cpu_t *cpu, uint32_t silent) {
+    task_t *task = cpu->current;
+
+    qemu_printf("watchdog: CPU %u has not ticked for %u s (interrupts disabled?), task [%d]\n", cpu->id,
+                silent / TIMER_PHASE, task ? task->pid : -1);
+    __watchdog_panic("watchdog: CPU not ticking");
+}
+
+/**
+ * @brief 'task' is blocked since 'blocked' ticks (switched out, stack stable)
+ */
+static void __watchdog_hung_task(task_t *task, uint32_t blocked) {
+    uint32_t *frame = (uint32_t *)task->esp;
+
+    qemu_printf("watchdog: task [%d] blocked for more than %u s\n", task->pid, blocked / TIMER_PHASE);
+    qemu_printf("  Wait queue 0x%x, PI mutex 0x%x, CPU %u\n", task->wq, task->pi_blocked_on, task->cpu);
+    qemu_printf("  EIP: 0x%x (switch frame)\n", frame[5]);
+    __watchdog_stack_scan(task->esp, task->kernel_stack);
+    __watchdog_panic("watchdog: hung task");
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                     CHECKS                                     ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Blocked tasks that crossed WATCHDOG_HUNG_TASK_SECS since the last scan
+ * @note : Reported once per wait: the crossing falls in exactly one scan
+ *         window. Skipped when the tick interrupted the tasklist_lock holder.
+ */
+static void __watchdog_hung_tasks(uint32_t now) {
+    uint32_t window = now - watchdog_hung_check;
+    uint32_t eflags;
+
+    if (window < WATCHDOG_HUNG_CHECK_TICKS || rspinlock_held(&tasklist_lock))
+        return;
+
+    eflags = rspinlock_acquire_irqsave(&tasklist_lock);
+    for (task_t *task = task_state_first(TASK_BLOCKED); task; task = task->state_next) {
+        uint32_t hung_at = task->wq_since + WATCHDOG_HUNG_TASK_TICKS;
+
+        if (task->wq_idle || task->on_cpu)
+            continue;
+        if (hung_at - watchdog_hung_check - 1 < window)
+            __watchdog_hung_task(task, now - task->wq_since);
+    }
+    watchdog_hung_check = now;
+    rspinlock_release_irqrestore(&tasklist_lock, eflags);
+}
+
+/**
+ * @brief Timer interrupt hook, on every CPU
+ * @note : The BSP also checks that the other CPUs still tick and scans the
+ *         blocked tasks.
+ */
+void watchdog_tick(struct regs *r) {
+    cpu_t *cpu = this_cpu();
+    uint32_t now = (uint32_t)timer_get_jiffies();
+
+    cpu->watchdog_tick = now;
+    if (!watchdog_enabled || !scheduler_initialized)
+        return;
+
+    if (!cpu->watchdog_touch)
+        cpu->watchdog_touch = now;
+    else if (!cpu->watchdog_reported && now - cpu->watchdog_touch > WATCHDOG_SOFTLOCKUP_TICKS) {
+        cpu->watchdog_reported = true;
+        __watchdog_soft_lockup(cpu, r, now - cpu->watchdog_touch);
+    }
+
+    if (cpu->id != 0)
+        return;
+
+    for (uint32_t i = 1; i < cpu_count; i++) {
+        cpu_t *other = &cpus[i];
+
+        if (!other->online || !other->watchdog_tick || other->watchdog_reported)
+            continue;
+        if (now - other->watchdog_tick > WATCHDOG_SOFTLOCKUP_TICKS) {
+            other->watchdog_reported = true;
+            __watchdog_silent_cpu(other, now - other->watchdog_tick);
+        }
+    }
+    __watchdog_hung_tasks(now);
+}
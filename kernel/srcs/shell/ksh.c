@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 14:40:02 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/20 12:43:54 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:38:37 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -67,9 +67,8 @@ void kronos_shell(void) {
     DISPLAY_PROMPT();
     UPDATE_CURSOR();
 
-
-    while (1)
-        ;
+    /* Commands run from the keyboard interrupt, the shell task only waits */
+    task_park();
 }
 
 #undef __PROMPT__
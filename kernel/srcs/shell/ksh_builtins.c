@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/09/05 01:12:55 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/20 14:21:28 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:52:53 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -17,7 +17,13 @@
 #include <system/sections.h>
 #include <system/cpu.h>
 
+#include <cmds/chrt.h>
+#include <cmds/fairshare.h>
+#include <cmds/irqsoff.h>
+#include <cmds/lockstat.h>
 #include <cmds/ps.h>
+#include <cmds/schedtrace.h>
+#include <cmds/top.h>
 
 #include <drivers/keyboard.h>
 
@@ -41,6 +47,12 @@ static void __ksh_help(void)
     printk("- " _GREEN "setxkbmap" _END ": set keyboard layout\n");
     printk("- " _GREEN "cpuinfos" _END ": display cpu infos\n");
     printk("- " _GREEN "ps" _END ": display process infos\n");
+    printk("- " _GREEN "lockstat" _END ": display PI mutex hold / wait times\n");
+    printk("- " _GREEN "schedtrace" _END ": scheduler latency tracer (on, off, reset, dump)\n");
+    printk("- " _GREEN "irqsoff" _END ": interrupts-off latency tracer (on, off, reset, dump)\n");
+    printk("- " _GREEN "chrt" _END ": scheduling policies and tunables (chrt pid fifo|rr|normal [prio])\n");
+    printk("- " _GREEN "top" _END ": per-task CPU usage and load average (top [count])\n");
+    printk("- " _GREEN "fairshare" _END ": fair-share groups by uid / gid (fairshare [id shares | mode uid|gid])\n");
 }
 
 static void __add_builtin(char *names[__BUILTINS_MAX_NAMES], void *fn)
@@ -73,6 +85,12 @@ void __ksh_init_builtins(void)
     __add_builtin((char *[__BUILTINS_MAX_NAMES]){"setxkbmap", ""}, &setxkbmap);
     __add_builtin((char *[__BUILTINS_MAX_NAMES]){"cpuinfos", ""}, &get_cpu_informations);
     __add_builtin((char *[__BUILTINS_MAX_NAMES]){"ps", ""}, &ps);
+    __add_builtin((char *[__BUILTINS_MAX_NAMES]){"lockstat", ""}, &lockstat);
+    __add_builtin((char *[__BUILTINS_MAX_NAMES]){"schedtrace", ""}, &schedtrace);
+    __add_builtin((char *[__BUILTINS_MAX_NAMES]){"irqsoff", ""}, &irqsoff);
+    __add_builtin((char *[__BUILTINS_MAX_NAMES]){"top", ""}, &top);
+    __add_builtin((char *[__BUILTINS_MAX_NAMES]){"chrt", ""}, &chrt);
+    __add_builtin((char *[__BUILTINS_MAX_NAMES]){"fairshare", ""}, &fairshare);
 }
 
 void __ksh_execute_builtins(const ksh_args_t *arg)
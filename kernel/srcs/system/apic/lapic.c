@@ -0,0 +1,182 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   lapic.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:35:16 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:57:44 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <system/apic.h>
+#include <system/clocksource.h>
+#include <system/cpu.h>
+#include <system/idt.h>
+#include <system/irqsoff.h>
+#include <system/percpu.h>
+
+#include <multitasking/scheduler.h>
+#include <multitasking/watchdog.h>
+
+uint32_t lapic_base = LAPIC_DEFAULT_BASE;
+
+static uint32_t __lapic_timer_ticks = 0; // Timer ticks per LAPIC_CALIBRATE_US (divide by 16)
+
+static inline uint32_t __lapic_read(uint32_t reg) {
+    return (*(volatile uint32_t *)(lapic_base + reg));
+}
+
+static inline void __lapic_write(uint32_t reg, uint32_t value) {
+    *(volatile uint32_t *)(lapic_base + reg) = value;
+}
+
+/**
+ * @brief Send an IPI and wait for the LAPIC to accept it
+ */
+static void __lapic_send_ipi(uint8_t apic_id, uint32_t command) {
+    __lapic_write(LAPIC_ESR, 0x0);
+    __lapic_write(LAPIC_ICR_HIGH, (uint32_t)apic_id << LAPIC_ICR_DEST_SHIFT);
+    __lapic_write(LAPIC_ICR_LOW, command);
+    while (__lapic_read(LAPIC_ICR_LOW) & LAPIC_ICR_PENDING)
+        __asm__ volatile("pause");
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                               INTERFACE FUNCTIONS                              ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Check for a local APIC and read its physical base
+ * @note : Runs before paging, the base is reserved as MMIO by the caller.
+ */
+bool lapic_detect(void) {
+    uint32_t eax, ebx, ecx, edx;
+
+    if (!__cpuid_available)
+        return (false);
+
+    __cpuid(0x00000001, eax, ebx, ecx, edx);
+    __UNUSED(eax);
+    __UNUSED(ebx);
+    __UNUSED(ecx);
+    if (!(edx & CPUID_FEAT_EDX_APIC) || !(edx & CPUID_FEAT_EDX_MSR))
+        return (false);
+
+    lapic_base = (uint32_t)rdmsr(IA32_APIC_BASE_MSR) & 0xFFFFF000;
+    return (true);
+}
+
+/**
+ * @brief Install the LAPIC vectors in the (shared) IDT
+ */
+void lapic_install(void) {
+    idt_set_gate(LAPIC_TIMER_VECTOR, (uint32_t)lapic_timer_irq, IDT_SELECTOR, IDT_FLAG_GATE);
+    idt_set_gate(LAPIC_RESCHED_VECTOR, (uint32_t)lapic_resched_irq, IDT_SELECTOR, IDT_FLAG_GATE);
+    idt_set_gate(LAPIC_SPURIOUS_VECTOR, (uint32_t)lapic_spurious_irq, IDT_SELECTOR, IDT_FLAG_GATE);
+}
+
+/**
+ * @brief Enable the LAPIC of the current CPU
+ * @note : LINT0 / LINT1 are left as the firmware set them: the PIC keeps
+ *         delivering the legacy IRQs to the BSP only.
+ */
+void lapic_init(void) {
+    wrmsr(IA32_APIC_BASE_MSR, rdmsr(IA32_APIC_BASE_MSR) | IA32_APIC_BASE_ENABLE);
+
+    __lapic_write(LAPIC_SVR, LAPIC_SPURIOUS_VECTOR | LAPIC_SVR_ENABLE);
+    __lapic_write(LAPIC_TPR, 0x0);
+    __lapic_write(LAPIC_LVT_TIMER, LAPIC_LVT_MASKED);
+    __lapic_write(LAPIC_LVT_ERROR, LAPIC_LVT_MASKED);
+
+    /* ESR must be written twice to clear it (back-to-back writes) */
+    __lapic_write(LAPIC_ESR, 0x0);
+    __lapic_write(LAPIC_ESR, 0x0);
+    lapic_eoi();
+}
+
+uint8_t lapic_id(void) {
+    return ((uint8_t)(__lapic_read(LAPIC_ID) >> 24));
+}
+
+void lapic_eoi(void) {
+    __lapic_write(LAPIC_EOI, 0x0);
+}
+
+void lapic_send_init(uint8_t apic_id) {
+    __lapic_send_ipi(apic_id, LAPIC_ICR_INIT | LAPIC_ICR_LEVEL_ASSERT | LAPIC_ICR_LEVEL_TRIGGER);
+    clocksource_udelay(200);
+    /* INIT de-assert, needed by older (discrete) APICs */
+    __lapic_send_ipi(apic_id, LAPIC_ICR_INIT | LAPIC_ICR_LEVEL_TRIGGER);
+}
+
+/**
+ * @brief Send a STARTUP IPI, the AP starts in real mode at 'trampoline'
+ * @note : 'trampoline' must be page aligned and below 1MB.
+ */
+void lapic_send_startup(uint8_t apic_id, uint32_t trampoline) {
+    __lapic_send_ipi(apic_id, LAPIC_ICR_STARTUP | ((trampoline >> 12) & 0xFF));
+}
+
+/**
+ * @brief Ask another CPU to reschedule (see resched_cpu())
+ */
+void lapic_send_resched(uint8_t apic_id) {
+    __lapic_send_ipi(apic_id, LAPIC_RESCHED_VECTOR | LAPIC_ICR_LEVEL_ASSERT);
+}
+
+/**
+ * @brief Measure the LAPIC timer rate against the clocksource
+ * @note : Done once on the BSP, every LAPIC runs from the same bus clock.
+ */
+void lapic_timer_calibrate(void) {
+    __lapic_write(LAPIC_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_16);
+    __lapic_write(LAPIC_LVT_TIMER, LAPIC_LVT_MASKED);
+    __lapic_write(LAPIC_TIMER_INIT, 0xFFFFFFFF);
+
+    clocksource_udelay(LAPIC_CALIBRATE_US);
+
+    __lapic_timer_ticks = 0xFFFFFFFF - __lapic_read(LAPIC_TIMER_CURRENT);
+    __lapic_write(LAPIC_TIMER_INIT, 0x0);
+}
+
+/**
+ * @brief Periodic LAPIC timer on the current CPU, used as scheduler tick by the APs
+ */
+void lapic_timer_start(uint32_t hz) {
+    uint32_t count = (__lapic_timer_ticks * (1000000 / LAPIC_CALIBRATE_US)) / (hz ? hz : 1);
+
+    __lapic_write(LAPIC_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_16);
+    __lapic_write(LAPIC_LVT_TIMER, LAPIC_TIMER_VECTOR | LAPIC_TIMER_PERIODIC);
+    __lapic_write(LAPIC_TIMER_INIT, count ? count : 1);
+}
+
+/**
+ * @brief LAPIC timer interrupt
+ * @note : EOI first, schedule() may not return to the stub before another
+ *         task runs on this CPU (same as switch_task()).
+ */
+void lapic_timer_handler(struct regs *r) {
+    irqsoff_irq_enter(r->eflags);
+    this_cpu()->ticks++;
+    lapic_eoi();
+
+    watchdog_tick(r);
+    if (scheduler_initialized)
+        scheduler_tick();
+    irqsoff_trace_on(r->eflags, (void *)r->eip);
+}
+
+/**
+ * @brief Reschedule IPI, sent by resched_cpu()
+ * @note : need_resched is already set, schedule() clears it.
+ */
+void lapic_resched_handler(struct regs *r) {
+    irqsoff_irq_enter(r->eflags);
+    lapic_eoi();
+
+    if (scheduler_initialized)
+        schedule();
+    irqsoff_trace_on(r->eflags, (void *)r->eip);
+}
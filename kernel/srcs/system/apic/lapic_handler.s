@@ -0,0 +1,56 @@
+bits 32
+
+section .text
+
+extern lapic_timer_handler
+extern lapic_resched_handler
+
+; LAPIC interrupt stub: same frame as the IRQ stubs (struct regs)
+%macro LAPIC_IRQ 3
+global %1
+%1:
+	cli
+	push byte 0
+	push byte %2
+
+	; save registers
+	pusha
+	push ds
+	push es
+	push fs
+	push gs
+
+	; kernel data segments, per-CPU data segment in fs
+	mov ax, 0x10
+	mov ds, ax
+	mov es, ax
+	mov gs, ax
+	mov ax, 0x48
+	mov fs, ax
+
+	mov eax, esp
+	push eax
+	mov eax, %3
+	call eax
+
+	; restore registers
+	pop eax
+	pop gs
+	pop fs
+	pop es
+	pop ds
+	popa
+	add esp, 8
+	iret
+%endmacro
+
+; LAPIC timer, scheduler tick of the APs (vector 0x30, see apic.h)
+LAPIC_IRQ lapic_timer_irq, 0x30, lapic_timer_handler
+
+; Reschedule IPI (vector 0x31, see resched_cpu())
+LAPIC_IRQ lapic_resched_irq, 0x31, lapic_resched_handler
+
+; Spurious interrupts must not be acknowledged
+global lapic_spurious_irq
+lapic_spurious_irq:
+	iret
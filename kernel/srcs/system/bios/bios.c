@@ -6,12 +6,13 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/11/18 19:57:17 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/05/29 15:56:43 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:40:41 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <system/bios.h>
 #include <system/gdt.h>
+#include <system/percpu.h>
 
 #include <system/panic.h>
 
@@ -43,6 +44,7 @@ static void __bios32_service(uint8_t interrupt, regs16_t *in, regs16_t *out)
     memcpy(out, in_reg16_address, sizeof(regs16_t));
 
     gdt_flush((uint32_t)(&gp));
+    percpu_load_segment();
     idt_load(&idtp);
 }
 
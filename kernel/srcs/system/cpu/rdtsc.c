@@ -6,38 +6,22 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/05/27 19:54:56 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/06/01 22:54:10 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:21:49 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
+#include <system/clocksource.h>
 #include <system/cpu.h>
-#include <system/pit.h>
-
-#include <asm/asm.h>
 
 /*
 ** RDTSC - Read Time Stamp Counter
 ** Goal: Get the number of cycles since the last reset
+**
+** rdtsc() itself lives in 'cpu.h' as a static inline so every caller
+** gets a single instruction instead of a function call.
 */
 
-/* Pour lire le TSC */
-inline uint64_t rdtsc() {
-    uint64_t a, d;
-    __asm__ volatile("rdtsc"
-                     : "=a"(a), "=d"(d));
-    return ((uint128_t)d << 32) | a;
-}
-
 /* Pour obtenir la fréquence du CPU en MHz */
-double get_cpu_frequency() {
-    uint64_t start, end;
-    kernel_log_info("CPU", "Calculating CPU Frequency...");
-
-    ASM_STI();
-    start = rdtsc();
-    ksleep(1);
-    end = rdtsc();
-    ASM_CLI();
-
-    return (end - start) / 1e6; /* Pour convertir en MHz */
-}
\ No newline at end of file
+uint32_t get_cpu_frequency(void) {
+    return (clocksource_get_tsc_khz() / 1000);
+}
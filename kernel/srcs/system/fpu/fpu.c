@@ -6,25 +6,202 @@
 /*   By: vvaucoul <vvaucoul@student.42.Fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/09/04 16:53:20 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/02/11 20:23:16 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:40:41 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
+#include <system/cpu.h>
 #include <system/fpu.h>
+#include <system/isr.h>
+#include <system/percpu.h>
+
+#include <memory/kheap.h>
+#include <multitasking/process.h>
+
 #include <kernel.h>
 
+/*
+** The owner of the FPU registers and the CR0.TS cache are per CPU
+** (cpu_t.fpu_owner / cpu_t.fpu_ts_set): a task state lives in the registers
+** of one CPU only, see runqueue_steal().
+*/
+static bool __fpu_fxsr = false;        // FXSAVE/FXRSTOR available (SSE state included)
+
 static void fpu_set_control_word(const uint16_t __control_word)
 {
     __asm__ volatile("fldcw %0" :: "m"((__control_word)));
 }
 
-void enable_fpu(void)
+static inline void __fpu_clts(void)
+{
+    __asm__ volatile("clts");
+    this_cpu()->fpu_ts_set = false;
+}
+
+static inline void __fpu_stts(void)
+{
+    cpu_t *cpu = this_cpu();
+    uint32_t cr0;
+
+    if (cpu->fpu_ts_set)
+        return;
+    __asm__ volatile("mov %%cr0, %0" : "=r"(cr0));
+    __asm__ volatile("mov %0, %%cr0" :: "r"(cr0 | CR0_TS));
+    cpu->fpu_ts_set = true;
+}
+
+static inline void __fpu_save(uint8_t *area)
+{
+    if (__fpu_fxsr)
+        __asm__ volatile("fxsave (%0)" :: "r"(area) : "memory");
+    else
+        __asm__ volatile("fnsave (%0); fwait" :: "r"(area) : "memory");
+}
+
+static inline void __fpu_restore(uint8_t *area)
+{
+    if (__fpu_fxsr)
+        __asm__ volatile("fxrstor (%0)" :: "r"(area) : "memory");
+    else
+        __asm__ volatile("frstor (%0)" :: "r"(area) : "memory");
+}
+
+/**
+ * @brief Load the boot-time FPU configuration in the registers
+ */
+static void __fpu_init_state(void)
 {
-    uint32_t cr4;
-    __asm__ volatile("mov %%cr4, %0" :"=r"(cr4));
-    cr4 |= 0X200;
-    __asm__ volatile("mov %0, %%cr4" :: "r"((cr4)));
+    uint32_t mxcsr = __MXCSR_INIT;
+
+    __asm__ volatile("fninit");
     fpu_set_control_word(__FPU_INIT);
     fpu_set_control_word(__FPU_INVALID_OPERAND);
     fpu_set_control_word(__FPU_DIVIDE_BY_ZERO);
-}
\ No newline at end of file
+    if (__fpu_fxsr)
+        __asm__ volatile("ldmxcsr %0" :: "m"(mxcsr));
+}
+
+/**
+ * @brief Allocate a task FPU area (aligned for FXSAVE)
+ */
+static bool __fpu_alloc_state(task_t *task)
+{
+    uint32_t raw = (uint32_t)kmalloc(FPU_STATE_SIZE + FPU_STATE_ALIGN);
+
+    if (!raw)
+        return (false);
+    task->fpu_state_alloc = (void *)raw;
+    task->fpu_state = (uint8_t *)((raw + FPU_STATE_ALIGN - 1) & ~(FPU_STATE_ALIGN - 1));
+    memset(task->fpu_state, 0, FPU_STATE_SIZE);
+    return (true);
+}
+
+/**
+ * @brief #NM handler: give the FPU to the current task
+ */
+static void __fpu_device_not_available(struct regs *r)
+{
+    cpu_t *cpu = this_cpu();
+    task_t *task = cpu->current;
+    task_t *owner = cpu->fpu_owner;
+
+    __UNUSED(r);
+    __fpu_clts();
+
+    if (!task || owner == task)
+        return;
+
+    if (owner)
+        __fpu_save(owner->fpu_state);
+
+    if (!task->fpu_state) {
+        if (!__fpu_alloc_state(task))
+            __PANIC("FPU : failed to allocate task FPU state");
+        __fpu_init_state();
+    } else {
+        __fpu_restore(task->fpu_state);
+    }
+    cpu->fpu_owner = task;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                               INTERFACE FUNCTIONS                              ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Configure the FPU of the current CPU (BSP from enable_fpu(), APs from ap_main())
+ */
+void fpu_init_cpu(void)
+{
+    uint32_t cr0, cr4;
+    uint32_t eax, ebx, ecx, edx;
+
+    __cpuid(0x00000001, eax, ebx, ecx, edx);
+    __UNUSED(eax);
+    __UNUSED(ebx);
+    __UNUSED(ecx);
+    __fpu_fxsr = (edx & CPUID_FEAT_EDX_FXSR) != 0;
+
+    __asm__ volatile("mov %%cr0, %0" : "=r"(cr0));
+    cr0 &= ~(CR0_EM | CR0_TS);
+    cr0 |= CR0_MP | CR0_NE;
+    __asm__ volatile("mov %0, %%cr0" :: "r"(cr0));
+
+    if (__fpu_fxsr) {
+        __asm__ volatile("mov %%cr4, %0" :"=r"(cr4));
+        cr4 |= CR4_OSFXSR;
+        if (edx & CPUID_FEAT_EDX_SSE)
+            cr4 |= CR4_OSXMMEXCPT;
+        __asm__ volatile("mov %0, %%cr4" :: "r"((cr4)));
+    }
+    __fpu_init_state();
+}
+
+void enable_fpu(void)
+{
+    fpu_init_cpu();
+    isr_register_interrupt_handler(FPU_NM_INTERRUPT, __fpu_device_not_available);
+}
+
+/**
+ * @brief Called on every context switch
+ * @note : Only arms CR0.TS, the state stays in the registers until another
+ *         task actually uses the FPU.
+ */
+void fpu_switch(task_t *prev, task_t *next)
+{
+    __UNUSED(prev);
+    __UNUSED(next);
+    __fpu_stts();
+}
+
+/**
+ * @brief Give the child a copy of the parent FPU state (if any)
+ */
+void fpu_fork(task_t *parent, task_t *child)
+{
+    child->fpu_state = child->fpu_state_alloc = NULL;
+    if (!parent->fpu_state)
+        return;
+
+    if (this_cpu()->fpu_owner == parent) {
+        __fpu_clts();
+        __fpu_save(parent->fpu_state);
+        /* fnsave reinitialises the FPU, reload the saved state */
+        if (!__fpu_fxsr)
+            __fpu_restore(parent->fpu_state);
+    }
+    if (__fpu_alloc_state(child))
+        memcpy(child->fpu_state, parent->fpu_state, FPU_STATE_SIZE);
+}
+
+void fpu_release(task_t *task)
+{
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        if (cpus[i].fpu_owner == task)
+            cpus[i].fpu_owner = NULL;
+    }
+    if (task->fpu_state_alloc)
+        kfree(task->fpu_state_alloc);
+    task->fpu_state = task->fpu_state_alloc = NULL;
+}
@@ -6,32 +6,40 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 18:52:32 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 12:03:50 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:40:41 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <system/gdt.h>
+#include <system/percpu.h>
 #include <system/pit.h>
 #include <system/tss.h>
 
 GDTEntry *gdt = (GDTEntry *)__GDT_ADDR;
 GDTPtr gp;
 
+/**
+ * @brief Fill an entry of any GDT (the APs have their own, see percpu.c)
+ */
+void gdt_set_entry(GDTEntry *table, uint8_t index, uint32_t base, uint32_t limit, uint8_t access, uint8_t granularity) {
+    (&table[index])->base_low = (base & 0xFFFF);
+    (&table[index])->base_middle = (base >> 16) & 0xFF;
+    (&table[index])->base_high = (base >> 24) & 0xFF;
+    (&table[index])->limit_low = (limit & 0xFFFF);
+    (&table[index])->granularity = (limit >> 16) & 0x0F;
+    (&table[index])->granularity |= granularity & 0xF0;
+    (&table[index])->access = access;
+}
+
 void gdt_add_entry(uint8_t index, uint32_t base, uint32_t limit, uint8_t access, uint8_t granularity) {
-    (&gdt[index])->base_low = (base & 0xFFFF);
-    (&gdt[index])->base_middle = (base >> 16) & 0xFF;
-    (&gdt[index])->base_high = (base >> 24) & 0xFF;
-    (&gdt[index])->limit_low = (limit & 0xFFFF);
-    (&gdt[index])->granularity = (limit >> 16) & 0x0F;
-    (&gdt[index])->granularity |= granularity & 0xF0;
-    (&gdt[index])->access = access;
+    gdt_set_entry(gdt, index, base, limit, access, granularity);
 }
 
 void gdt_install(void) {
 
     /* Setup the GDT pointer and limit */
     // gp.limit = (sizeof(&gdt[0]) * (__GDT_SIZE + TSS_SIZE)) - 1;
-    gp.limit = (sizeof(GDTEntry) * (__GDT_SIZE + TSS_SIZE)) - 1;
+    gp.limit = (sizeof(GDTEntry) * PERCPU_GDT_ENTRIES) - 1;
     gp.base = __GDT_ADDR;
 
     /* NULL descriptor */
@@ -52,6 +60,9 @@ void gdt_install(void) {
 
     /* Flush the GDT */
     gdt_flush((uint32_t)(&gp));
+
+    /* Per-CPU data segment of the BSP, loaded in %fs */
+    percpu_init_bsp();
 }
 
 /*
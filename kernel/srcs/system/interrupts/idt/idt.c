@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.Fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 19:09:44 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/02/12 12:38:33 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:47:01 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -26,6 +26,17 @@ void idt_set_gate(unsigned char num, unsigned long base, unsigned short selector
     idt[num].flags = flags | 0x60;// <- Uncomment this for user mode interrupts
 }
 
+/* Task gate: the interrupt switches to the TSS 'tss_selector' (ring 0 only) */
+void idt_set_task_gate(unsigned char num, unsigned short tss_selector)
+{
+    idt[num].base_low = 0;
+    idt[num].base_high = 0;
+
+    idt[num].selector = tss_selector;
+    idt[num].zero = 0;
+    idt[num].flags = 0x85; // Present, DPL 0, 32-bit task gate
+}
+
 /* Installs the IDT */
 void idt_install()
 {
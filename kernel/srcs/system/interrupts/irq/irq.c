@@ -6,11 +6,14 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 19:56:00 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/19 18:29:23 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:52:53 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <system/irq.h>
+#include <system/irqsoff.h>
+
+#include <multitasking/scheduler.h>
 
 extern void irq0();
 extern void irq1();
@@ -101,6 +104,7 @@ void irq_install() {
 void irq_handler(struct regs *r) {
     void (*handler)(struct regs *r);
 
+    irqsoff_irq_enter(r->eflags);
     handler = irq_routines[r->int_no - 32];
     if (handler) {
         /* Call the handler. */
@@ -108,4 +112,10 @@ void irq_handler(struct regs *r) {
             handler(r);
     }
     pic8259_send_eoi(r->int_no);
+
+    /* A wake up from the handler may preempt the interrupted task */
+    sched_resched_point();
+
+    /* iret gives the interrupted task its flags back */
+    irqsoff_trace_on(r->eflags, (void *)r->eip);
 }
\ No newline at end of file
@@ -45,8 +45,11 @@ __irq_handler:
 	; set all segments to data segment
     mov ds, ax
     mov es, ax
-    mov fs, ax
     mov gs, ax
+
+	; per-CPU data segment (see percpu.h)
+    mov ax, 0x48
+    mov fs, ax
     mov eax, esp
     push eax
 
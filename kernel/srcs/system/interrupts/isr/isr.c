@@ -6,11 +6,12 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 19:16:43 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/26 15:29:18 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:52:53 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <memory/memory.h>
+#include <system/irqsoff.h>
 #include <system/isr.h>
 #include <system/kerrno.h>
 
@@ -166,9 +167,15 @@ void isrs_install() {
     isr_register(31, "Reserved", 0x24, FAULT, "", false, false);
 }
 
+/**
+ * @brief Register a C handler for an exception
+ * @note : The IDT keeps pointing to the asm stub, which builds the
+ *         'struct regs' frame, fault_handler() then dispatches to 'handler'
+ *         instead of panicking.
+ */
 void isr_register_interrupt_handler(int num, ISR handler) {
     assert(num < NB_INTERRUPT_HANDLERS);
-    idt_set_gate(num, (unsigned)handler, IDT_SELECTOR, IDT_FLAG_GATE);
+    g_interrupt_handlers[num] = handler;
 }
 
 /**
@@ -179,9 +186,18 @@ void isr_register_interrupt_handler(int num, ISR handler) {
 void fault_handler(struct regs *r) {
     uint8_t err_code = 0x0;
 
+    irqsoff_irq_enter(r->eflags);
+
     /* CPU Extend 8bits interrupts to 32bits */
     r->int_no &= 0xFF;
 
+    /* Recoverable exceptions (#NM, #PF...) are handled by their owner */
+    if (g_interrupt_handlers[r->int_no] != NULL) {
+        g_interrupt_handlers[r->int_no](r);
+        irqsoff_trace_on(r->eflags, (void *)r->eip);
+        return;
+    }
+
     KERNO_ASSIGN_ERROR(__KERRNO_SECTOR_ISR, r->int_no);
     if (r->int_no < 32) {
         __display_interrupt_frame(r);
@@ -198,7 +214,4 @@ void fault_handler(struct regs *r) {
         __display_interrupt_frame(r);
         __PANIC_INTERRUPT("Unhandled Interrupt", r->int_no, ABORT, r->err_code);
     }
-
-    if (g_interrupt_handlers[r->int_no] != NULL)
-        g_interrupt_handlers[r->int_no](r);
 }
\ No newline at end of file
@@ -53,6 +53,15 @@ ISR_NO_ERROR 29
 ISR_NO_ERROR 30
 ISR_NO_ERROR 31
 
+; System calls, dispatched by fault_handler() like the exceptions
+global isr128
+
+isr128:
+    cli
+    push byte 0
+    push dword 128
+    jmp isr_exception_handler
+
 extern fault_handler
 
 isr_exception_handler:
@@ -70,9 +79,12 @@ isr_exception_handler:
     mov ax, 0x10
     mov ds, ax
     mov es, ax
-    mov fs, ax
     mov gs, ax
 
+    ; Per-CPU data segment (see percpu.h)
+    mov ax, 0x48
+    mov fs, ax
+
     ; Save the stack pointer
     mov eax, esp
     push eax
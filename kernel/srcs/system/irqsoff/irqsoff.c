@@ -0,0 +1,374 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   irqsoff.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:50:54 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:52:52 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <system/irqsoff.h>
+
+#include <multitasking/process.h>
+
+#include <system/clocksource.h>
+#include <system/cpu.h>
+#include <system/percpu.h>
+#include <system/serial.h>
+
+#include <asm/asm.h>
+#include <asm/div64.h>
+
+typedef struct s_irqsoff_stats {
+    uint32_t count; // Sections timed
+    uint32_t lost;  // Sections ended out of sight
+    uint64_t total_cycles;
+    uint64_t max_cycles;
+    uint32_t hist[IRQSOFF_HIST_BUCKETS];
+    irqsoff_section_t worst[IRQSOFF_WORST]; // Longest first
+} irqsoff_stats_t;
+
+/*
+** Only the owner CPU writes its slot, with interrupts disabled: no lock.
+** Readers copy the stats and retry while the sequence is odd or moved.
+** A reset bumps irqsoff_generation, the owner clears its stats before its
+** next update, readers see older generations as empty.
+*/
+typedef struct s_irqsoff_cpu {
+    volatile uint32_t sequence;
+    uint32_t generation;
+    irqsoff_stats_t stats;
+
+    uint64_t start; // TSC of the open section, 0: none
+    void *start_ip;
+    int32_t start_pid;
+} irqsoff_cpu_t;
+
+static irqsoff_cpu_t irqsoff_cpus[PERCPU_MAX_CPUS];
+static volatile uint32_t irqsoff_generation = 0;
+static volatile bool irqsoff_ready = false;
+
+volatile bool irqsoff_trace_enabled = true;
+
+#define __irqsoff_barrier() __asm__ volatile("" ::: "memory")
+
+/**
+ * @brief Enable the tracer once this_cpu() works
+ * @note : The TSC is calibrated before the GDT loads the per-CPU segment.
+ */
+void irqsoff_init(void) {
+    irqsoff_ready = true;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    SECTIONS                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+static inline bool __irqsoff_active(void) {
+    return (irqsoff_ready && irqsoff_trace_enabled && clocksource.type == CLOCKSOURCE_TSC);
+}
+
+static inline irqsoff_cpu_t *__irqsoff_this_cpu(void) {
+    return (&irqsoff_cpus[this_cpu()->id]);
+}
+
+static void __irqsoff_write_begin(irqsoff_cpu_t *ic) {
+    ic->sequence++;
+    __irqsoff_barrier();
+    if (ic->generation != irqsoff_generation) {
+        bzero((uint8_t *)&ic->stats, sizeof(ic->stats));
+        ic->generation = irqsoff_generation;
+    }
+}
+
+static void __irqsoff_write_end(irqsoff_cpu_t *ic) {
+    __irqsoff_barrier();
+    ic->sequence++;
+}
+
+/**
+ * @brief floor(log2(cycles)) - IRQSOFF_HIST_SHIFT, clamped to the histogram
+ */
+static uint32_t __irqsoff_bucket(uint64_t cycles) {
+    uint32_t high = (uint32_t)(cycles >> 32), low = (uint32_t)cycles;
+    uint32_t log2 = high ? 63 - __builtin_clz(high) : (low ? 31 - __builtin_clz(low) : 0);
+
+    if (log2 <= IRQSOFF_HIST_SHIFT)
+        return (0);
+    if (log2 - IRQSOFF_HIST_SHIFT >= IRQSOFF_HIST_BUCKETS)
+        return (IRQSOFF_HIST_BUCKETS - 1);
+    return (log2 - IRQSOFF_HIST_SHIFT);
+}
+
+/**
+ * @brief Keep 'section' in the worst list if it is one of the longest
+ * @note : One entry per (start, end) pair, holding its longest run.
+ */
+static void __irqsoff_rank(irqsoff_stats_t *st, const irqsoff_section_t *section) {
+    uint32_t i;
+
+    for (i = 0; i < IRQSOFF_WORST - 1; i++) {
+        if (st->worst[i].start_ip == section->start_ip && st->worst[i].end_ip == section->end_ip)
+            break;
+    }
+    if (st->worst[i].cycles >= section->cycles)
+        return;
+    for (; i > 0 && st->worst[i - 1].cycles < section->cycles; i--)
+        st->worst[i] = st->worst[i - 1];
+    st->worst[i] = *section;
+}
+
+static void __irqsoff_start(void *ip) {
+    irqsoff_cpu_t *ic;
+    task_t *current;
+
+    if (!__irqsoff_active())
+        return;
+
+    ic = __irqsoff_this_cpu();
+    if (ic->start) {
+        __irqsoff_write_begin(ic);
+        ic->stats.lost++;
+        __irqsoff_write_end(ic);
+    }
+    current = this_cpu()->current;
+    ic->start_ip = ip;
+    ic->start_pid = current ? current->pid : 0;
+    ic->start = rdtsc();
+}
+
+static void __irqsoff_stop(void *ip) {
+    irqsoff_section_t section;
+    irqsoff_stats_t *st;
+    irqsoff_cpu_t *ic;
+    uint64_t now;
+
+    if (!irqsoff_ready)
+        return;
+
+    ic = __irqsoff_this_cpu();
+    if (!ic->start)
+        return;
+    now = rdtsc();
+    section = (irqsoff_section_t){now > ic->start ? now - ic->start : 0, ic->start_ip, ip, ic->start_pid};
+    ic->start = 0;
+    if (!__irqsoff_active())
+        return;
+
+    st = &ic->stats;
+    __irqsoff_write_begin(ic);
+    st->count++;
+    st->total_cycles += section.cycles;
+    st->hist[__irqsoff_bucket(section.cycles)]++;
+    if (section.cycles > st->max_cycles)
+        st->max_cycles = section.cycles;
+    if (section.cycles > st->worst[IRQSOFF_WORST - 1].cycles)
+        __irqsoff_rank(st, &section);
+    __irqsoff_write_end(ic);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                      HOOKS                                     ||
+// ! ||--------------------------------------------------------------------------------||
+
+void irqsoff_trace_off(uint32_t eflags, void *ip) {
+    if (eflags & IRQSOFF_EFLAGS_IF)
+        __irqsoff_start(ip);
+}
+
+void irqsoff_trace_on(uint32_t eflags, void *ip) {
+    if (eflags & IRQSOFF_EFLAGS_IF)
+        __irqsoff_stop(ip);
+}
+
+/**
+ * @brief An interrupt was taken with IF set: an open section ended unseen
+ */
+void irqsoff_irq_enter(uint32_t eflags) {
+    irqsoff_cpu_t *ic;
+
+    if (!(eflags & IRQSOFF_EFLAGS_IF) || !irqsoff_ready)
+        return;
+
+    ic = __irqsoff_this_cpu();
+    if (!ic->start)
+        return;
+    ic->start = 0;
+    __irqsoff_write_begin(ic);
+    ic->stats.lost++;
+    __irqsoff_write_end(ic);
+}
+
+/**
+ * @brief ASM_CLI(), the section is charged to the caller
+ */
+void irqsoff_cli(void) {
+    uint32_t eflags;
+
+    GET_EFLAGS(eflags);
+    __ASM_CLI();
+    irqsoff_trace_off(eflags, __builtin_return_address(0));
+}
+
+/**
+ * @brief ASM_STI()
+ */
+void irqsoff_sti(void) {
+    uint32_t eflags;
+
+    GET_EFLAGS(eflags);
+    if (!(eflags & IRQSOFF_EFLAGS_IF))
+        __irqsoff_stop(__builtin_return_address(0));
+    __ASM_STI();
+}
+
+/**
+ * @brief SET_EFLAGS(), may close a section or open one
+ */
+void irqsoff_set_eflags(unsigned int eflags) {
+    uint32_t current;
+
+    GET_EFLAGS(current);
+    if (!(current & IRQSOFF_EFLAGS_IF))
+        irqsoff_trace_on(eflags, __builtin_return_address(0));
+    __SET_EFLAGS(eflags);
+    if ((current & IRQSOFF_EFLAGS_IF) && !(eflags & IRQSOFF_EFLAGS_IF))
+        __irqsoff_start(__builtin_return_address(0));
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                     REPORT                                     ||
+// ! ||--------------------------------------------------------------------------------||
+
+void irqsoff_reset(void) {
+    irqsoff_generation++;
+}
+
+/**
+ * @brief Consistent copy of the stats of a CPU
+ */
+static void __irqsoff_snapshot(uint32_t cpu, irqsoff_stats_t *st) {
+    irqsoff_cpu_t *ic = &irqsoff_cpus[cpu];
+    uint32_t sequence, generation;
+
+    do {
+        sequence = ic->sequence;
+        __irqsoff_barrier();
+        generation = ic->generation;
+        memcpy(st, &ic->stats, sizeof(*st));
+        __irqsoff_barrier();
+    } while ((sequence & 1) || sequence != ic->sequence);
+
+    if (generation != irqsoff_generation)
+        bzero((uint8_t *)st, sizeof(*st));
+}
+
+static uint32_t __irqsoff_ns(uint64_t cycles) {
+    uint64_t ns = clocksource_cycles_to_ns(cycles);
+
+    return (ns >> 32 ? 0xFFFFFFFF : (uint32_t)ns);
+}
+
+/**
+ * @brief Print a duration, in us past 10 us
+ */
+static void __irqsoff_print_time(uint64_t cycles) {
+    uint32_t ns = __irqsoff_ns(cycles);
+
+    if (ns < 10 * NSEC_PER_USEC)
+        printk("%u ns", ns);
+    else
+        printk("%u us", ns / NSEC_PER_USEC);
+}
+
+static void __irqsoff_report_histogram(const uint32_t hist[IRQSOFF_HIST_BUCKETS]) {
+    uint32_t peak = 1;
+
+    for (uint32_t b = 0; b < IRQSOFF_HIST_BUCKETS; b++) {
+        if (hist[b] > peak)
+            peak = hist[b];
+    }
+    for (uint32_t b = 0; b < IRQSOFF_HIST_BUCKETS; b++) {
+        uint32_t width = (uint32_t)div_u64((uint64_t)hist[b] * 40, peak);
+
+        if (!hist[b])
+            continue;
+        if (b == IRQSOFF_HIST_BUCKETS - 1) {
+            printk("\t>= ");
+            __irqsoff_print_time(1ULL << (b + IRQSOFF_HIST_SHIFT));
+        } else {
+            printk("\t<  ");
+            __irqsoff_print_time(1ULL << (b + IRQSOFF_HIST_SHIFT + 1));
+        }
+        printk("\t%u\t", hist[b]);
+        while (width--)
+            printk("#");
+        printk("\n");
+    }
+}
+
+/**
+ * @brief Per-CPU maximum, histogram of every CPU and the worst sections
+ */
+void irqsoff_report(void) {
+    uint32_t hist[IRQSOFF_HIST_BUCKETS] = {0};
+    irqsoff_stats_t st;
+
+    printk("IRQs-off tracer: " _GREEN "%s" _END "\n", irqsoff_trace_enabled ? "on" : "off");
+    if (clocksource.type != CLOCKSOURCE_TSC) {
+        printk(_YELLOW "No calibrated TSC, nothing traced" _END "\n");
+        return;
+    }
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        __irqsoff_snapshot(i, &st);
+        printk("CPU " _YELLOW "%u" _END ": %u sections (%u lost), avg ", i, st.count, st.lost);
+        __irqsoff_print_time(st.count ? div_u64(st.total_cycles, st.count) : 0);
+        printk(", max " _RED);
+        __irqsoff_print_time(st.max_cycles);
+        printk(_END "\n");
+        for (uint32_t b = 0; b < IRQSOFF_HIST_BUCKETS; b++)
+            hist[b] += st.hist[b];
+    }
+    __irqsoff_report_histogram(hist);
+
+    printk(_GREEN "Worst sections" _END " (cli -> sti):\n");
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        __irqsoff_snapshot(i, &st);
+        for (uint32_t w = 0; w < IRQSOFF_WORST && st.worst[w].cycles; w++) {
+            printk("\tCPU %u: ", i);
+            __irqsoff_print_time(st.worst[w].cycles);
+            printk("\t0x%x -> 0x%x, task " _GREEN "[%d]" _END "\n", st.worst[w].start_ip, st.worst[w].end_ip, st.worst[w].pid);
+        }
+    }
+}
+
+/**
+ * @brief Write the stats of every CPU to COM1
+ * @note : Format, one record per line:
+ *         stats cpu sections lost max_ns avg_ns
+ *         hist cpu bucket count (bucket b: < 2^(b + 11) cycles)
+ *         worst cpu ns start_ip end_ip pid
+ */
+void irqsoff_dump_serial(void) {
+    irqsoff_stats_t st;
+
+    qemu_printf("# irqsoff cpus=%u tsc_khz=%u hist_shift=%u\n", cpu_count, clocksource_get_tsc_khz(), IRQSOFF_HIST_SHIFT);
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        __irqsoff_snapshot(i, &st);
+        qemu_printf("stats %u %u %u %u %u\n", i, st.count, st.lost, __irqsoff_ns(st.max_cycles),
+                    __irqsoff_ns(st.count ? div_u64(st.total_cycles, st.count) : 0));
+        for (uint32_t b = 0; b < IRQSOFF_HIST_BUCKETS; b++) {
+            if (st.hist[b])
+                qemu_printf("hist %u %u %u\n", i, b, st.hist[b]);
+        }
+        for (uint32_t w = 0; w < IRQSOFF_WORST && st.worst[w].cycles; w++) {
+            qemu_printf("worst %u %u %x %x %d\n", i, __irqsoff_ns(st.worst[w].cycles), st.worst[w].start_ip,
+                        st.worst[w].end_ip, st.worst[w].pid);
+        }
+    }
+    qemu_printf("# end\n");
+}
@@ -6,19 +6,23 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 20:07:16 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 11:35:59 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:57:44 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <asm/asm.h>
+#include <multitasking/cpu_acct.h>
 #include <multitasking/scheduler.h>
+#include <multitasking/watchdog.h>
+#include <system/irqsoff.h>
 #include <system/pit.h>
+#include <system/seqlock.h>
 
 void speaker_phase(int hz) {
     int divisor = __CHIPSET_FREQUENCY / hz;
     outb(PIT_CMDREG, 0xb6);
-    outb(PIT_CHANNEL_2, divisor & PIT_MASK);
-    outb(PIT_CHANNEL_2, (divisor >> 8) & PIT_MASK);
+    outb(PIT_CHANNEL_2_DATA, divisor & PIT_MASK);
+    outb(PIT_CHANNEL_2_DATA, (divisor >> 8) & PIT_MASK);
 }
 
 static void __timer_phase(void) {
@@ -31,13 +35,35 @@ static void __timer_phase(void) {
 
 uint32_t timer_ticks = 0;
 uint32_t timer_subtick = 0;
+uint64_t timer_jiffies = 0; // Monotonic tick count, never wraps (clocksource fallback)
+static seqlock_t jiffies_lock = SEQLOCK_INIT;
 
-void timer_handler(struct regs *r) {
-
-    __UNUSED(r);
+/**
+ * @brief Read the 64-bit jiffies counter atomically on i386
+ * @note : Lock-free, retried if the timer interrupt updated it meanwhile
+ *         (masking IRQs only protects against the local CPU).
+ */
+uint64_t timer_get_jiffies(void) {
+    uint64_t jiffies;
+    uint32_t seq;
+
+    do {
+        seq = read_seqbegin(&jiffies_lock);
+        jiffies = timer_jiffies;
+    } while (read_seqretry(&jiffies_lock, seq));
+    return (jiffies);
+}
 
+void timer_handler(struct regs *r) {
+    write_seqlock(&jiffies_lock);
+    timer_jiffies++;
+    write_sequnlock(&jiffies_lock);
     timer_subtick++;
 
+    /* CPU usage samples and load averages */
+    if (scheduler_initialized)
+        cpu_acct_tick(timer_jiffies);
+
     if (timer_subtick == TIMER_PHASE) {
         timer_ticks++;
     }
@@ -46,6 +72,9 @@ void timer_handler(struct regs *r) {
         timer_subtick = 0;
     }
 
+    /* Before the switch: the next task may not return here for a while */
+    watchdog_tick(r);
+
     if (timer_subtick % TASK_FREQUENCY == 0 && scheduler_initialized) {
         switch_task();
     }
@@ -80,6 +109,7 @@ void timer_install() {
 void busy_wait(uint32_t ticks) {
     uint32_t start_tick = timer_subtick;
     while (timer_subtick - start_tick < ticks) {
+        irqsoff_trace_on(IRQSOFF_EFLAGS_IF, (void *)busy_wait);
         __asm__ volatile("sti\n\thlt\n\tcld");
     }
 }
@@ -96,11 +126,12 @@ void timer_wait(uint32_t ticks) {
     // If the task is running, just busy-wait
     if (task->state == TASK_RUNNING) {
 
-        task->state = TASK_SLEEPING;
         task->wake_up_tick = timer_subtick + ticks;
+        task_set_state(task, TASK_SLEEPING);
 
         // Yield the CPU to allow other tasks to run.
         while (task->state == TASK_SLEEPING) {
+            irqsoff_trace_on(IRQSOFF_EFLAGS_IF, (void *)timer_wait);
             __asm__ volatile("sti\n\thlt\n\tcld");
         }
     } else {
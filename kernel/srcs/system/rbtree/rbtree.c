@@ -0,0 +1,259 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   rbtree.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:27:19 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:30:03 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <system/rbtree.h>
+
+/*
+** Classic red-black tree with parent links:
+** - the root is black, a red node has black children
+** - every path from a node to its leaves has the same number of black nodes
+** - NULL leaves are black
+*/
+
+static inline bool __rb_is_red(const rb_node_t *node) {
+    return (node && node->red);
+}
+
+static void __rb_replace_child(rb_root_t *root, rb_node_t *parent, rb_node_t *old, rb_node_t *new) {
+    if (!parent)
+        root->node = new;
+    else if (parent->left == old)
+        parent->left = new;
+    else
+        parent->right = new;
+}
+
+static void __rb_rotate_left(rb_root_t *root, rb_node_t *node) {
+    rb_node_t *right = node->right;
+
+    node->right = right->left;
+    if (right->left)
+        right->left->parent = node;
+    right->parent = node->parent;
+    __rb_replace_child(root, node->parent, node, right);
+    right->left = node;
+    node->parent = right;
+}
+
+static void __rb_rotate_right(rb_root_t *root, rb_node_t *node) {
+    rb_node_t *left = node->left;
+
+    node->left = left->right;
+    if (left->right)
+        left->right->parent = node;
+    left->parent = node->parent;
+    __rb_replace_child(root, node->parent, node, left);
+    left->right = node;
+    node->parent = left;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    INSERTION                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Rebalance after rb_link_node()
+ * @param leftmost The caller's walk only went left: the node is the new first one
+ */
+void rb_insert_color(rb_node_t *node, rb_root_t *root, bool leftmost) {
+    rb_node_t *parent, *gparent, *uncle;
+
+    if (leftmost)
+        root->leftmost = node;
+
+    while ((parent = node->parent) && parent->red) {
+        gparent = parent->parent;
+
+        if (parent == gparent->left) {
+            uncle = gparent->right;
+            if (__rb_is_red(uncle)) {
+                parent->red = uncle->red = false;
+                gparent->red = true;
+                node = gparent;
+                continue;
+            }
+            if (node == parent->right) {
+                __rb_rotate_left(root, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->red = false;
+            gparent->red = true;
+            __rb_rotate_right(root, gparent);
+        } else {
+            uncle = gparent->left;
+            if (__rb_is_red(uncle)) {
+                parent->red = uncle->red = false;
+                gparent->red = true;
+                node = gparent;
+                continue;
+            }
+            if (node == parent->left) {
+                __rb_rotate_right(root, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->red = false;
+            gparent->red = true;
+            __rb_rotate_left(root, gparent);
+        }
+    }
+    root->node->red = false;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                     ERASE                                      ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Restore the black height after a black node left 'parent'
+ * @param node Child that took the removed node's place (may be NULL)
+ */
+static void __rb_erase_color(rb_root_t *root, rb_node_t *node, rb_node_t *parent) {
+    rb_node_t *sibling;
+
+    while (node != root->node && !__rb_is_red(node)) {
+        if (node == parent->left) {
+            sibling = parent->right;
+            if (sibling->red) {
+                sibling->red = false;
+                parent->red = true;
+                __rb_rotate_left(root, parent);
+                sibling = parent->right;
+            }
+            if (!__rb_is_red(sibling->left) && !__rb_is_red(sibling->right)) {
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+            if (!__rb_is_red(sibling->right)) {
+                sibling->left->red = false;
+                sibling->red = true;
+                __rb_rotate_right(root, sibling);
+                sibling = parent->right;
+            }
+            sibling->red = parent->red;
+            parent->red = false;
+            sibling->right->red = false;
+            __rb_rotate_left(root, parent);
+        } else {
+            sibling = parent->left;
+            if (sibling->red) {
+                sibling->red = false;
+                parent->red = true;
+                __rb_rotate_right(root, parent);
+                sibling = parent->left;
+            }
+            if (!__rb_is_red(sibling->left) && !__rb_is_red(sibling->right)) {
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+            if (!__rb_is_red(sibling->left)) {
+                sibling->right->red = false;
+                sibling->red = true;
+                __rb_rotate_left(root, sibling);
+                sibling = parent->left;
+            }
+            sibling->red = parent->red;
+            parent->red = false;
+            sibling->left->red = false;
+            __rb_rotate_right(root, parent);
+        }
+        node = root->node;
+        break;
+    }
+    if (node)
+        node->red = false;
+}
+
+/**
+ * @brief Remove a node from its tree
+ */
+void rb_erase(rb_node_t *node, rb_root_t *root) {
+    rb_node_t *child, *parent;
+    bool red;
+
+    if (root->leftmost == node)
+        root->leftmost = rb_next(node);
+
+    if (node->left && node->right) {
+        /* Two children: the successor takes the node's place and color */
+        rb_node_t *successor = node->right;
+
+        while (successor->left)
+            successor = successor->left;
+
+        child = successor->right;
+        parent = successor->parent;
+        red = successor->red;
+
+        if (parent == node) {
+            parent = successor;
+        } else {
+            if (child)
+                child->parent = parent;
+            parent->left = child;
+            successor->right = node->right;
+            node->right->parent = successor;
+        }
+        successor->parent = node->parent;
+        successor->left = node->left;
+        successor->red = node->red;
+        __rb_replace_child(root, node->parent, node, successor);
+        node->left->parent = successor;
+    } else {
+        child = node->left ? node->left : node->right;
+        parent = node->parent;
+        red = node->red;
+
+        if (child)
+            child->parent = parent;
+        __rb_replace_child(root, parent, node, child);
+    }
+
+    if (!red)
+        __rb_erase_color(root, child, parent);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                     WALKS                                      ||
+// ! ||--------------------------------------------------------------------------------||
+
+rb_node_t *rb_last(const rb_root_t *root) {
+    rb_node_t *node = root->node;
+
+    if (!node)
+        return (NULL);
+    while (node->right)
+        node = node->right;
+    return (node);
+}
+
+/**
+ * @brief In-order successor, NULL after the last node
+ */
+rb_node_t *rb_next(const rb_node_t *node) {
+    rb_node_t *parent;
+
+    if (node->right) {
+        node = node->right;
+        while (node->left)
+            node = node->left;
+        return ((rb_node_t *)node);
+    }
+    while ((parent = node->parent) && node == parent->right)
+        node = parent;
+    return (parent);
+}
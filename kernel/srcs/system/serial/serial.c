@@ -6,12 +6,17 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/09/01 16:14:29 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/05/29 13:32:51 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:20:30 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <kernel.h>
 #include <system/serial.h>
+#include <system/smp.h>
+#include <system/spinlock.h>
+
+/* One message at a time on COM1, once the APs may print (see terminal.c) */
+static rspinlock_t serial_lock = RSPINLOCK_INIT;
 
 static int __is_transmit_empty(void)
 {
@@ -27,9 +32,16 @@ static void __write_serial(const char c)
 
 void qemu_printf(const char *str, ...)
 {
+    bool locked = smp_enabled;
+    uint32_t eflags = 0;
+
     va_list(ap);
     va_start(ap, str);
+    if (locked)
+        eflags = rspinlock_acquire_irqsave(&serial_lock);
     vsprintk(str, __write_serial, str, ap);
+    if (locked)
+        rspinlock_release_irqrestore(&serial_lock, eflags);
     va_end(ap);
 }
 
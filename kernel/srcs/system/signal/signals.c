@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/19 10:10:22 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/24 00:14:57 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:10:15 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -15,35 +15,52 @@
 #include <multitasking/scheduler.h>
 #include <system/signal.h>
 
-signal_node_t signals[SIGNALS_COUNT];
+signal_default_t signals[SIGNALS_COUNT];
+
+bool signal_valid(int32_t signum) {
+    return (signum > 0 && signum < SIGNALS_COUNT);
+}
 
 void signal(pid_t pid, int signum) {
-    task_t *task = get_task(pid);
+    task_t *task;
+
+    if (!signal_valid(signum))
+        __THROW_NO_RETURN("Signal not found (maybe not implemented)");
+
+    /* The task may exit meanwhile: its task_t stays valid until we leave */
+    rcu_read_lock();
+    if ((task = get_task(pid)))
+        task_send_signal(task, signum);
+    rcu_read_unlock();
 
-    if (task) {
-        if (signum >= 0 && signum < SIGNALS_COUNT) {
-            task_add_signal(task, signum, signals[signum].handler);
-        } else {
-            __THROW_NO_RETURN("Signal not found (maybe not implemented)");
-        }
-    } else {
+    if (!task)
         __THROW_NO_RETURN("Task not found");
-    }
 }
 
-void sigchld_handler() {
-    
+/**
+ * @brief Default SIGCHLD action: ignore
+ * @note : The parent sleeping in waitpid() is woken through its child_exit
+ *         queue, see process_wait.c
+ */
+void sigchld_handler(task_t *task, int32_t signum) {
+    __UNUSED(task);
+    __UNUSED(signum);
 }
 
-void kill_handler(int32_t signum) {
+/**
+ * @brief Default SIGKILL action: terminate the task it was sent to
+ * @note : Delivered by schedule() to the task it picked, which then drops
+ *         the zombie: task_terminate() never switches away itself.
+ */
+void kill_handler(task_t *task, int32_t signum) {
     switch (signum) {
     case SIGKILL: {
         printk(_YELLOW "SIGNAL Killing task "_GREEN
                        "[%d]"_END
                        "\n",
-               getpid());
-        get_current_task()->exit_code = 0;
-        kill_task(getpid());
+               task->pid);
+        task->exit_code = 0;
+        task_terminate(task);
         break;
     }
     default:
@@ -52,36 +69,19 @@ void kill_handler(int32_t signum) {
     }
 }
 
-static void __add_signal_handler(int signum, void (*handler)(int32_t), char *name) {
+static void __add_signal_handler(int signum, void (*action)(task_t *, int32_t), char *name) {
 
     printk("\t\t\t   - Signal " _YELLOW "[%d]" _END " - " _GREEN "%s" _END "\n", signum, name);
 
-    signals[signum] = (signal_node_t){
+    signals[signum] = (signal_default_t){
         .name = name,
         .signum = signum,
-        .handler = handler,
-        .next = NULL,
+        .action = action,
     };
-
-    // signal_node_t *new_signal = (signal_node_t *)kmalloc(sizeof(signal_node_t));
-    // new_signal->signum = signum;
-    // new_signal->handler = handler;
-    // new_signal->next = NULL;
-
-    // if (__signal_count == 0) {
-    //     __signal_handlers = new_signal;
-    // } else {
-    //     signal_node_t *current_signal = __signal_handlers;
-    //     while (current_signal->next != NULL) {
-    //         current_signal = current_signal->next;
-    //     }
-    //     current_signal->next = new_signal;
-    // }
-    // __signal_count++;
 }
 
 void init_signals(void) {
-    bzero((uint8_t *)signals, sizeof(signal_node_t) * SIGNALS_COUNT);
+    bzero((uint8_t *)signals, sizeof(signal_default_t) * SIGNALS_COUNT);
     __add_signal_handler(SIGKILL, kill_handler, STRINGIFY(SIGKILL));
-    // __add_signal_handler(SIGCHLD, sigchld_handler, STRINGIFY(SIGCHLD));
-}
\ No newline at end of file
+    __add_signal_handler(SIGCHLD, sigchld_handler, STRINGIFY(SIGCHLD));
+}
@@ -0,0 +1,100 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   percpu.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:32:55 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 02:47:01 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <memory/kstack.h>
+#include <system/percpu.h>
+
+cpu_t cpus[PERCPU_MAX_CPUS];
+uint32_t cpu_count = 1;
+
+static uint8_t __df_stacks[PERCPU_MAX_CPUS][PERCPU_DF_STACK_SIZE] __attribute__((aligned(16)));
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  PER-CPU DATA                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Load the per-CPU data segment in %fs
+ * @note : The selector is the same on every CPU, each GDT gives it its own base.
+ */
+void percpu_load_segment(void) {
+    __asm__ volatile("movw %w0, %%fs" ::"r"(PERCPU_SELECTOR));
+}
+
+/**
+ * @brief Per-CPU data of the BSP
+ * @note : Called by gdt_install(), the BSP keeps the GDT at __GDT_ADDR and
+ *         the global tss_entry.
+ */
+void percpu_init_bsp(void) {
+    cpu_t *cpu = &cpus[0];
+
+    cpu->self = cpu;
+    cpu->id = 0;
+    cpu->online = true;
+    cpu->tss = &tss_entry;
+
+    gdt_add_entry(PERCPU_GDT_INDEX, (uint32_t)cpu, sizeof(cpu_t) - 1, (uint8_t)(GDT_DATA_PL0), PERCPU_DATA_FLAGS);
+    percpu_load_segment();
+}
+
+/**
+ * @brief Build and load the GDT / TSS / per-CPU segment of an AP
+ * @note : Runs on the AP itself. The shared segments are copied from the BSP
+ *         GDT so every selector keeps the same meaning on every CPU.
+ */
+void percpu_init_ap(cpu_t *cpu) {
+    cpu->self = cpu;
+
+    memcpy(cpu->gdt, gdt, sizeof(GDTEntry) * PERCPU_TSS_INDEX);
+
+    memset((void *)&cpu->tss_storage, 0, sizeof(tss_entry_t));
+    cpu->tss_storage.ss0 = 0x10;
+    cpu->tss_storage.iomap = sizeof(tss_entry_t);
+    cpu->tss = &cpu->tss_storage;
+
+    gdt_set_entry(cpu->gdt, PERCPU_TSS_INDEX, (uint32_t)cpu->tss, sizeof(tss_entry_t) - 1, PERCPU_TSS_ACCESS, 0x0);
+    gdt_set_entry(cpu->gdt, PERCPU_TSS_INDEX + 1, 0x0, 0x0, 0x0, 0x0);
+    gdt_set_entry(cpu->gdt, PERCPU_GDT_INDEX, (uint32_t)cpu, sizeof(cpu_t) - 1, (uint8_t)(GDT_DATA_PL0), PERCPU_DATA_FLAGS);
+
+    cpu->gdt_ptr.limit = sizeof(cpu->gdt) - 1;
+    cpu->gdt_ptr.base = (uint32_t)cpu->gdt;
+
+    gdt_flush((uint32_t)&cpu->gdt_ptr);
+    percpu_load_segment();
+
+    __asm__ volatile("ltr %w0" ::"r"((uint16_t)PERCPU_TSS_SELECTOR));
+
+    percpu_install_double_fault(cpu, cpu->gdt);
+}
+
+/**
+ * @brief Describe the double fault task of a CPU in its GDT
+ * @note : A #DF raised by a kernel stack overflow has no stack left to push
+ *         its frame on: the task gate switches to df_tss, with its own stack
+ *         and the kernel directory. Needs paging (cr3) and a loaded TR.
+ */
+void percpu_install_double_fault(cpu_t *cpu, GDTEntry *table) {
+    tss_entry_t *tss = &cpu->df_tss;
+
+    memset((void *)tss, 0, sizeof(tss_entry_t));
+    tss->cr3 = kernel_directory->physicalAddr;
+    tss->eip = (uint32_t)&kstack_double_fault;
+    tss->eflags = 0x2;
+    tss->esp = (uint32_t)&__df_stacks[cpu->id][PERCPU_DF_STACK_SIZE];
+    tss->cs = 0x08;
+    tss->ds = tss->es = tss->ss = tss->gs = 0x10;
+    tss->fs = PERCPU_SELECTOR;
+    tss->iomap = sizeof(tss_entry_t);
+
+    gdt_set_entry(table, PERCPU_DF_TSS_INDEX, (uint32_t)tss, sizeof(tss_entry_t) - 1, PERCPU_TSS_ACCESS, 0x0);
+}
@@ -0,0 +1,252 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   smp.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:36:35 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 02:47:01 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <system/apic.h>
+#include <system/clocksource.h>
+#include <system/fpu.h>
+#include <system/idt.h>
+#include <system/pit.h>
+#include <system/smp.h>
+
+#include <memory/kheap.h>
+#include <memory/kstack.h>
+#include <memory/paging.h>
+
+#include <multitasking/scheduler.h>
+
+#include <asm/asm.h>
+
+/* trampoline.s */
+extern uint8_t smp_trampoline_start[];
+extern uint8_t smp_trampoline_end[];
+extern uint8_t smp_trampoline_gdt[];
+extern uint8_t smp_trampoline_cr3[];
+extern uint8_t smp_trampoline_stack[];
+extern uint8_t smp_trampoline_entry[];
+extern uint8_t smp_trampoline_cpu[];
+
+/* Address of a trampoline variable in the copy at SMP_TRAMPOLINE_ADDR */
+#define __TRAMPOLINE_VAR(type, sym) ((type *)(SMP_TRAMPOLINE_ADDR + ((uint32_t)(sym) - (uint32_t)smp_trampoline_start)))
+
+bool smp_enabled = false;
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                    MP TABLE                                    ||
+// ! ||--------------------------------------------------------------------------------||
+
+static bool __mp_checksum(const uint8_t *ptr, uint32_t length) {
+    uint8_t sum = 0;
+
+    while (length--)
+        sum += *ptr++;
+    return (sum == 0);
+}
+
+static mp_floating_t *__mp_search(uint32_t base, uint32_t length) {
+    for (uint32_t addr = base; addr + sizeof(mp_floating_t) <= base + length; addr += 16) {
+        mp_floating_t *mp = (mp_floating_t *)addr;
+
+        if (mp->signature == MP_FLOATING_SIGNATURE && __mp_checksum((uint8_t *)mp, mp->length * 16))
+            return (mp);
+    }
+    return (NULL);
+}
+
+/**
+ * @brief Find the MP floating pointer
+ * @note : Searched in the first KB of the EBDA, the last KB of the base
+ *         memory, then the BIOS ROM (MP specification, section 4).
+ */
+static mp_floating_t *__mp_find(void) {
+    uint32_t ebda = (uint32_t)(*(volatile uint16_t *)0x40E) << 4;
+    uint32_t base_memory = (uint32_t)(*(volatile uint16_t *)0x413) * 1024;
+    mp_floating_t *mp = NULL;
+
+    if (ebda)
+        mp = __mp_search(ebda, 1024);
+    if (!mp && base_memory)
+        mp = __mp_search(base_memory - 1024, 1024);
+    if (!mp)
+        mp = __mp_search(0xF0000, 0x10000);
+    return (mp);
+}
+
+/**
+ * @brief Fill cpus[] with the enabled processors of the MP table
+ * @note : The BSP is always cpus[0], the APs follow in table order.
+ */
+static uint32_t __mp_parse(mp_config_t *config) {
+    uint8_t *entry = (uint8_t *)(config + 1);
+    uint32_t count = 1;
+
+    for (uint32_t i = 0; i < config->entry_count; i++) {
+        if (*entry != MP_ENTRY_PROCESSOR) {
+            entry += MP_ENTRY_OTHER_SIZE;
+            continue;
+        }
+
+        mp_processor_t *processor = (mp_processor_t *)entry;
+
+        if (processor->flags & MP_PROCESSOR_BSP) {
+            cpus[0].apic_id = processor->lapic_id;
+        } else if ((processor->flags & MP_PROCESSOR_ENABLED) && count < PERCPU_MAX_CPUS) {
+            cpus[count].id = count;
+            cpus[count].apic_id = processor->lapic_id;
+            count++;
+        }
+        entry += MP_ENTRY_PROCESSOR_SIZE;
+    }
+    return (count);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  AP BOOTSTRAP                                  ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief First C code run by an AP (called by the trampoline)
+ * @note : Runs on the AP boot stack with the kernel directory loaded. Once
+ *         online the AP becomes its own idle task and takes its scheduler
+ *         ticks from its LAPIC timer.
+ */
+void ap_main(uint32_t cpu_id) {
+    cpu_t *cpu = &cpus[cpu_id];
+
+    percpu_init_ap(cpu);
+    idt_load(&idtp);
+    fpu_init_cpu();
+    lapic_init();
+
+    cpu->directory = kernel_directory;
+    sched_init_idle(cpu, true);
+    cpu->online = true;
+
+    lapic_timer_start(TIMER_PHASE);
+    cpu_idle();
+}
+
+/**
+ * @brief INIT - STARTUP - STARTUP sequence (MP specification, appendix B.4)
+ */
+static bool __smp_boot_ap(cpu_t *cpu) {
+    if (!(cpu->boot_stack = kstack_alloc()))
+        __THROW("smp : failed to allocate CPU %d boot stack", false, cpu->id);
+
+    /* The trampoline data is shared: one AP at a time */
+    *__TRAMPOLINE_VAR(uint32_t, smp_trampoline_stack) = cpu->boot_stack + KSTACK_SIZE;
+    *__TRAMPOLINE_VAR(uint32_t, smp_trampoline_cpu) = cpu->id;
+
+    lapic_send_init(cpu->apic_id);
+    clocksource_udelay(10000);
+
+    lapic_send_startup(cpu->apic_id, SMP_TRAMPOLINE_ADDR);
+    clocksource_udelay(200);
+    if (!cpu->online)
+        lapic_send_startup(cpu->apic_id, SMP_TRAMPOLINE_ADDR);
+
+    for (uint32_t us = 0; !cpu->online && us < SMP_AP_BOOT_TIMEOUT_MS * 1000; us += 100)
+        clocksource_udelay(100);
+
+    if (!cpu->online) {
+        kstack_free(cpu->boot_stack);
+        cpu->boot_stack = 0;
+        __THROW("smp : CPU %d (APIC %d) did not come online", false, cpu->id, cpu->apic_id);
+    }
+    return (true);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                               INTERFACE FUNCTIONS                              ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Detect the CPUs, before paging
+ * @note : Reads the MP table (low memory, not mapped afterwards) and reserves
+ *         the LAPIC registers so init_paging() maps them in every directory.
+ */
+void smp_early_init(void) {
+    mp_floating_t *mp;
+    mp_config_t *config;
+
+    if (!__SMP_ENABLED__ || !lapic_detect())
+        return;
+
+    if (!(mp = __mp_find()) || !mp->config || mp->type) {
+        __WARND("smp : no MP configuration table, running on the BSP only");
+        return;
+    }
+
+    config = (mp_config_t *)mp->config;
+    if (config->signature != MP_CONFIG_SIGNATURE || !__mp_checksum((uint8_t *)config, config->length)) {
+        __WARND("smp : invalid MP configuration table, running on the BSP only");
+        return;
+    }
+
+    cpu_count = __mp_parse(config);
+    paging_reserve_mmio(lapic_base, LAPIC_MMIO_SIZE);
+    smp_enabled = true;
+}
+
+/**
+ * @brief Boot the APs
+ * @note : Must run after init_tasking(): the APs pick tasks from the run
+ *         queues as soon as they are online.
+ */
+void smp_init(void) {
+    uint32_t eflags;
+
+    if (!smp_enabled)
+        return;
+
+    GET_EFLAGS(eflags);
+    ASM_CLI();
+
+    lapic_install();
+    lapic_init();
+    lapic_timer_calibrate();
+
+    memcpy((void *)SMP_TRAMPOLINE_ADDR, smp_trampoline_start, smp_trampoline_end - smp_trampoline_start);
+    memcpy(__TRAMPOLINE_VAR(void, smp_trampoline_gdt), &gp, sizeof(GDTPtr));
+    *__TRAMPOLINE_VAR(uint32_t, smp_trampoline_cr3) = kernel_directory->physicalAddr;
+    *__TRAMPOLINE_VAR(uint32_t, smp_trampoline_entry) = (uint32_t)&ap_main;
+
+    for (uint32_t i = 1; i < cpu_count; i++)
+        __smp_boot_ap(&cpus[i]);
+
+    SET_EFLAGS(eflags);
+}
+
+uint32_t smp_online_cpus(void) {
+    uint32_t online = 0;
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        if (cpus[i].online)
+            online++;
+    }
+    return (online);
+}
+
+void smp_print_cpus(void) {
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        printk("CPU "_GREEN
+               "[%u]"_END
+               " APIC "_GREEN
+               "[%u]"_END
+               " %s - run queue: "_GREEN
+               "[%u]"_END
+               " tasks, stolen: "_GREEN
+               "[%u]"_END
+               "\n",
+               cpus[i].id, cpus[i].apic_id, cpus[i].online ? "online" : "offline",
+               cpus[i].rq.nr_tasks, cpus[i].steals);
+    }
+}
@@ -0,0 +1,79 @@
+; AP boot trampoline
+;
+; Copied at SMP_TRAMPOLINE_ADDR (0x7000) by smp_init(); a STARTUP IPI makes
+; the AP start here in real mode, with CS:IP = 0x0700:0000.
+;
+; The BSP fills the data block at the end before each STARTUP IPI:
+;   smp_trampoline_gdt   GDT pointer (the BSP GDT, below 1MB)
+;   smp_trampoline_cr3   kernel directory (identity maps the low memory)
+;   smp_trampoline_stack top of the AP boot stack
+;   smp_trampoline_entry ap_main(cpu_id)
+;   smp_trampoline_cpu   logical id of the AP
+
+TRAMPOLINE_BASE equ 0x7000
+%define TRAMPOLINE_ADDR(x) (TRAMPOLINE_BASE + ((x) - smp_trampoline_start))
+
+section .text
+
+global smp_trampoline_start
+global smp_trampoline_end
+global smp_trampoline_gdt
+global smp_trampoline_cr3
+global smp_trampoline_stack
+global smp_trampoline_entry
+global smp_trampoline_cpu
+
+bits 16
+smp_trampoline_start:
+	cli
+	cld
+	xor ax, ax
+	mov ds, ax
+
+	lgdt [TRAMPOLINE_ADDR(smp_trampoline_gdt)]
+
+	mov eax, cr0
+	or eax, 0x1							; Protected mode
+	mov cr0, eax
+	jmp dword 0x08:TRAMPOLINE_ADDR(.protected_mode)
+
+bits 32
+.protected_mode:
+	mov ax, 0x10
+	mov ds, ax
+	mov es, ax
+	mov fs, ax
+	mov gs, ax
+	mov ss, ax
+
+	mov eax, [TRAMPOLINE_ADDR(smp_trampoline_cr3)]
+	mov cr3, eax
+	mov eax, cr0
+	or eax, 0x80000000						; Paging
+	mov cr0, eax
+
+	mov esp, [TRAMPOLINE_ADDR(smp_trampoline_stack)]
+	xor ebp, ebp
+	push dword [TRAMPOLINE_ADDR(smp_trampoline_cpu)]
+	mov eax, [TRAMPOLINE_ADDR(smp_trampoline_entry)]
+	call eax							; ap_main(cpu_id), never returns
+
+.halt:
+	cli
+	hlt
+	jmp .halt
+
+align 8
+smp_trampoline_gdt:
+	dw 0
+	dd 0
+align 4
+smp_trampoline_cr3:
+	dd 0
+smp_trampoline_stack:
+	dd 0
+smp_trampoline_entry:
+	dd 0
+smp_trampoline_cpu:
+	dd 0
+smp_trampoline_end:
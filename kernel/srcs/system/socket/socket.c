@@ -6,25 +6,27 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/20 15:05:16 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/23 12:56:06 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:10:44 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <memory/memory.h>
 #include <memory/shared.h>
 #include <multitasking/process.h>
+#include <system/rwlock.h>
 #include <system/socket.h>
 
+/*
+** Socket table: looked up far more often than sockets come and go.
+** create/destroy hold the write side to update a slot, lookups take no
+** lock (RCU): a destroyed socket is freed one grace period later.
+*/
 static socket_t *sockets[MAX_SOCKETS] = {NULL};
-static mutex_t socket_mutex = (mutex_t){
-    .state = MUTEX_UNLOCKED,
-    .owner = 1,
-    .wait_queue = NULL,
-};
+static rwlock_t socket_table_lock = RWLOCK_INIT;
 
 socket_t *socket_create(socket_flags_t flags) {
-    mutex_lock(&socket_mutex);
     socket_t *socket = NULL;
+    uint32_t eflags;
 
     if (flags & SOCKET_SHARED_DATA) {
         socket = kmalloc_shared(sizeof(socket_t));
@@ -44,30 +46,61 @@ socket_t *socket_create(socket_flags_t flags) {
 
     init_mutex(&socket->mutex);
 
+    eflags = write_lock_irqsave(&socket_table_lock);
     for (int i = 0; i < MAX_SOCKETS; ++i) {
         if (sockets[i] == NULL) {
-            sockets[i] = socket;
+            rcu_assign_pointer(sockets[i], socket);
             break;
         }
     }
-    mutex_unlock(&socket_mutex);
+    write_unlock_irqrestore(&socket_table_lock, eflags);
     return (socket);
 }
 
+static void __socket_free_rcu(rcu_head_t *head) {
+    socket_t *socket = rcu_entry(head, socket_t, rcu);
+
+    if (socket->flags & SOCKET_SHARED_DATA) {
+        kfree_shared(socket);
+    } else {
+        kfree(socket);
+    }
+}
+
 void socket_destroy(socket_t *socket) {
-    mutex_lock(&socket_mutex);
+    uint32_t eflags = write_lock_irqsave(&socket_table_lock);
+
     for (int i = 0; i < MAX_SOCKETS; ++i) {
         if (sockets[i] == socket) {
             sockets[i] = NULL;
             break;
         }
     }
-    if (socket->flags & SOCKET_SHARED_DATA) {
-        kfree_shared(socket);
-    } else {
-        kfree(socket);
+    write_unlock_irqrestore(&socket_table_lock, eflags);
+
+    call_rcu(&socket->rcu, &__socket_free_rcu);
+}
+
+/**
+ * @brief Find the first socket created by task 'id'
+ * @return socket_t*, NULL if the task owns no socket
+ * @note : Lockless, the socket stays valid while the caller is in an RCU
+ *         read section.
+ */
+socket_t *socket_find(int id) {
+    socket_t *socket = NULL;
+
+    rcu_read_lock();
+    for (int i = 0; i < MAX_SOCKETS; ++i) {
+        socket_t *entry = rcu_dereference(sockets[i]);
+
+        if (entry && entry->id == id) {
+            socket = entry;
+            break;
+        }
     }
-    mutex_unlock(&socket_mutex);
+    rcu_read_unlock();
+    return (socket);
 }
 
 int socket_send(socket_t *socket, const char *data, int len) {
@@ -0,0 +1,130 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   rwlock.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:04:59 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:52:53 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <system/irqsoff.h>
+#include <system/preempt.h>
+#include <system/rwlock.h>
+
+#include <asm/asm.h>
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 RWLOCK - READERS                               ||
+// ! ||--------------------------------------------------------------------------------||
+
+void rwlock_init(rwlock_t *rw) {
+    rw->lock = SPINLOCK_INIT;
+    rw->readers = 0;
+    rw->writer = false;
+    rw->writers_waiting = 0;
+}
+
+/**
+ * @brief Enter a read section
+ * @note : Backs off while a writer holds or waits for the lock. Readers and
+ *         writers are not preempted while they hold it (see preempt.h).
+ */
+void read_lock(rwlock_t *rw) {
+    preempt_disable();
+    while (true) {
+        while (rw->writer || rw->writers_waiting)
+            __asm__ volatile("pause");
+
+        spinlock_acquire(&rw->lock);
+        if (!rw->writer && !rw->writers_waiting) {
+            rw->readers++;
+            spinlock_release(&rw->lock);
+            return;
+        }
+        spinlock_release(&rw->lock);
+    }
+}
+
+void read_unlock(rwlock_t *rw) {
+    __sync_fetch_and_sub(&rw->readers, 1);
+    preempt_enable();
+}
+
+unsigned int read_lock_irqsave(rwlock_t *rw) {
+    unsigned int eflags;
+
+    GET_EFLAGS(eflags);
+    __ASM_CLI();
+    irqsoff_trace_off(eflags, __builtin_return_address(0));
+    read_lock(rw);
+    return (eflags);
+}
+
+void read_unlock_irqrestore(rwlock_t *rw, unsigned int eflags) {
+    __sync_fetch_and_sub(&rw->readers, 1);
+    irqsoff_trace_on(eflags, __builtin_return_address(0));
+    __SET_EFLAGS(eflags);
+    preempt_enable();
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 RWLOCK - WRITERS                               ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Take the lock exclusively
+ * @note : The writer announces itself first, so readers arriving after it
+ *         wait, then it waits for the readers already inside to leave.
+ */
+void write_lock(rwlock_t *rw) {
+    preempt_disable();
+    spinlock_acquire(&rw->lock);
+    if (!rw->writer && !rw->readers) {
+        rw->writer = true;
+        spinlock_release(&rw->lock);
+        return;
+    }
+    rw->writers_waiting++;
+    spinlock_release(&rw->lock);
+
+    while (true) {
+        while (rw->writer || rw->readers)
+            __asm__ volatile("pause");
+
+        spinlock_acquire(&rw->lock);
+        if (!rw->writer && !rw->readers) {
+            rw->writer = true;
+            rw->writers_waiting--;
+            spinlock_release(&rw->lock);
+            return;
+        }
+        spinlock_release(&rw->lock);
+    }
+}
+
+void write_unlock(rwlock_t *rw) {
+    __asm__ volatile("" ::: "memory");
+    rw->writer = false;
+    preempt_enable();
+}
+
+unsigned int write_lock_irqsave(rwlock_t *rw) {
+    unsigned int eflags;
+
+    GET_EFLAGS(eflags);
+    __ASM_CLI();
+    irqsoff_trace_off(eflags, __builtin_return_address(0));
+    write_lock(rw);
+    return (eflags);
+}
+
+void write_unlock_irqrestore(rwlock_t *rw, unsigned int eflags) {
+    __asm__ volatile("" ::: "memory");
+    rw->writer = false;
+    irqsoff_trace_on(eflags, __builtin_return_address(0));
+    __SET_EFLAGS(eflags);
+    preempt_enable();
+}
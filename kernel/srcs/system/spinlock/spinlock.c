@@ -6,26 +6,136 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/21 23:18:36 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/23 12:08:05 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:52:53 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
+#include <system/irqsoff.h>
+#include <system/percpu.h>
+#include <system/preempt.h>
 #include <system/spinlock.h>
 
+/*
+** Every spinlock held disables preemption on its CPU (see preempt.h): the
+** holder is never switched out while others spin on it. The irqsave
+** variants also disable interrupts, for locks an interrupt handler takes,
+** and report the section to the irqs-off tracer on behalf of their caller.
+*/
+
+static inline void __spinlock_spin(spinlock_t *lock) {
+    while (*lock || __sync_lock_test_and_set(lock, 1)) {
+        __asm__ volatile("pause");
+    }
+}
+
 /**
  * Spinlock
  * - A spinlock is a lock which causes a thread trying to acquire it to simply wait in a loop ("spin")
  */
 void spinlock_acquire(spinlock_t *lock) {
-    while (*lock || __sync_lock_test_and_set(lock, 1)) {
-        // Spin
-    }
+    preempt_disable();
+    __spinlock_spin(lock);
+}
+
+/**
+ * Spinlock try acquire
+ * - Take the lock only if it is free, returns 1 on success
+ */
+int spinlock_try_acquire(spinlock_t *lock) {
+    preempt_disable();
+    if (!*lock && !__sync_lock_test_and_set(lock, 1))
+        return (1);
+    preempt_enable();
+    return (0);
+}
+
+/**
+ * Spinlock acquire irqsave
+ * - Disable interrupts on this CPU, then take the lock: an interrupt handler
+ *   taking the same lock on the same CPU would spin forever otherwise
+ * - Returns the previous EFLAGS, to give back to spinlock_release_irqrestore
+ */
+unsigned int spinlock_acquire_irqsave(spinlock_t *lock) {
+    unsigned int eflags;
+
+    __asm__ volatile("pushf; pop %0; cli"
+                     : "=r"(eflags)
+                     :
+                     : "memory");
+    irqsoff_trace_off(eflags, __builtin_return_address(0));
+    spinlock_acquire(lock);
+    return (eflags);
 }
 
 /**
  * Spinlock release
- * - Release a spinlock
+ * - Release a spinlock, run the switch deferred while it was held
  */
 void spinlock_release(spinlock_t *lock) {
-    *lock = 0;
-}
\ No newline at end of file
+    __sync_lock_release(lock);
+    preempt_enable();
+}
+
+/**
+ * Spinlock release irqrestore
+ * - Release the lock, then restore the interrupt flag saved by spinlock_acquire_irqsave
+ * - The deferred switch runs once interrupts are back on
+ */
+void spinlock_release_irqrestore(spinlock_t *lock, unsigned int eflags) {
+    __sync_lock_release(lock);
+    irqsoff_trace_on(eflags, __builtin_return_address(0));
+    __asm__ volatile("push %0; popf"
+                     :
+                     : "r"(eflags)
+                     : "memory", "cc");
+    preempt_enable();
+}
+
+/**
+ * Recursive spinlock acquire irqsave
+ * - Same as spinlock_acquire_irqsave, but the CPU holding the lock only
+ *   increases its depth
+ */
+unsigned int rspinlock_acquire_irqsave(rspinlock_t *lock) {
+    unsigned int eflags;
+    int cpu;
+
+    __asm__ volatile("pushf; pop %0; cli"
+                     : "=r"(eflags)
+                     :
+                     : "memory");
+    irqsoff_trace_off(eflags, __builtin_return_address(0));
+    preempt_disable();
+    cpu = (int)this_cpu()->id;
+    if (lock->owner != cpu) {
+        __spinlock_spin(&lock->lock);
+        lock->owner = cpu;
+    }
+    lock->depth++;
+    return (eflags);
+}
+
+/**
+ * Recursive spinlock release irqrestore
+ * - The lock is released when the outermost holder gives it back
+ */
+void rspinlock_release_irqrestore(rspinlock_t *lock, unsigned int eflags) {
+    if (--lock->depth == 0) {
+        lock->owner = -1;
+        __sync_lock_release(&lock->lock);
+    }
+    irqsoff_trace_on(eflags, __builtin_return_address(0));
+    __asm__ volatile("push %0; popf"
+                     :
+                     : "r"(eflags)
+                     : "memory", "cc");
+    preempt_enable();
+}
+
+/**
+ * Recursive spinlock held
+ * - Returns 1 if this CPU holds the lock
+ */
+int rspinlock_held(rspinlock_t *lock) {
+    return (lock->owner == (int)this_cpu()->id);
+}
@@ -6,14 +6,16 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/12/07 22:30:48 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/21 22:31:16 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:23:18 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <syscall/syscall.h>
 #include <system/irq.h>
 
+#include <multitasking/cpu_acct.h>
 #include <multitasking/process.h>
+#include <multitasking/scheduler.h>
 
 extern int syscall_restart(void) {
 #warning "Syscall restart not implemented yet"
@@ -26,9 +28,11 @@ extern int syscall_exit(int32_t status) {
 extern int syscall_fork(void) {
     return (task_fork());
 }
-extern int syscall_wait(void) {
-#warning "Syscall wait not implemented yet"
-    return (0);
+extern int syscall_wait(int32_t *status) {
+    return (wait(status));
+}
+extern int syscall_waitpid(pid_t pid, int32_t *status, int32_t options) {
+    return (waitpid(pid, status, options));
 }
 
 extern int syscall_read(int fd) {
@@ -46,6 +50,17 @@ extern int syscall_kill(pid_t pid, int sig) {
     return (kill(pid, sig));
 }
 
+extern int syscall_futex(uint32_t *uaddr, int op, uint32_t val, uint32_t timeout_ms) {
+    return (futex(uaddr, op, val, timeout_ms));
+}
+
+extern int syscall_sched_setscheduler(pid_t pid, int policy, uint32_t rt_priority) {
+    return (sched_setscheduler(pid, (sched_policy_t)policy, rt_priority));
+}
+extern int syscall_sched_getscheduler(pid_t pid) {
+    return (sched_getscheduler(pid));
+}
+
 syscall_t __syscall[SYSCALL_SIZE];
 
 int64_t syscall(int64_t number, ...) {
@@ -71,35 +86,28 @@ static void __add_syscall(uint32_t id, const char *name, sysfn_t *fn) {
     printk("\t\t\t   - Syscall " _YELLOW "[%d]" _END " - " _GREEN "%s" _END "\n", id, name);
 }
 
+/**
+ * @brief int 0x80 handler
+ * @note : Reached through isr128 and fault_handler(), arguments are taken
+ *         from EBX, ECX, EDX, ESI and EDI, the result goes back in EAX.
+ */
 static void __syscall_handler(struct regs *r) {
-    printk("Syscall %d Received\n", r->eax);
-    assert(r->eax < SYSCALL_SIZE);
-
-    uint32_t id = r->eax;
-
-    // Update current process
-
-    uint32_t ret;
-
-    __asm__ volatile(
-        "push %1\n"
-        "push %2\n"
-        "push %3\n"
-        "push %4\n"
-        "push %5\n"
-        "push %6\n"
-        "call *%6\n"
-        "pop %%ebx\n"
-        "pop %%ebx\n"
-        "pop %%ebx\n"
-        "pop %%ebx\n"
-        "pop %%ebx\n"
-        : "=a"(ret)
-        : "r"(r->edi), "r"(r->esi), "r"(r->edx), "r"(r->ecx), "r"(r->ebx), "r"(id));
-
-    // todo: update current process
-    // r = current_process->regs;
-    r->eax = ret;
+    bool from_user = (r->cs & 0x3) == 0x3;
+    syscall_fn_t fn;
+
+    if (r->eax >= SYSCALL_SIZE || !(fn = (syscall_fn_t)__syscall[r->eax].function)) {
+        r->eax = (uint32_t)-1;
+        return;
+    }
+    /* Time spent in the syscall is system time */
+    if (from_user)
+        cpu_acct_syscall_enter(get_current_task());
+    r->eax = (uint32_t)fn(r->ebx, r->ecx, r->edx, r->esi, r->edi);
+    if (from_user)
+        cpu_acct_syscall_exit(get_current_task());
+
+    /* The syscall may have woken a task that must run first */
+    sched_resched_point();
 }
 
 void init_syscall(void) {
@@ -112,8 +120,13 @@ void init_syscall(void) {
     __add_syscall(SYSCALL_WRITE, "write", syscall_write);
     __add_syscall(SYSCALL_FORK, "fork", syscall_fork);
     __add_syscall(SYSCALL_WAIT, "wait", syscall_wait);
+    __add_syscall(SYSCALL_WAITPID, "waitpid", syscall_waitpid);
     __add_syscall(SYSCALL_KILL, "kill", syscall_kill);
     __add_syscall(SYSCALL_GETUID, "getuid", getuid);
+    __add_syscall(SYSCALL_SCHED_SETSCHEDULER, "sched_setscheduler", syscall_sched_setscheduler);
+    __add_syscall(SYSCALL_SCHED_GETSCHEDULER, "sched_getscheduler", syscall_sched_getscheduler);
+    __add_syscall(SYSCALL_FUTEX, "futex", syscall_futex);
 
-    idt_set_gate(0x80, (uint32_t)__syscall_handler, IDT_SELECTOR, IDT_FLAG_GATE);
+    isr_register_interrupt_handler(0x80, __syscall_handler);
+    idt_set_gate(0x80, (uint32_t)isr128, IDT_SELECTOR, IDT_FLAG_USER_GATE);
 }
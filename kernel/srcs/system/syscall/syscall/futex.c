@@ -0,0 +1,203 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   futex.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:59:23 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:23:18 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <memory/paging.h>
+#include <multitasking/wait_queue.h>
+#include <syscall/futex.h>
+#include <system/percpu.h>
+
+/*
+** Futex buckets
+**
+** - The key of a futex is the physical address of its word
+** - Waiters are hashed on the key into FUTEX_HASH_SIZE buckets, each
+**   bucket keeps the list of its waiters (task->futex_*) and a wait queue
+**   they sleep on
+** - The value check of FUTEX_WAIT and the queueing happen under the bucket
+**   lock, FUTEX_WAKE dequeues under the same lock: no wake up is lost
+** - A dequeued waiter keeps its key with FUTEX_KEY_WAKING set until the
+**   waker is done with it, it only leaves futex_wait() once the key is 0
+*/
+
+#define FUTEX_KEY_WAKING 0x1 // Keys are word aligned, bit 0 is free
+
+typedef struct s_futex_bucket {
+    spinlock_t lock;
+    task_t *head, *tail; // Waiters, linked by task->futex_next
+    wait_queue_t wq;     // Where the waiters sleep
+} futex_bucket_t;
+
+static futex_bucket_t futex_buckets[FUTEX_HASH_SIZE];
+
+static futex_bucket_t *__futex_bucket(uint32_t key) {
+    /* Words are 4-byte aligned: drop the low bits, mix the page bits in */
+    return (&futex_buckets[((key >> 2) ^ (key >> 12)) & (FUTEX_HASH_SIZE - 1)]);
+}
+
+/**
+ * @brief Physical address of a futex word in the current address space
+ * @return 0 if the word is misaligned or not mapped
+ */
+static uint32_t __futex_key(uint32_t *uaddr) {
+    task_t *task = get_current_task();
+    page_directory_t *dir = task && task->active_directory ? task->active_directory : current_directory;
+
+    if (!uaddr || ((uint32_t)uaddr & 0x3))
+        return (0);
+    return ((uint32_t)get_physical_address(dir, uaddr));
+}
+
+static void __futex_link(futex_bucket_t *bucket, task_t *task, uint32_t key) {
+    task->futex_key = key;
+    task->futex_next = NULL;
+    task->futex_prev = bucket->tail;
+    if (bucket->tail)
+        bucket->tail->futex_next = task;
+    else
+        bucket->head = task;
+    bucket->tail = task;
+}
+
+/* Leaves task->futex_key to the caller */
+static void __futex_unlink(futex_bucket_t *bucket, task_t *task) {
+    if (task->futex_prev)
+        task->futex_prev->futex_next = task->futex_next;
+    else
+        bucket->head = task->futex_next;
+    if (task->futex_next)
+        task->futex_next->futex_prev = task->futex_prev;
+    else
+        bucket->tail = task->futex_prev;
+    task->futex_next = task->futex_prev = NULL;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   FUTEX WAIT                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Sleep while *uaddr == val, at most 'timeout_ms' (0: no timeout)
+ * @return 0 once woken, -1 if the value changed or uaddr is invalid,
+ *         FUTEX_ETIMEDOUT if the timeout expired first
+ */
+int futex_wait_timeout(uint32_t *uaddr, uint32_t val, uint32_t timeout_ms) {
+    task_t *task = get_current_task();
+    uint32_t key = __futex_key(uaddr);
+    uint32_t deadline = timeout_ms ? wait_queue_deadline(timeout_ms) : 0;
+    futex_bucket_t *bucket;
+    bool timed_out = false;
+    uint32_t eflags;
+
+    if (!key || !task)
+        return (-1);
+
+    bucket = __futex_bucket(key);
+    eflags = spinlock_acquire_irqsave(&bucket->lock);
+    if (*(volatile uint32_t *)uaddr != val) {
+        spinlock_release_irqrestore(&bucket->lock, eflags);
+        return (-1);
+    }
+    __futex_link(bucket, task, key);
+    spinlock_release_irqrestore(&bucket->lock, eflags);
+
+    /* futex_wake() clears futex_key before waking us */
+    wait_event_idle_deadline(&bucket->wq, task->futex_key == 0, deadline);
+    if (task->futex_key) {
+        eflags = spinlock_acquire_irqsave(&bucket->lock);
+        /* Timed out, unless a waker dequeued us meanwhile: the wake up counts */
+        if (!(task->futex_key & FUTEX_KEY_WAKING)) {
+            __futex_unlink(bucket, task);
+            task->futex_key = 0;
+            timed_out = true;
+        }
+        spinlock_release_irqrestore(&bucket->lock, eflags);
+        wait_event_idle(&bucket->wq, task->futex_key == 0);
+    }
+    return (timed_out ? FUTEX_ETIMEDOUT : 0);
+}
+
+int futex_wait(uint32_t *uaddr, uint32_t val) {
+    return (futex_wait_timeout(uaddr, val, 0));
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   FUTEX WAKE                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Wake up to 'nr' tasks waiting on uaddr, oldest first
+ * @return Number of tasks woken, -1 if uaddr is invalid
+ */
+int futex_wake(uint32_t *uaddr, uint32_t nr) {
+    uint32_t key = __futex_key(uaddr);
+    futex_bucket_t *bucket;
+    task_t *woken = NULL;
+    task_t *task, *next;
+    uint32_t eflags;
+    int count = 0;
+
+    if (!key)
+        return (-1);
+
+    bucket = __futex_bucket(key);
+    eflags = spinlock_acquire_irqsave(&bucket->lock);
+    for (task = bucket->head; task && (uint32_t)count < nr; task = next) {
+        next = task->futex_next;
+        if (task->futex_key != key)
+            continue;
+        __futex_unlink(bucket, task);
+        /* Off the bucket: futex_next now chains the tasks to wake */
+        task->futex_key = key | FUTEX_KEY_WAKING;
+        task->futex_next = woken;
+        woken = task;
+        count++;
+    }
+    spinlock_release_irqrestore(&bucket->lock, eflags);
+
+    for (task = woken; task; task = next) {
+        next = task->futex_next;
+        task->futex_next = NULL;
+        /* From here the waiter may return and wait again */
+        task->futex_key = 0;
+        wake_up_task(&bucket->wq, task);
+    }
+    return (count);
+}
+
+/**
+ * @brief Drop a freed task from its futex bucket
+ */
+void futex_remove_task(task_t *task) {
+    futex_bucket_t *bucket;
+    uint32_t eflags;
+
+    if (!task->futex_key || (task->futex_key & FUTEX_KEY_WAKING))
+        return;
+    bucket = __futex_bucket(task->futex_key);
+    eflags = spinlock_acquire_irqsave(&bucket->lock);
+    if (task->futex_key && !(task->futex_key & FUTEX_KEY_WAKING)) {
+        __futex_unlink(bucket, task);
+        task->futex_key = 0;
+    }
+    spinlock_release_irqrestore(&bucket->lock, eflags);
+}
+
+int futex(uint32_t *uaddr, int op, uint32_t val, uint32_t timeout_ms) {
+    switch (op) {
+    case FUTEX_WAIT:
+        return (futex_wait_timeout(uaddr, val, timeout_ms));
+    case FUTEX_WAKE:
+        return (futex_wake(uaddr, val));
+    default:
+        return (-1);
+    }
+}
@@ -2,66 +2,63 @@
 
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/19 11:35:32 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/19 11:51:03 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 03:46:32 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <multitasking/process.h>
 #include <system/mutex.h>
 
-static void __add_task_to_wait_queue(task_t **wait_queue, task_t *task) {
-    task_t *tmp = *wait_queue;
-    if (!tmp) {
-        *wait_queue = task;
-        return;
-    }
-    while (tmp->next) {
-        tmp = tmp->next;
-    }
-    tmp->next = task;
+void init_mutex(mutex_t *mutex) {
+    *mutex = (mutex_t)MUTEX_INIT;
 }
 
-static task_t *__remove_task_from_wait_queue(task_t **wait_queue) {
-    task_t *tmp = *wait_queue;
-    if (!tmp) {
-        return NULL;
-    }
-    *wait_queue = tmp->next;
-    tmp->next = NULL;
-    return tmp;
-}
+/**
+ * @brief Take the mutex if it is free
+ * @return true if the current task now owns it
+ * @note : Mutexes sleep, interrupt handlers never use them: mutex->lock only
+ *         disables preemption.
+ */
+bool try_acquire_mutex(mutex_t *mutex) {
+    bool acquired = false;
 
-void init_mutex(mutex_t *mutex) {
-    mutex->state = MUTEX_UNLOCKED;
-    mutex->owner = 0;
-    mutex->wait_queue = NULL;
+    spinlock_acquire(&mutex->lock);
+    if (mutex->state == MUTEX_UNLOCKED) {
+        mutex->state = MUTEX_LOCKED;
+        mutex->owner = get_current_task();
+        acquired = true;
+    }
+    spinlock_release(&mutex->lock);
+    return (acquired);
 }
 
+/**
+ * @brief Take the mutex, blocking while another task owns it
+ */
 void acquire_mutex(mutex_t *mutex) {
-    ASM_CLI();
-    if (mutex->state) {
-        if (get_current_task() && (mutex->owner != get_current_task()->owner)) {
-            lock_task(get_current_task());
-            __add_task_to_wait_queue(&mutex->wait_queue, get_current_task());
-        }
-    } else {
-        mutex->state = MUTEX_LOCKED;
-        mutex->owner = get_current_task()->owner;
-    }
-    ASM_STI();
+    task_t *task = get_current_task();
+
+    if (task && mutex->owner == task)
+        __WARN_NO_RETURN("acquire_mutex : mutex already owned by [%d]", task->pid);
+
+    wait_event(&mutex->waiters, try_acquire_mutex(mutex));
 }
 
+/**
+ * @brief Release the mutex and wake the next waiter
+ * @note : The woken task takes the mutex itself, another task may get it
+ *         first and the woken one goes back to sleep.
+ */
 void release_mutex(mutex_t *mutex) {
-    ASM_CLI();
-    if (mutex->state && mutex->owner == get_current_task()->owner) {
-        mutex->state = MUTEX_UNLOCKED;
-        mutex->owner = 0;
-        if (mutex->wait_queue) {
-            task_t *next_task = __remove_task_from_wait_queue(&mutex->wait_queue);
-            mutex->state = MUTEX_LOCKED;
-            mutex->owner = next_task->owner;
-            unlock_task(next_task);
-        }
+    spinlock_acquire(&mutex->lock);
+
+    if (mutex->state == MUTEX_UNLOCKED || mutex->owner != get_current_task()) {
+        spinlock_release(&mutex->lock);
+        __WARN_NO_RETURN("release_mutex : mutex not owned by the current task");
     }
-    ASM_STI();
-}
\ No newline at end of file
+    mutex->state = MUTEX_UNLOCKED;
+    mutex->owner = NULL;
+    spinlock_release(&mutex->lock);
+
+    wake_up_one(&mutex->waiters);
+}
@@ -0,0 +1,274 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pi_mutex.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:01:47 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:15:35 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <asm/div64.h>
+#include <multitasking/scheduler.h>
+#include <system/clocksource.h>
+#include <system/percpu.h>
+#include <system/pi_mutex.h>
+
+/*
+** pi_lock serializes ownership changes and priority bookkeeping of every PI
+** mutex: boosts walk owner chains across mutexes.
+** Lock order: pi_lock, then wait queue locks. pi_lock is only taken in
+** process context, it disables preemption but not interrupts.
+** Statistics are only written by the owner of the mutex.
+*/
+
+static spinlock_t pi_lock = SPINLOCK_INIT;
+
+static spinlock_t pi_list_lock = SPINLOCK_INIT;
+static pi_mutex_t *pi_list = NULL;
+
+void pi_mutex_init(pi_mutex_t *mutex, const char *name) {
+    uint32_t eflags;
+
+    memset(mutex, 0, sizeof(pi_mutex_t));
+    wait_queue_init(&mutex->waiters);
+    mutex->name = name ? name : "pi_mutex";
+
+    eflags = spinlock_acquire_irqsave(&pi_list_lock);
+    mutex->list_next = pi_list;
+    pi_list = mutex;
+    spinlock_release_irqrestore(&pi_list_lock, eflags);
+}
+
+void pi_mutex_destroy(pi_mutex_t *mutex) {
+    uint32_t eflags = spinlock_acquire_irqsave(&pi_list_lock);
+
+    for (pi_mutex_t **tmp = &pi_list; *tmp; tmp = &(*tmp)->list_next) {
+        if (*tmp == mutex) {
+            *tmp = mutex->list_next;
+            break;
+        }
+    }
+    spinlock_release_irqrestore(&pi_list_lock, eflags);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                              PRIORITY INHERITANCE                              ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Lend what 'waiter' is scheduled at to the owners of 'mutex' (and
+ *        of the mutexes they sleep on)
+ * @note : pi_lock held. An RT waiter moves the owners to the RT class at
+ *         its level, a fair one raises their fair priority (see
+ *         sched_set_pi_boost()).
+ */
+static void __pi_boost_chain(pi_mutex_t *mutex, task_t *waiter) {
+    task_priority_t prio = waiter->priority;
+    uint32_t rt_prio = task_rt_prio(waiter);
+
+    for (uint32_t depth = 0; mutex && mutex->owner && depth < PI_MUTEX_CHAIN_MAX; depth++) {
+        task_t *owner = mutex->owner;
+
+        /* Already as high: its own waits boosted the rest of the chain */
+        if (task_base_priority(owner) >= prio && task_rt_prio(owner) >= rt_prio)
+            break;
+        sched_set_pi_boost(owner, owner->pi_boost > prio ? owner->pi_boost : prio,
+                           owner->pi_rt_priority > rt_prio ? owner->pi_rt_priority : rt_prio);
+        mutex->stats.boosts++;
+        mutex = owner->pi_blocked_on;
+    }
+}
+
+/**
+ * @brief Drop what 'task' inherited, keeping the boost of the mutexes it still holds
+ * @note : pi_lock held. Leaves the RT class if no RT waiter is left.
+ */
+static void __pi_restore_priority(task_t *task) {
+    int32_t boost = TASK_PRIORITY_LOW;
+    uint32_t rt_boost = 0;
+
+    for (pi_mutex_t *held = task->pi_held; held; held = held->held_next) {
+        int32_t prio = wait_queue_max_priority(&held->waiters);
+        uint32_t rt_prio = wait_queue_max_rt_priority(&held->waiters);
+
+        if (prio > boost)
+            boost = prio;
+        if (rt_prio > rt_boost)
+            rt_boost = rt_prio;
+    }
+    sched_set_pi_boost(task, (task_priority_t)boost, rt_boost);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  LOCK / UNLOCK                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Make 'task' the owner
+ * @note : pi_lock held. Waiters still queued lend their priority to the new
+ *         owner at once, new waiters boost it themselves.
+ */
+static void __pi_mutex_take(pi_mutex_t *mutex, task_t *task) {
+    mutex->locked = true;
+    mutex->owner = task;
+    mutex->locked_at = ktime_get();
+    mutex->stats.acquisitions++;
+    if (task) {
+        mutex->held_next = task->pi_held;
+        task->pi_held = mutex;
+        if (mutex->waiters.nr_waiters)
+            __pi_restore_priority(task);
+    }
+}
+
+bool pi_mutex_trylock(pi_mutex_t *mutex) {
+    spinlock_acquire(&pi_lock);
+    bool acquired = !mutex->locked;
+
+    if (acquired)
+        __pi_mutex_take(mutex, get_current_task());
+    spinlock_release(&pi_lock);
+    return (acquired);
+}
+
+/**
+ * @brief wait_event() condition: take the mutex, or boost its owner
+ * @note : Evaluated again once the task is queued, the boost then stays
+ *         until the owner releases.
+ */
+static bool __pi_mutex_try_or_boost(pi_mutex_t *mutex, task_t *task) {
+    spinlock_acquire(&pi_lock);
+    bool acquired = !mutex->locked;
+
+    if (acquired)
+        __pi_mutex_take(mutex, task);
+    else
+        __pi_boost_chain(mutex, task);
+    spinlock_release(&pi_lock);
+    return (acquired);
+}
+
+/**
+ * @brief Spin while the owner runs on another CPU
+ * @return true if the mutex was taken while spinning
+ */
+static bool __pi_mutex_spin(pi_mutex_t *mutex) {
+    if (cpu_count < 2)
+        return (false);
+
+    for (uint32_t i = 0; i < PI_MUTEX_SPIN_LOOPS; i++) {
+        task_t *owner = mutex->owner;
+
+        /* Owner preempted or asleep: it will not release soon */
+        if (mutex->locked && owner && !owner->on_cpu)
+            return (false);
+        if (!mutex->locked && pi_mutex_trylock(mutex))
+            return (true);
+        __asm__ volatile("pause");
+    }
+    return (false);
+}
+
+void pi_mutex_lock(pi_mutex_t *mutex) {
+    task_t *task = get_current_task();
+    uint64_t start, waited;
+
+    if (pi_mutex_trylock(mutex))
+        return;
+
+    if (task && mutex->owner == task)
+        __WARN_NO_RETURN("pi_mutex_lock : %s already owned by [%d]", mutex->name, task->pid);
+
+    start = ktime_get();
+    if (__pi_mutex_spin(mutex)) {
+        mutex->stats.spin_acquired++;
+    } else if (!task) {
+        /* Before tasking: nothing to boost nor to sleep on */
+        while (!pi_mutex_trylock(mutex))
+            __asm__ volatile("pause");
+    } else {
+        task->pi_blocked_on = mutex;
+        wait_event(&mutex->waiters, __pi_mutex_try_or_boost(mutex, task));
+        task->pi_blocked_on = NULL;
+        mutex->stats.sleeps++;
+    }
+
+    /* We own the mutex: the statistics are ours */
+    waited = ktime_get() - start;
+    mutex->stats.contended++;
+    mutex->stats.wait_total_ns += waited;
+    if (waited > mutex->stats.wait_max_ns)
+        mutex->stats.wait_max_ns = waited;
+}
+
+void pi_mutex_unlock(pi_mutex_t *mutex) {
+    task_t *task = get_current_task();
+    spinlock_acquire(&pi_lock);
+    uint64_t held;
+
+    if (!mutex->locked || mutex->owner != task) {
+        spinlock_release(&pi_lock);
+        __WARN_NO_RETURN("pi_mutex_unlock : %s not owned by the current task", mutex->name);
+    }
+
+    held = ktime_get() - mutex->locked_at;
+    mutex->stats.hold_total_ns += held;
+    if (held > mutex->stats.hold_max_ns)
+        mutex->stats.hold_max_ns = held;
+
+    if (task) {
+        for (pi_mutex_t **tmp = &task->pi_held; *tmp; tmp = &(*tmp)->held_next) {
+            if (*tmp == mutex) {
+                *tmp = mutex->held_next;
+                break;
+            }
+        }
+        __pi_restore_priority(task);
+    }
+    mutex->held_next = NULL;
+    mutex->owner = NULL;
+    mutex->locked = false;
+    spinlock_release(&pi_lock);
+
+    wake_up_highest(&mutex->waiters);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                   STATISTICS                                   ||
+// ! ||--------------------------------------------------------------------------------||
+
+void pi_mutex_get_stats(pi_mutex_t *mutex, pi_mutex_stats_t *stats) {
+    spinlock_acquire(&pi_lock);
+
+    *stats = mutex->stats;
+    spinlock_release(&pi_lock);
+}
+
+static uint32_t __ns_to_us(uint64_t ns) {
+    return ((uint32_t)div_u64(ns, 1000));
+}
+
+/**
+ * @brief Print the statistics of every PI mutex (lockstat)
+ */
+void pi_mutex_print_stats(void) {
+    uint32_t eflags = spinlock_acquire_irqsave(&pi_list_lock);
+
+    if (!pi_list)
+        printk("No PI mutex registered\n");
+    for (pi_mutex_t *mutex = pi_list; mutex; mutex = mutex->list_next) {
+        pi_mutex_stats_t *st = &mutex->stats;
+        uint32_t hold_avg = st->acquisitions ? __ns_to_us(div_u64(st->hold_total_ns, st->acquisitions)) : 0;
+        uint32_t wait_avg = st->contended ? __ns_to_us(div_u64(st->wait_total_ns, st->contended)) : 0;
+
+        printk(_GREEN "%s" _END ": acquired " _YELLOW "%u" _END ", contended " _YELLOW "%u" _END
+                      " (spin %u, sleep %u), boosts " _YELLOW "%u" _END "\n",
+               mutex->name, st->acquisitions, st->contended, st->spin_acquired, st->sleeps, st->boosts);
+        printk("\t- hold: avg %u us, max %u us | wait: avg %u us, max %u us\n", hold_avg,
+               __ns_to_us(st->hold_max_ns), wait_avg, __ns_to_us(st->wait_max_ns));
+    }
+    spinlock_release_irqrestore(&pi_list_lock, eflags);
+}
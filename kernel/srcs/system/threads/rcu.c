@@ -0,0 +1,236 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   rcu.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 03:09:28 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 03:46:31 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <memory/memory.h>
+#include <multitasking/scheduler.h>
+#include <multitasking/wait_queue.h>
+
+#include <system/rcu.h>
+#include <system/spinlock.h>
+
+#include <asm/asm.h>
+
+/*
+** Callbacks move through three lists:
+**   next : queued by call_rcu(), wait for the next grace period to start
+**   wait : queued before the current grace period started
+**   done : their grace period is over, run by the next CPU to schedule()
+**
+** A single grace period runs at a time. 'qs_mask' holds the online CPUs
+** that did not go through schedule() since it started, the last one to
+** clear its bit ends it.
+*/
+
+typedef struct s_rcu_list {
+    rcu_head_t *head;
+    rcu_head_t **tail;
+} rcu_list_t;
+
+static struct {
+    spinlock_t lock;
+    rcu_list_t next;
+    rcu_list_t wait;
+    rcu_list_t done;
+    volatile uint32_t qs_mask;
+    bool gp_active;
+} rcu_state = {
+    .lock = SPINLOCK_INIT,
+    .next = {NULL, &rcu_state.next.head},
+    .wait = {NULL, &rcu_state.wait.head},
+    .done = {NULL, &rcu_state.done.head},
+    .qs_mask = 0,
+    .gp_active = false};
+
+rcu_stats_t rcu_stats = {0, 0, 0, 0};
+
+/* Tasks in synchronize_rcu() */
+static wait_queue_t rcu_sync_wq = WAIT_QUEUE_INIT;
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                  GRACE PERIODS                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+static void __rcu_list_splice(rcu_list_t *dst, rcu_list_t *src) {
+    if (!src->head)
+        return;
+    *dst->tail = src->head;
+    dst->tail = src->tail;
+    src->head = NULL;
+    src->tail = &src->head;
+}
+
+static uint32_t __rcu_online_mask(void) {
+    uint32_t mask = 0;
+
+    for (uint32_t i = 0; i < cpu_count; i++) {
+        if (cpus[i].online)
+            mask |= (1U << i);
+    }
+    return (mask);
+}
+
+/**
+ * @brief Start a grace period for the queued callbacks (rcu_state.lock held)
+ */
+static void __rcu_gp_start(void) {
+    if (rcu_state.gp_active || !rcu_state.next.head)
+        return;
+    __rcu_list_splice(&rcu_state.wait, &rcu_state.next);
+    rcu_state.qs_mask = __rcu_online_mask();
+    rcu_state.gp_active = true;
+    rcu_stats.gp_started++;
+}
+
+/**
+ * @brief End the grace period, start the next one if callbacks are queued
+ */
+static void __rcu_gp_end(void) {
+    __rcu_list_splice(&rcu_state.done, &rcu_state.wait);
+    rcu_state.gp_active = false;
+    rcu_stats.gp_completed++;
+    __rcu_gp_start();
+}
+
+/**
+ * @brief Run the callbacks whose grace period is over
+ * @note : Runs with interrupts disabled, from schedule(): callbacks must
+ *         not sleep.
+ */
+static void __rcu_invoke_callbacks(void) {
+    rcu_head_t *head;
+    uint32_t count = 0;
+
+    spinlock_acquire(&rcu_state.lock);
+    head = rcu_state.done.head;
+    rcu_state.done.head = NULL;
+    rcu_state.done.tail = &rcu_state.done.head;
+    spinlock_release(&rcu_state.lock);
+
+    while (head) {
+        rcu_head_t *next = head->next;
+
+        head->func(head);
+        head = next;
+        count++;
+    }
+
+    spinlock_acquire(&rcu_state.lock);
+    rcu_stats.callbacks += count;
+    rcu_stats.pending -= count;
+    spinlock_release(&rcu_state.lock);
+}
+
+/**
+ * @brief Quiescent state of 'cpu': called by schedule() outside read sections
+ * @note : Interrupts are disabled.
+ */
+void rcu_note_context_switch(cpu_t *cpu) {
+    uint32_t bit = 1U << cpu->id;
+
+    if (rcu_state.qs_mask & bit) {
+        spinlock_acquire(&rcu_state.lock);
+        if (rcu_state.qs_mask & bit) {
+            rcu_state.qs_mask &= ~bit;
+            if (!rcu_state.qs_mask)
+                __rcu_gp_end();
+        }
+        spinlock_release(&rcu_state.lock);
+    }
+    if (rcu_state.done.head)
+        __rcu_invoke_callbacks();
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                 INTERFACE FUNCTIONS                            ||
+// ! ||--------------------------------------------------------------------------------||
+
+/**
+ * @brief Run 'func(head)' once every current reader is done
+ * @note : Callable from read sections and with interrupts disabled.
+ */
+void call_rcu(rcu_head_t *head, void (*func)(rcu_head_t *head)) {
+    uint32_t eflags;
+
+    head->func = func;
+    head->next = NULL;
+
+    eflags = spinlock_acquire_irqsave(&rcu_state.lock);
+    *rcu_state.next.tail = head;
+    rcu_state.next.tail = &head->next;
+    rcu_stats.pending++;
+    __rcu_gp_start();
+    spinlock_release_irqrestore(&rcu_state.lock, eflags);
+}
+
+typedef struct s_rcu_sync {
+    rcu_head_t head;
+    volatile bool done;
+} rcu_sync_t;
+
+static void __rcu_sync_callback(rcu_head_t *head) {
+    rcu_entry(head, rcu_sync_t, head)->done = true;
+    wake_up_all(&rcu_sync_wq);
+}
+
+/**
+ * @brief Wait for a full grace period
+ * @note : Sleeps, never call it from a read section. The waiter is on the
+ *         heap: process stacks are private to their page directory and the
+ *         callback may run from any task.
+ *         With a single CPU online, the caller itself is the quiescent
+ *         state: readers cannot be preempted, none can be in progress.
+ */
+void synchronize_rcu(void) {
+    rcu_sync_t *sync;
+
+    if (!scheduler_initialized || __rcu_online_mask() == (1U << this_cpu()->id))
+        return;
+
+    if (!(sync = kmalloc(sizeof(rcu_sync_t))))
+        __THROW_NO_RETURN("synchronize_rcu : kmalloc failed");
+
+    sync->done = false;
+    call_rcu(&sync->head, &__rcu_sync_callback);
+    wait_event(&rcu_sync_wq, sync->done);
+    kfree(sync);
+}
+
+typedef struct s_rcu_kfree {
+    rcu_head_t head;
+    void *ptr;
+} rcu_kfree_t;
+
+static void __rcu_kfree_callback(rcu_head_t *head) {
+    rcu_kfree_t *node = rcu_entry(head, rcu_kfree_t, head);
+
+    kfree(node->ptr);
+    kfree(node);
+}
+
+/**
+ * @brief kfree() 'ptr' after a grace period
+ * @note : For objects with no rcu_head_t of their own. Falls back to a
+ *         synchronous wait if the tracking node cannot be allocated.
+ */
+void kfree_rcu(void *ptr) {
+    rcu_kfree_t *node;
+
+    if (!ptr)
+        return;
+    if (!(node = kmalloc(sizeof(rcu_kfree_t)))) {
+        synchronize_rcu();
+        kfree(ptr);
+        return;
+    }
+    node->ptr = ptr;
+    call_rcu(&node->head, &__rcu_kfree_callback);
+}
@@ -6,63 +6,85 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/07/19 12:07:06 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/19 13:25:51 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:55:02 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <system/semaphore.h>
 
-void semaphore_down(semaphore_t *semaphore) {
-    ASM_CLI(); // Start of critical section
-    while (semaphore->value <= 0) {
-        // This is a simple busy-wait loop, which is not efficient.
-        // In a real system, you would want to block the task and switch to another one.
-    }
-    semaphore->value--;
-    ASM_STI(); // End of critical section
-}
+/**
+ * @brief Initialise a semaphore
+ * @note : pshared is ignored, kernel memory is shared by every task.
+ */
+int sem_init(semaphore_t *semaphore, int pshared, unsigned int value) {
+    __UNUSED(pshared);
 
-void semaphore_up(semaphore_t *semaphore) {
-    ASM_CLI(); // Start of critical section
-    semaphore->value++;
-    // If there are tasks waiting on this semaphore, wake one of them up.
-    if (semaphore->wait_queue) {
-        // Remove a task from the wait queue and wake it up.
-        // You would need to add code here to manage the wait queue.
-    }
-    ASM_STI(); // End of critical section
+    if (!semaphore || value > SEM_VALUE_MAX)
+        return (-1);
+    *semaphore = (semaphore_t)SEMAPHORE_INIT((int32_t)value);
+    return (0);
 }
 
-int sem_init(semaphore_t *semaphore, int pshared, unsigned int valeur) {
-    __UNUSED(pshared);
-    semaphore->value = valeur;
-    semaphore->wait_queue = NULL;
-    return 0;
-    
-}
+/**
+ * @brief Decrement the semaphore if its value is positive
+ * @return 0 on success, -1 if it would block
+ */
+int sem_trywait(semaphore_t *semaphore) {
+    int ret = -1;
+    uint32_t eflags = spinlock_acquire_irqsave(&semaphore->lock);
 
-int sem_wait(semaphore_t *semaphore) {
-    __UNUSED(semaphore);
-    return 0;
+    if (semaphore->value > 0) {
+        semaphore->value--;
+        ret = 0;
+    }
+    spinlock_release_irqrestore(&semaphore->lock, eflags);
+    return (ret);
 }
 
-int sem_trywait(semaphore_t *semaphore) {
-    __UNUSED(semaphore);
-    return 0;
+/**
+ * @brief Decrement the semaphore, blocking while its value is 0
+ */
+int sem_wait(semaphore_t *semaphore) {
+    if (!semaphore)
+        return (-1);
+    wait_event(&semaphore->waiters, sem_trywait(semaphore) == 0);
+    return (0);
 }
 
+/**
+ * @brief Increment the semaphore and wake one waiter
+ * @return 0 on success, -1 if the value would overflow
+ */
 int sem_post(semaphore_t *semaphore) {
-    __UNUSED(semaphore);
-    return 0;
+    uint32_t eflags;
+
+    if (!semaphore)
+        return (-1);
+    eflags = spinlock_acquire_irqsave(&semaphore->lock);
+    if (semaphore->value == SEM_VALUE_MAX) {
+        spinlock_release_irqrestore(&semaphore->lock, eflags);
+        return (-1);
+    }
+    semaphore->value++;
+    spinlock_release_irqrestore(&semaphore->lock, eflags);
+
+    wake_up_one(&semaphore->waiters);
+    return (0);
 }
 
 int sem_getvalue(semaphore_t *semaphore, int *sval) {
-    __UNUSED(semaphore);
-    __UNUSED(sval);
-    return 0;
+    if (!semaphore || !sval)
+        return (-1);
+    *sval = semaphore->value;
+    return (0);
 }
 
+/**
+ * @brief Destroy a semaphore
+ * @return -1 if tasks are still blocked on it
+ */
 int sem_destroy(semaphore_t *semaphore) {
-    __UNUSED(semaphore);
-    return 0;
-}
\ No newline at end of file
+    if (!semaphore || semaphore->waiters.nr_waiters)
+        return (-1);
+    return (0);
+}
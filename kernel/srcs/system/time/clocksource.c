@@ -0,0 +1,215 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   clocksource.c                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:20:53 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:32:50 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <system/clocksource.h>
+#include <system/cpu.h>
+#include <system/io.h>
+#include <system/pit.h>
+#include <system/seqlock.h>
+#include <system/time.h>
+
+#include <asm/asm.h>
+#include <asm/div64.h>
+
+clocksource_t clocksource = {
+    .type = CLOCKSOURCE_JIFFIES,
+    .tsc_khz = 0,
+    .mult = 0,
+    .shift = 0,
+    .tsc_base = 0,
+    .wall_base = 0};
+
+/* Serializes updates of 'clocksource', readers copy it lock-free */
+static seqlock_t clocksource_lock = SEQLOCK_INIT;
+
+/**
+ * @brief Consistent copy of the clocksource
+ * @note : The 64-bit bases cannot be read atomically on i386.
+ */
+static void __clocksource_read(clocksource_t *cs) {
+    uint32_t seq;
+
+    do {
+        seq = read_seqbegin(&clocksource_lock);
+        *cs = clocksource;
+    } while (read_seqretry(&clocksource_lock, seq));
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                                TSC CALIBRATION                                 ||
+// ! ||--------------------------------------------------------------------------------||
+
+static bool __tsc_available(void) {
+    uint32_t eax, ebx, ecx, edx;
+
+    __cpuid(0x00000001, eax, ebx, ecx, edx);
+    __UNUSED(eax);
+    __UNUSED(ebx);
+    __UNUSED(ecx);
+    return ((edx & CPUID_FEAT_EDX_TSC) != 0);
+}
+
+/**
+ * @brief Count TSC cycles during a CLOCKSOURCE_CALIBRATE_MS one-shot on PIT channel 2
+ * @note : Channel 2 is gated through port 0x61 and does not raise any IRQ,
+ *         so this works with interrupts disabled and leaves channel 0 alone.
+ * @return 0 if its output never went high (no gate, some hypervisors)
+ */
+static uint64_t __pit_calibrate_tsc(void) {
+    uint32_t latch = (__CHIPSET_FREQUENCY * CLOCKSOURCE_CALIBRATE_MS) / 1000;
+    uint32_t spins = CLOCKSOURCE_CALIBRATE_SPINS;
+    uint64_t start, end;
+
+    /* Gate high, speaker off */
+    outportb(PIT_CHANNEL_2_GATE, (inportb(PIT_CHANNEL_2_GATE) & ~PIT_GATE_SPEAKER) | PIT_GATE_CHANNEL_2);
+
+    /* Channel 2, lobyte/hibyte, mode 0 (interrupt on terminal count), binary */
+    outportb(PIT_CMDREG, PIT_CHANNEL_2 | PIT_ACCESS_LOHIBYTE | PIT_OPMODE_0_IOTC | PIT_BINARY);
+    outportb(PIT_CHANNEL_2_DATA, (uint8_t)(latch & PIT_MASK));
+    outportb(PIT_CHANNEL_2_DATA, (uint8_t)((latch >> 8) & PIT_MASK));
+
+    start = rdtsc();
+    while ((inportb(PIT_CHANNEL_2_GATE) & PIT_GATE_OUT_2) == 0)
+        if (!--spins)
+            return (0);
+    end = rdtsc();
+
+    return (end - start);
+}
+
+static void __clocksource_set_tsc(uint32_t khz) {
+    uint32_t shift = 32;
+    uint64_t mult;
+
+    /* Keep the highest precision that still fits mult in 32 bits */
+    do {
+        mult = div_u64((uint64_t)NSEC_PER_MSEC << shift, khz);
+    } while ((mult >> 32) && --shift);
+
+    clocksource.tsc_khz = khz;
+    clocksource.mult = (uint32_t)mult;
+    clocksource.shift = shift;
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                               INTERFACE FUNCTIONS                              ||
+// ! ||--------------------------------------------------------------------------------||
+
+uint64_t clocksource_cycles_to_ns(uint64_t cycles) {
+    clocksource_t cs;
+
+    __clocksource_read(&cs);
+    if (cs.type != CLOCKSOURCE_TSC)
+        return (0);
+    return (mul_u64_u32_shr(cycles, cs.mult, cs.shift));
+}
+
+uint64_t clocksource_ns_to_cycles(uint64_t ns) {
+    uint32_t rem;
+    uint64_t ms = div_u64_rem(ns, NSEC_PER_MSEC, &rem);
+
+    return (ms * clocksource.tsc_khz + div_u64((uint64_t)rem * clocksource.tsc_khz, NSEC_PER_MSEC));
+}
+
+uint32_t clocksource_get_tsc_khz(void) {
+    return (clocksource.tsc_khz);
+}
+
+static uint64_t __ktime_get(const clocksource_t *cs) {
+    if (cs->type == CLOCKSOURCE_TSC)
+        return (mul_u64_u32_shr(rdtsc() - cs->tsc_base, cs->mult, cs->shift));
+    return (timer_get_jiffies() * (NSEC_PER_SEC / TIMER_PHASE));
+}
+
+uint64_t ktime_get(void) {
+    clocksource_t cs;
+
+    __clocksource_read(&cs);
+    return (__ktime_get(&cs));
+}
+
+uint64_t ktime_get_real(void) {
+    clocksource_t cs;
+
+    __clocksource_read(&cs);
+    return (cs.wall_base + __ktime_get(&cs));
+}
+
+uint64_t sched_clock(void) {
+    return (clocksource.type == CLOCKSOURCE_TSC ? rdtsc() : ktime_get());
+}
+
+uint64_t sched_clock_to_ns(uint64_t delta) {
+    return (clocksource.type == CLOCKSOURCE_TSC ? clocksource_cycles_to_ns(delta) : delta);
+}
+
+/**
+ * @brief Busy wait for 'usec' microseconds
+ * @note : Usable with interrupts disabled. Without the TSC, only port 0x80
+ *         writes (about 1us each) are left to count on.
+ */
+void clocksource_udelay(uint32_t usec) {
+    if (clocksource.type == CLOCKSOURCE_TSC) {
+        uint64_t end = rdtsc() + clocksource_ns_to_cycles((uint64_t)usec * NSEC_PER_USEC);
+
+        while (rdtsc() < end)
+            __asm__ volatile("pause");
+    } else {
+        while (usec--)
+            outportb(0x80, 0x0);
+    }
+}
+
+/**
+ * @brief Calibrate the TSC and anchor the wall clock
+ * @note : The CMOS is read only once, here. Everything else derives
+ *         wall time from 'wall_base' + ktime_get().
+ */
+void clocksource_init(void) {
+    uint64_t best = 0;
+    uint32_t eflags;
+
+    eflags = write_seqlock_irqsave(&clocksource_lock);
+    clocksource.wall_base = startup_time * NSEC_PER_SEC;
+    write_sequnlock_irqrestore(&clocksource_lock, eflags);
+
+    if (!__tsc_available()) {
+        __WARND("TSC not available, falling back to PIT jiffies");
+        return;
+    }
+
+    GET_EFLAGS(eflags);
+    ASM_CLI();
+    for (uint32_t i = 0; i < CLOCKSOURCE_CALIBRATE_LOOPS; i++) {
+        uint64_t delta = __pit_calibrate_tsc();
+
+        if (delta == 0) {
+            best = 0;
+            break;
+        }
+        if (best == 0 || delta < best)
+            best = delta;
+    }
+    SET_EFLAGS(eflags);
+
+    if (best == 0 || (best >> 32)) {
+        __WARND("TSC calibration failed, falling back to PIT jiffies");
+        return;
+    }
+
+    /* Switch from jiffies to the TSC in one update */
+    eflags = write_seqlock_irqsave(&clocksource_lock);
+    __clocksource_set_tsc((uint32_t)best / CLOCKSOURCE_CALIBRATE_MS);
+    clocksource.tsc_base = rdtsc();
+    clocksource.type = CLOCKSOURCE_TSC;
+    write_sequnlock_irqrestore(&clocksource_lock, eflags);
+}
@@ -6,13 +6,16 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/12/11 12:48:58 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/07/20 18:03:48 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:21:49 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
+#include <system/clocksource.h>
 #include <system/cmos.h>
 #include <system/time.h>
 
+#include <asm/div64.h>
+
 uint64_t startup_time = 0;
 tm_t startup_tm;
 
@@ -78,10 +81,13 @@ uint64_t mkdifftime(uint64_t time1, uint64_t time2) {
     return (time1 - time2);
 }
 
+/**
+ * @brief Seconds since the epoch
+ * @note : Derived from the boot CMOS read and the clocksource, the CMOS
+ *         is not polled again (it can take up to a second to settle).
+ */
 uint64_t get_system_time(void) {
-    tm_t time = gettime();
-
-    return (mktime(&time));
+    return (div_u64(ktime_get_real(), NSEC_PER_SEC));
 }
 
 char *asctime(tm_t *time) {
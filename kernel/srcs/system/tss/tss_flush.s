@@ -1,9 +1,5 @@
 global tss_flush
 tss_flush:
-    mov eax, [esp + 4]
-    ltr [eax]
+    mov ax, [esp + 4]   ; Selector of the TSS descriptor
+    ltr ax
     ret
-
-    ; mov ax, 0x28 ; 0x28 is the TSS segment
-    ; ltr ax
-    ; ret
\ No newline at end of file
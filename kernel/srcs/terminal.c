@@ -6,11 +6,13 @@
 /*   By: vvaucoul <vvaucoul@student.42.Fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/06/22 13:31:34 by vvaucoul          #+#    #+#             */
-/*   Updated: 2022/11/20 14:02:41 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:20:30 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
 #include <terminal.h>
+#include <system/smp.h>
+#include <system/spinlock.h>
 
 size_t terminal_row;
 size_t terminal_column;
@@ -18,6 +20,29 @@ size_t terminal_screen;
 uint8_t terminal_color;
 uint16_t *terminal_buffer;
 
+/*
+** terminal_lock serializes the cursor and the VGA buffer between CPUs: two
+** CPUs moving the row at once can write past the end of the buffer.
+** Recursive and irqsave, so an interrupt or a fault report printing on the
+** CPU that holds it goes through. It is only taken once smp_early_init()
+** ran: before that, this_cpu() is not set up and only the BSP prints.
+*/
+static rspinlock_t terminal_lock = RSPINLOCK_INIT;
+
+static bool __terminal_lock(uint32_t *eflags)
+{
+    if (!smp_enabled)
+        return (false);
+    *eflags = rspinlock_acquire_irqsave(&terminal_lock);
+    return (true);
+}
+
+static void __terminal_unlock(bool locked, uint32_t eflags)
+{
+    if (locked)
+        rspinlock_release_irqrestore(&terminal_lock, eflags);
+}
+
 void terminal_initialize(void)
 {
     terminal_row = 0;
@@ -39,7 +64,7 @@ void terminal_setcolor(uint8_t color)
     terminal_color = color;
 }
 
-void terminal_putchar(char c)
+static void __terminal_putchar(char c)
 {
     if (c == CHAR_NEWLINE)
     {
@@ -74,10 +99,23 @@ void terminal_putchar(char c)
     }
 }
 
+void terminal_putchar(char c)
+{
+    uint32_t eflags = 0;
+    bool locked = __terminal_lock(&eflags);
+
+    __terminal_putchar(c);
+    __terminal_unlock(locked, eflags);
+}
+
 static void terminal_write(const char *data, size_t size)
 {
+    uint32_t eflags = 0;
+    bool locked = __terminal_lock(&eflags);
+
     for (size_t i = 0; i < size; i++)
-        terminal_putchar(data[i]);
+        __terminal_putchar(data[i]);
+    __terminal_unlock(locked, eflags);
 }
 
 void terminal_writestring(const char *data)
@@ -89,6 +127,8 @@ void terminal_writestring_location(const char *data, size_t x, size_t y)
 {
     size_t ux = x;
     size_t uy = y;
+    uint32_t eflags = 0;
+    bool locked = __terminal_lock(&eflags);
 
     for (size_t i = 0; i < strlen(data); i++)
     {
@@ -101,27 +141,38 @@ void terminal_writestring_location(const char *data, size_t x, size_t y)
                 uy = y;
         }
     }
+    __terminal_unlock(locked, eflags);
 }
 
 void update_cursor(int x, int y)
 {
     uint16_t pos = y * VGA_WIDTH + x;
+    uint32_t eflags = 0;
+    bool locked = __terminal_lock(&eflags);
 
+    /* Index / data register pairs: must not interleave with another CPU */
     outb(0x3D4, 0x0F);
     outb(0x3D5, (uint8_t)(pos & 0xFF));
     outb(0x3D4, 0x0E);
     outb(0x3D5, (uint8_t)((pos >> 8) & 0xFF));
+    __terminal_unlock(locked, eflags);
 }
 
 void terminal_write_n_char(char c, size_t count)
 {
+    uint32_t eflags = 0;
+    bool locked = __terminal_lock(&eflags);
+
     for (size_t i = 0; i < count; i++)
-        terminal_putchar(c);
+        __terminal_putchar(c);
+    __terminal_unlock(locked, eflags);
 }
 
 void terminal_move_offset_down(void)
 {
     size_t y = 0;
+    uint32_t eflags = 0;
+    bool locked = __terminal_lock(&eflags);
 
     for (; y < VGA_HEIGHT - 1; y++)
     {
@@ -132,4 +183,5 @@ void terminal_move_offset_down(void)
     }
     for (size_t x = 0; x < VGA_WIDTH; x++)
         TERMINAL_CHAR(x, y) = VGA_ENTRY(' ', terminal_color);
+    __terminal_unlock(locked, eflags);
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   workflow_cfs.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 04:25:50 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:35:56 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+#include <multitasking/scheduler.h>
+
+#include <system/clocksource.h>
+
+#include <workflows/workflows.h>
+
+#include <asm/div64.h>
+
+#define CFS_TEST_THREADS 3
+
+static const task_priority_t __cfs_priorities[CFS_TEST_THREADS] = {
+    TASK_PRIORITY_HIGH,
+    TASK_PRIORITY_MEDIUM,
+    TASK_PRIORITY_LOW,
+};
+static const char *__cfs_names[CFS_TEST_THREADS] = {"HIGH", "MEDIUM", "LOW"};
+
+static uint32_t __cfs_weights[CFS_TEST_THREADS]; // Weight the fair class gave each thread
+
+static void __cfs_setup(uint32_t id) {
+    task_set_priority(get_current_task()->pid, __cfs_priorities[id]);
+    __cfs_weights[id] = get_current_task()->se.weight;
+}
+
+/**
+ * @brief Three fair threads of different priorities bound to one CPU must
+ *        share it in proportion to their weights
+ */
+void cfs_test(void) {
+    uint64_t runtime[CFS_TEST_THREADS];
+    uint32_t total_weight = 0;
+    uint64_t total = 0;
+    bool ok = true;
+    int32_t cpu;
+
+    __WORKFLOW_HEADER();
+
+    for (uint32_t i = 0; i < CFS_TEST_THREADS; i++)
+        __cfs_weights[i] = 0;
+    if ((cpu = workflow_spin_window(CFS_TEST_THREADS, &__cfs_setup, runtime, "cfs-spinner")) < 0)
+        return;
+    for (uint32_t i = 0; i < CFS_TEST_THREADS; i++) {
+        total += runtime[i];
+        total_weight += __cfs_weights[i];
+    }
+    if (!total_weight)
+        __THROW_NO_RETURN("cfs_test : no weight recorded");
+
+    printk("\t- %u threads on CPU %u for %u ms\n", CFS_TEST_THREADS, cpu, WORKFLOW_SPIN_WINDOW_MS);
+    for (uint32_t i = 0; i < CFS_TEST_THREADS; i++) {
+        uint32_t expected = (uint32_t)div_u64((uint64_t)__cfs_weights[i] * 1000, total_weight);
+        uint32_t share = total ? (uint32_t)div_u64(runtime[i] * 1000, total) : 0;
+        uint32_t diff = share > expected ? share - expected : expected - share;
+
+        ok &= diff <= WORKFLOW_SPIN_TOLERANCE;
+        printk("\t- %s (weight %u): " _YELLOW "%u ms" _END ", share %u / 1000, expected %u / 1000\n", __cfs_names[i],
+               __cfs_weights[i], (uint32_t)div_u64(runtime[i], NSEC_PER_MSEC), share, expected);
+    }
+    if (ok)
+        printk("\t- " _GREEN "OK" _END ": CPU time follows the weights (within %u / 1000)\n", WORKFLOW_SPIN_TOLERANCE);
+    else
+        printk("\t- " _RED "FAILED" _END ": CPU time does not follow the weights\n");
+
+    __WORKFLOW_FOOTER();
+}
@@ -0,0 +1,134 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   workflow_context_switch.c                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 02:24:36 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:21:14 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/kthread.h>
+#include <multitasking/process.h>
+#include <multitasking/scheduler.h>
+
+#include <system/clocksource.h>
+#include <system/cpu.h>
+#include <system/percpu.h>
+
+#include <workflows/workflows.h>
+
+#include <asm/div64.h>
+
+#define CONTEXT_SWITCH_ROUNDS 0x2000
+
+typedef struct s_switch_result {
+    uint32_t switches;
+    uint32_t yield_cycles; // Per yield of the caller
+    uint32_t cr3_reloads;
+    uint32_t cr3_skipped;
+} switch_result_t;
+
+static volatile bool __partner_running = false;
+
+/* Forked task: its own copy of the caller's page directory */
+static void __forked_partner(void) {
+    while (__partner_running)
+        task_yield();
+    task_exit(0);
+}
+
+/* Kernel thread: no directory of its own, runs on kernel_directory */
+static int32_t __thread_partner(void *arg) {
+    __UNUSED(arg);
+    while (__partner_running)
+        task_yield();
+    return (0);
+}
+
+/**
+ * @brief Cost of a CR3 reload (full TLB flush), what a lazy switch saves
+ */
+static uint32_t __cr3_reload_cycles(void) {
+    uint32_t cr3;
+    uint64_t start, end;
+
+    __asm__ volatile("mov %%cr3, %0"
+                     : "=r"(cr3));
+    start = rdtsc();
+    for (uint32_t i = 0; i < CONTEXT_SWITCH_ROUNDS; i++)
+        __asm__ volatile("mov %0, %%cr3" ::"r"(cr3)
+                         : "memory");
+    end = rdtsc();
+    return ((uint32_t)div_u64(end - start, CONTEXT_SWITCH_ROUNDS));
+}
+
+/**
+ * @brief Ping-pong with the running partner: every yield is one context switch
+ * @note : Stops the partner once measured.
+ */
+static void __ping_pong(switch_result_t *result) {
+    sched_stats_t before, after;
+    uint64_t start, end;
+
+    before = sched_stats;
+    start = rdtsc();
+    for (uint32_t i = 0; i < CONTEXT_SWITCH_ROUNDS; i++)
+        task_yield();
+    end = rdtsc();
+    after = sched_stats;
+    __partner_running = false;
+
+    result->switches = after.switches - before.switches;
+    result->yield_cycles = (uint32_t)div_u64(end - start, CONTEXT_SWITCH_ROUNDS);
+    result->cr3_reloads = after.cr3_reloads - before.cr3_reloads;
+    result->cr3_skipped = after.cr3_skipped - before.cr3_skipped;
+}
+
+static void __print_result(const char *name, switch_result_t *result, uint32_t cr3_cycles) {
+    printk("\t- %s: " _GREEN "%u" _END " cycles per yield (%u ns), %u switches\n", name, result->yield_cycles,
+           (uint32_t)clocksource_cycles_to_ns(result->yield_cycles), result->switches);
+    printk("\t\t CR3 reloads: " _GREEN "%u" _END ", skipped: " _GREEN "%u" _END " (~%u cycles saved)\n",
+           result->cr3_reloads, result->cr3_skipped, result->cr3_skipped * cr3_cycles);
+}
+
+void context_switch_test(void) {
+    __WORKFLOW_HEADER();
+
+    switch_result_t shared = {0}, forked = {0};
+    uint32_t cr3_cycles;
+    kthread_t *thread;
+    pid_t pid;
+
+    cr3_cycles = __cr3_reload_cycles();
+
+    /* Same address space: the switch keeps CR3 */
+    __partner_running = true;
+    if (!(thread = kthread_create(&__thread_partner, NULL, "cs-partner"))) {
+        __partner_running = false;
+        __THROW_NO_RETURN("context_switch_test : kthread_create failed");
+    }
+    __ping_pong(&shared);
+    kthread_join(thread, NULL);
+
+    /* Forked address space: every switch reloads CR3 */
+    __partner_running = true;
+    if ((pid = init_task(__forked_partner)) < 0) {
+        __partner_running = false;
+        __THROW_NO_RETURN("context_switch_test : fork failed");
+    }
+    __ping_pong(&forked);
+    task_waitpid(pid, NULL, 0);
+
+    printk("\t- Yields: " _GREEN "%u" _END " per partner, %u CPUs\n", CONTEXT_SWITCH_ROUNDS, cpu_count);
+    printk("\t- CR3 reload: " _GREEN "%u" _END " cycles\n", cr3_cycles);
+    __print_result("Shared directory (kernel thread)", &shared, cr3_cycles);
+    __print_result("Forked directory (task_fork)", &forked, cr3_cycles);
+    if (shared.yield_cycles < forked.yield_cycles)
+        printk("\t- Sharing the directory saves " _GREEN "%u" _END " cycles per yield\n",
+               forked.yield_cycles - shared.yield_cycles);
+
+    __WORKFLOW_FOOTER();
+}
@@ -0,0 +1,75 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   workflow_fairshare.c                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 04:26:40 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:35:57 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+#include <multitasking/sched_group.h>
+#include <multitasking/scheduler.h>
+
+#include <system/clocksource.h>
+
+#include <workflows/workflows.h>
+
+#include <asm/div64.h>
+
+#define FAIRSHARE_TEST_UID_ONE 1001 // Runs one thread
+#define FAIRSHARE_TEST_UID_MANY 1002
+#define FAIRSHARE_TEST_MANY 3 // Threads of FAIRSHARE_TEST_UID_MANY
+#define FAIRSHARE_TEST_THREADS (1 + FAIRSHARE_TEST_MANY)
+
+/* Thread 0 runs as FAIRSHARE_TEST_UID_ONE, the others as FAIRSHARE_TEST_UID_MANY */
+static void __fs_setup(uint32_t id) {
+    set_task_uid(get_current_task(), id ? FAIRSHARE_TEST_UID_MANY : FAIRSHARE_TEST_UID_ONE);
+}
+
+/**
+ * @brief One uid running one thread and one running FAIRSHARE_TEST_MANY, at
+ *        equal shares on one CPU, must get half of it each
+ */
+void fairshare_test(void) {
+    uint64_t runtime[FAIRSHARE_TEST_THREADS];
+    sched_group_key_t key = sched_group_key;
+    uint64_t many = 0, total;
+    uint32_t one_share, many_share;
+    int32_t cpu;
+
+    __WORKFLOW_HEADER();
+
+    if (key != SCHED_GROUP_BY_UID)
+        sched_group_set_key(SCHED_GROUP_BY_UID);
+    if (sched_group_set_shares(FAIRSHARE_TEST_UID_ONE, SCHED_GROUP_SHARES_DEFAULT) ||
+        sched_group_set_shares(FAIRSHARE_TEST_UID_MANY, SCHED_GROUP_SHARES_DEFAULT))
+        __THROW_NO_RETURN("fairshare_test : sched_group_set_shares failed");
+
+    cpu = workflow_spin_window(FAIRSHARE_TEST_THREADS, &__fs_setup, runtime, "fs-spinner");
+    if (key != SCHED_GROUP_BY_UID)
+        sched_group_set_key(key);
+    if (cpu < 0)
+        return;
+    for (uint32_t i = 1; i < FAIRSHARE_TEST_THREADS; i++)
+        many += runtime[i];
+    if (!(total = runtime[0] + many))
+        __THROW_NO_RETURN("fairshare_test : no CPU time recorded");
+
+    one_share = (uint32_t)div_u64(runtime[0] * 1000, total);
+    many_share = 1000 - one_share;
+    printk("\t- Equal shares on CPU %u for %u ms\n", cpu, WORKFLOW_SPIN_WINDOW_MS);
+    printk("\t- uid %u, 1 thread: " _YELLOW "%u ms" _END ", share %u / 1000\n", FAIRSHARE_TEST_UID_ONE,
+           (uint32_t)div_u64(runtime[0], NSEC_PER_MSEC), one_share);
+    printk("\t- uid %u, %u threads: " _YELLOW "%u ms" _END ", share %u / 1000\n", FAIRSHARE_TEST_UID_MANY,
+           FAIRSHARE_TEST_MANY, (uint32_t)div_u64(many, NSEC_PER_MSEC), many_share);
+    for (uint32_t i = 1; i < FAIRSHARE_TEST_THREADS; i++)
+        printk("\t\t thread %u: %u ms\n", i, (uint32_t)div_u64(runtime[i], NSEC_PER_MSEC));
+    if ((one_share > many_share ? one_share - many_share : many_share - one_share) <= 2 * WORKFLOW_SPIN_TOLERANCE)
+        printk("\t- " _GREEN "OK" _END ": each uid got half of the CPU (within %u / 1000)\n", WORKFLOW_SPIN_TOLERANCE);
+    else
+        printk("\t- " _RED "FAILED" _END ": the uid with more threads got more CPU\n");
+
+    __WORKFLOW_FOOTER();
+}
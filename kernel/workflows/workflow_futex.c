@@ -0,0 +1,132 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   workflow_futex.c                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 04:23:01 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:23:19 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+#include <multitasking/kthread.h>
+#include <multitasking/scheduler.h>
+
+#include <syscall/futex.h>
+
+#include <system/clocksource.h>
+#include <system/pit.h>
+
+#include <workflows/workflows.h>
+
+#include <asm/div64.h>
+
+#define FUTEX_TEST_WAITERS 2
+#define FUTEX_TEST_TIMEOUT_MS 50
+#define FUTEX_TEST_LONG_TIMEOUT_MS 2000 // Woken long before it expires
+#define FUTEX_TEST_POLL_MS 500          // Gives up on a waiter never queued
+
+static uint32_t __futex_word = 0;
+
+static uint32_t __elapsed_ms(uint64_t start) {
+    return ((uint32_t)div_u64(ktime_get() - start, NSEC_PER_MSEC));
+}
+
+/* Exit code: what futex_wait_timeout() returned */
+static int32_t __futex_waiter(void *arg) {
+    return (futex_wait_timeout(&__futex_word, 0, (uint32_t)arg));
+}
+
+/**
+ * @brief Sleep until 'count' waiters are queued on the futex word
+ */
+static bool __futex_wait_queued(kthread_t **waiters, uint32_t count) {
+    for (uint32_t ms = 0; ms < FUTEX_TEST_POLL_MS; ms++) {
+        uint32_t queued = 0;
+
+        for (uint32_t i = 0; i < count; i++)
+            queued += (waiters[i] && waiters[i]->task->futex_key && waiters[i]->task->state == TASK_BLOCKED);
+        if (queued == count)
+            return (true);
+        kmsleep(1);
+    }
+    return (false);
+}
+
+static void __print_check(const char *what, bool ok) {
+    printk("\t- %s: %s\n", what, ok ? _GREEN "OK" _END : _RED "FAILED" _END);
+}
+
+/**
+ * @brief Two waiters without timeout: a wake of one, then a wake of all
+ */
+static void __futex_wait_wake(void) {
+    kthread_t *waiters[FUTEX_TEST_WAITERS] = {NULL};
+    int32_t codes[FUTEX_TEST_WAITERS] = {-1, -1};
+    int first, second;
+    bool queued;
+
+    __futex_word = 0;
+    for (uint32_t i = 0; i < FUTEX_TEST_WAITERS; i++)
+        waiters[i] = kthread_create(&__futex_waiter, (void *)0, "futex-waiter");
+    queued = __futex_wait_queued(waiters, FUTEX_TEST_WAITERS);
+
+    __futex_word = 1;
+    first = futex_wake(&__futex_word, 1);
+    second = futex_wake(&__futex_word, FUTEX_TEST_WAITERS);
+    for (uint32_t i = 0; i < FUTEX_TEST_WAITERS; i++) {
+        if (waiters[i])
+            kthread_join(waiters[i], &codes[i]);
+    }
+
+    printk("\t- Wake one: " _YELLOW "%d" _END " woken, wake all: " _YELLOW "%d" _END " woken\n", first, second);
+    __print_check("Waiters sleep on the word", queued);
+    __print_check("FUTEX_WAKE wakes at most val tasks", first == 1 && second == FUTEX_TEST_WAITERS - 1);
+    __print_check("Woken waiters return 0", codes[0] == 0 && codes[1] == 0);
+}
+
+/**
+ * @brief FUTEX_WAIT on a stale value returns at once, a timed wait nobody
+ *        wakes expires, a timed wait woken early does not
+ */
+static void __futex_timeout(void) {
+    kthread_t *waiter;
+    int32_t woken_code = -1;
+    uint32_t waited_ms, woken_ms;
+    uint64_t start;
+    int stale, expired;
+
+    __futex_word = 1;
+    stale = futex_wait(&__futex_word, 0);
+
+    __futex_word = 0;
+    start = ktime_get();
+    expired = futex_wait_timeout(&__futex_word, 0, FUTEX_TEST_TIMEOUT_MS);
+    waited_ms = __elapsed_ms(start);
+
+    start = ktime_get();
+    waiter = kthread_create(&__futex_waiter, (void *)FUTEX_TEST_LONG_TIMEOUT_MS, "futex-timed");
+    __futex_wait_queued(&waiter, 1);
+    __futex_word = 1;
+    futex_wake(&__futex_word, 1);
+    if (waiter)
+        kthread_join(waiter, &woken_code);
+    woken_ms = __elapsed_ms(start);
+
+    printk("\t- Timed wait of %u ms: returned %d after " _YELLOW "%u ms" _END "\n", FUTEX_TEST_TIMEOUT_MS, expired,
+           waited_ms);
+    printk("\t- Timed wait of %u ms woken: returned %d after " _YELLOW "%u ms" _END "\n", FUTEX_TEST_LONG_TIMEOUT_MS,
+           woken_code, woken_ms);
+    __print_check("Stale value returns -1 without sleeping", stale == -1);
+    __print_check("Unwoken wait times out", expired == FUTEX_ETIMEDOUT && waited_ms >= FUTEX_TEST_TIMEOUT_MS);
+    __print_check("Woken wait returns 0 before its timeout", woken_code == 0 && woken_ms < FUTEX_TEST_LONG_TIMEOUT_MS);
+}
+
+void futex_test(void) {
+    __WORKFLOW_HEADER();
+
+    __futex_wait_wake();
+    __futex_timeout();
+
+    __WORKFLOW_FOOTER();
+}
@@ -0,0 +1,345 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   workflow_pi_mutex.c                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 04:15:19 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:18:43 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include <multitasking/kthread.h>
+#include <multitasking/scheduler.h>
+
+#include <system/clocksource.h>
+#include <system/mutex.h>
+#include <system/percpu.h>
+#include <system/pi_mutex.h>
+#include <system/pit.h>
+
+#include <workflows/workflows.h>
+
+#include <asm/div64.h>
+
+#define PI_TEST_RT_CALLER 30 // Creates and sets up the threads before they run
+#define PI_TEST_RT_HIGH 20
+#define PI_TEST_RT_MIDDLE 10
+#define PI_TEST_HOLD_MS 20  // Critical section of the owner
+#define PI_TEST_SPIN_MS 300 // Busy time of the middle priority task
+
+static pi_mutex_t __pi_mutex;
+static mutex_t __plain_mutex = MUTEX_INIT;
+static volatile bool __use_pi = false;
+static volatile bool __owner_locked = false;
+
+static void __busy_ms(uint32_t ms) {
+    uint64_t end = ktime_get() + (uint64_t)ms * NSEC_PER_MSEC;
+
+    while (ktime_get() < end)
+        __asm__ volatile("pause");
+}
+
+/* Threads set their own policy: on SMP they may run before their creator could */
+static void __thread_fifo(void *arg) {
+    if ((uint32_t)arg)
+        sched_setscheduler(0, SCHED_FIFO, (uint32_t)arg);
+}
+
+static void __test_lock(void) {
+    if (__use_pi)
+        pi_mutex_lock(&__pi_mutex);
+    else
+        mutex_lock(&__plain_mutex);
+}
+
+static void __test_unlock(void) {
+    if (__use_pi)
+        pi_mutex_unlock(&__pi_mutex);
+    else
+        mutex_unlock(&__plain_mutex);
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                               PRIORITY INVERSION                               ||
+// ! ||--------------------------------------------------------------------------------||
+
+/* SCHED_NORMAL: holds the lock the FIFO waiter wants */
+static int32_t __inversion_owner(void *arg) {
+    __UNUSED(arg);
+    __test_lock();
+    __owner_locked = true;
+    __busy_ms(PI_TEST_HOLD_MS);
+    __test_unlock();
+    return (0);
+}
+
+/* SCHED_FIFO middle: never blocks, starves every fair task of its CPU */
+static int32_t __inversion_spinner(void *arg) {
+    __thread_fifo(arg);
+    __busy_ms(PI_TEST_SPIN_MS);
+    return (0);
+}
+
+/* SCHED_FIFO high: exit code is the time it waited for the lock (ms) */
+static int32_t __inversion_waiter(void *arg) {
+    uint64_t start;
+
+    __thread_fifo(arg);
+    start = ktime_get();
+    __test_lock();
+    __test_unlock();
+    return ((int32_t)div_u64(ktime_get() - start, NSEC_PER_MSEC));
+}
+
+/**
+ * @brief Owner (fair) takes the lock, then a FIFO waiter blocks on it while
+ *        a FIFO task of middle priority spins
+ * @return Time the waiter was blocked (ms), -1 on failure
+ * @note : The caller runs above every thread: they are set up before any
+ *         of them runs, and its joins let them go.
+ */
+static int32_t __inversion_run(bool pi) {
+    kthread_t *owner, *spinner, *waiter;
+    int32_t waited = -1;
+
+    __use_pi = pi;
+    __owner_locked = false;
+
+    if (!(owner = kthread_create(&__inversion_owner, NULL, "pi-owner")))
+        return (-1);
+    while (!__owner_locked)
+        kmsleep(1);
+
+    spinner = kthread_create(&__inversion_spinner, (void *)PI_TEST_RT_MIDDLE, "pi-spinner");
+    waiter = kthread_create(&__inversion_waiter, (void *)PI_TEST_RT_HIGH, "pi-waiter");
+
+    if (waiter)
+        kthread_join(waiter, &waited);
+    if (spinner)
+        kthread_join(spinner, NULL);
+    kthread_join(owner, NULL);
+    return (waiter && spinner ? waited : -1);
+}
+
+void pi_inversion_test(void) {
+    int32_t plain_ms, pi_ms;
+
+    __WORKFLOW_HEADER();
+
+    pi_mutex_init(&__pi_mutex, "workflow-pi");
+    if (sched_setscheduler(0, SCHED_FIFO, PI_TEST_RT_CALLER))
+        __THROW_NO_RETURN("pi_inversion_test : sched_setscheduler failed");
+
+    plain_ms = __inversion_run(false);
+    pi_ms = __inversion_run(true);
+
+    sched_setscheduler(0, SCHED_NORMAL, 0);
+    pi_mutex_destroy(&__pi_mutex);
+
+    printk("\t- Owner holds %u ms, FIFO %u spins %u ms, FIFO %u waits (%u CPUs)\n", PI_TEST_HOLD_MS, PI_TEST_RT_MIDDLE,
+           PI_TEST_SPIN_MS, PI_TEST_RT_HIGH, cpu_count);
+    printk("\t- Plain mutex: waiter blocked " _YELLOW "%d ms" _END "\n", plain_ms);
+    printk("\t- PI mutex: waiter blocked " _GREEN "%d ms" _END "\n", pi_ms);
+    if (pi_ms < 0 || pi_ms >= PI_TEST_SPIN_MS)
+        printk("\t- " _RED "FAILED" _END ": the FIFO waiter was held behind the spinning task\n");
+    else
+        printk("\t- " _GREEN "OK" _END ": the owner ran at the waiter's RT priority\n");
+
+    __WORKFLOW_FOOTER();
+}
+
+// ! ||--------------------------------------------------------------------------------||
+// ! ||                              BOOST / CHAIN DEPTH                               ||
+// ! ||--------------------------------------------------------------------------------||
+
+#define PI_TEST_CHAIN_LEN (PI_MUTEX_CHAIN_MAX + 1) // One owner past the boost bound
+#define PI_TEST_TIMEOUT_MS 200
+
+typedef struct s_pi_test_thread {
+    uint32_t link;            // Mutex of the chain it takes
+    task_priority_t priority; // Fair priority, if not SCHED_FIFO
+    uint32_t rt_priority;     // SCHED_FIFO priority, 0 for a fair task
+} pi_test_thread_t;
+
+static pi_mutex_t __chain[PI_TEST_CHAIN_LEN];
+static volatile bool __chain_release = false;
+static volatile bool __chain_restored[PI_TEST_CHAIN_LEN];
+
+static void __thread_setup(pi_test_thread_t *setup) {
+    if (setup->rt_priority)
+        sched_setscheduler(0, SCHED_FIFO, setup->rt_priority);
+    else
+        task_set_priority(get_current_task()->pid, setup->priority);
+}
+
+/**
+ * @brief Link 'n' holds __chain[n] and sleeps on __chain[n - 1], link 0
+ *        holds __chain[0] until released
+ * @note : Records whether it inherited nothing anymore once it unlocked.
+ */
+static int32_t __chain_link(void *arg) {
+    pi_test_thread_t *setup = arg;
+    task_t *task = get_current_task();
+
+    __thread_setup(setup);
+    pi_mutex_lock(&__chain[setup->link]);
+    if (setup->link) {
+        pi_mutex_lock(&__chain[setup->link - 1]);
+        pi_mutex_unlock(&__chain[setup->link - 1]);
+    } else {
+        while (!__chain_release)
+            kmsleep(1);
+    }
+    pi_mutex_unlock(&__chain[setup->link]);
+    __chain_restored[setup->link] = !task->pi_rt_priority && task->pi_boost == TASK_PRIORITY_LOW;
+    return (0);
+}
+
+static int32_t __chain_waiter(void *arg) {
+    pi_test_thread_t *setup = arg;
+
+    __thread_setup(setup);
+    pi_mutex_lock(&__chain[setup->link]);
+    pi_mutex_unlock(&__chain[setup->link]);
+    return (0);
+}
+
+/**
+ * @brief Sleep until 'thread' owns __chain[link] and, past link 0, sleeps on
+ *        the previous one: a waiter boosting it reaches the rest of the chain
+ */
+static bool __chain_wait_link(kthread_t *thread, uint32_t link) {
+    task_t *task = thread->task;
+
+    for (uint32_t ms = 0; ms < PI_TEST_TIMEOUT_MS; ms++) {
+        if (__chain[link].owner == task &&
+            (!link || (task->pi_blocked_on == &__chain[link - 1] && task->state == TASK_BLOCKED)))
+            return (true);
+        kmsleep(1);
+    }
+    return (false);
+}
+
+/**
+ * @brief Sleep until 'task' inherited 'pi_boost' and 'pi_rt_priority'
+ */
+static bool __wait_inherited(task_t *task, task_priority_t pi_boost, uint32_t pi_rt_priority) {
+    for (uint32_t ms = 0; ms < PI_TEST_TIMEOUT_MS; ms++) {
+        if (task->pi_boost == pi_boost && task->pi_rt_priority == pi_rt_priority)
+            return (true);
+        kmsleep(1);
+    }
+    return (false);
+}
+
+static void __print_check(const char *what, bool ok) {
+    printk("\t- %s: %s\n", what, ok ? _GREEN "OK" _END : _RED "FAILED" _END);
+}
+
+/**
+ * @brief A LOW owner is boosted by a HIGH fair waiter, then moved to the RT
+ *        class by a FIFO waiter, and gets both back once it unlocks
+ */
+static void __pi_boost_restore(void) {
+    pi_test_thread_t owner_setup = {0, TASK_PRIORITY_LOW, 0};
+    pi_test_thread_t fair_setup = {0, TASK_PRIORITY_HIGH, 0};
+    pi_test_thread_t rt_setup = {0, TASK_PRIORITY_REALTIME, PI_TEST_RT_HIGH};
+    kthread_t *owner, *fair, *rt;
+    bool fair_boost, rt_boost;
+
+    __chain_release = false;
+    __chain_restored[0] = false;
+    if (!(owner = kthread_create(&__chain_link, &owner_setup, "pi-owner")))
+        __THROW_NO_RETURN("pi_mutex_test : kthread_create failed");
+    if (!__chain_wait_link(owner, 0)) {
+        __chain_release = true;
+        kthread_join(owner, NULL);
+        __THROW_NO_RETURN("pi_mutex_test : the owner did not take the mutex");
+    }
+
+    fair = kthread_create(&__chain_waiter, &fair_setup, "pi-fair");
+    fair_boost = fair && __wait_inherited(owner->task, TASK_PRIORITY_HIGH, 0) &&
+                 owner->task->priority == TASK_PRIORITY_HIGH;
+
+    rt = kthread_create(&__chain_waiter, &rt_setup, "pi-rt");
+    rt_boost = rt && __wait_inherited(owner->task, TASK_PRIORITY_REALTIME, PI_TEST_RT_HIGH) &&
+               task_sched_class(owner->task) == &rt_sched_class;
+
+    __chain_release = true;
+    if (rt)
+        kthread_join(rt, NULL);
+    if (fair)
+        kthread_join(fair, NULL);
+    kthread_join(owner, NULL);
+
+    __print_check("HIGH fair waiter boosts the LOW owner to HIGH", fair_boost);
+    __print_check("FIFO waiter moves the owner to the RT class", rt_boost);
+    __print_check("Owner inherits nothing once it unlocked", __chain_restored[0]);
+}
+
+/**
+ * @brief A FIFO waiter at the end of a chain of PI_TEST_CHAIN_LEN owners
+ *        boosts the PI_MUTEX_CHAIN_MAX closest ones, not the last
+ */
+static void __pi_chain_depth(void) {
+    pi_test_thread_t setups[PI_TEST_CHAIN_LEN];
+    pi_test_thread_t waiter_setup = {PI_TEST_CHAIN_LEN - 1, TASK_PRIORITY_REALTIME, PI_TEST_RT_HIGH};
+    kthread_t *links[PI_TEST_CHAIN_LEN] = {NULL};
+    kthread_t *waiter = NULL;
+    uint32_t boosted = 0, restored = 0;
+    bool bounded = false;
+
+    __chain_release = false;
+    for (uint32_t i = 0; i < PI_TEST_CHAIN_LEN; i++) {
+        setups[i] = (pi_test_thread_t){i, TASK_PRIORITY_MEDIUM, 0};
+        __chain_restored[i] = false;
+        if (!(links[i] = kthread_create(&__chain_link, &setups[i], "pi-link")) || !__chain_wait_link(links[i], i)) {
+            __print_check("Chain of owners set up", false);
+            goto release;
+        }
+    }
+
+    if ((waiter = kthread_create(&__chain_waiter, &waiter_setup, "pi-rt"))) {
+        /* The walk goes down from the last link: link 1 is boosted last */
+        __wait_inherited(links[1]->task, TASK_PRIORITY_REALTIME, PI_TEST_RT_HIGH);
+        for (uint32_t i = 0; i < PI_TEST_CHAIN_LEN; i++)
+            boosted += (links[i]->task->pi_rt_priority == PI_TEST_RT_HIGH);
+        bounded = !links[0]->task->pi_rt_priority;
+    }
+
+release:
+    __chain_release = true;
+    if (waiter)
+        kthread_join(waiter, NULL);
+    for (uint32_t i = PI_TEST_CHAIN_LEN; i-- > 0;) {
+        if (links[i])
+            kthread_join(links[i], NULL);
+        restored += __chain_restored[i];
+    }
+
+    printk("\t- Chain of %u owners: " _YELLOW "%u" _END " boosted, " _YELLOW "%u" _END " restored\n",
+           PI_TEST_CHAIN_LEN, boosted, restored);
+    __print_check("Boost stops after PI_MUTEX_CHAIN_MAX owners",
+                  waiter && boosted == PI_MUTEX_CHAIN_MAX && bounded);
+    __print_check("Every owner inherits nothing once it unlocked", restored == PI_TEST_CHAIN_LEN);
+}
+
+void pi_mutex_test(void) {
+    __WORKFLOW_HEADER();
+
+    for (uint32_t i = 0; i < PI_TEST_CHAIN_LEN; i++)
+        pi_mutex_init(&__chain[i], "workflow-chain");
+    if (sched_setscheduler(0, SCHED_FIFO, PI_TEST_RT_CALLER))
+        __THROW_NO_RETURN("pi_mutex_test : sched_setscheduler failed");
+
+    __pi_boost_restore();
+    __pi_chain_depth();
+
+    sched_setscheduler(0, SCHED_NORMAL, 0);
+    for (uint32_t i = 0; i < PI_TEST_CHAIN_LEN; i++)
+        pi_mutex_destroy(&__chain[i]);
+
+    __WORKFLOW_FOOTER();
+}
@@ -6,7 +6,7 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2022/12/08 13:04:19 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/26 17:38:38 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 04:34:49 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
@@ -278,7 +278,7 @@ void while_task() {
                    "] Fibonacci: "_GREEN
                    "%d"_END
                    "\n",
-                   getpid(), get_task(getpid())->state, fibonacci(i));
+                   getpid(), get_current_task()->state, fibonacci(i));
             kmsleep(TASK_FREQUENCY);
         }
     }
@@ -286,7 +286,7 @@ void while_task() {
 
 void waiting_queue_loop() {
     while (1) {
-        if (get_task_count() + get_waiting_task_count() > MAX_TASKS) {
+        if (get_task_count() + get_waiting_task_count() > task_get_max()) {
             printk("Kill task [%d]\n", get_task_count() - 1);
             kill_task(get_task_count() - 1);
         }
@@ -298,7 +298,7 @@ void waiting_queue_loop() {
 
 void ready_queue_loop() {
     while (1) {
-        if (get_task_count() + get_waiting_task_count() <= MAX_TASKS + OFFSET_WAITING_QUEUE) {
+        if (get_task_count() + get_waiting_task_count() <= task_get_max() + OFFSET_WAITING_QUEUE) {
             pid_t pid = init_task(task_dummy);
             printk("Create task dummy: "_GREEN
                    "[%u]"_END
@@ -6,64 +6,47 @@
 /*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
 /*                                                +#+#+#+#+#+   +#+           */
 /*   Created: 2023/10/26 20:42:29 by vvaucoul          #+#    #+#             */
-/*   Updated: 2023/10/27 10:44:07 by vvaucoul         ###   ########.fr       */
+/*   Updated: 2026/10/19 02:43:17 by vvaucoul         ###   ########.fr       */
 /*                                                                            */
 /* ************************************************************************** */
 
-#include <system/mutex.h>
-#include <system/semaphore.h>
-#include <system/threads.h>
-
+#include <multitasking/kthread.h>
 #include <multitasking/process.h>
 #include <workflows/workflows.h>
 
-static void __thread_01(void) {
-    printk("\t - Thread [01]\n");
-    while (1) {
-    }
-}
+#define THREADS_TEST_COUNT 4
 
-static void __thread_02(void) {
-    printk("\t - Thread [02]\n");
-}
+static int32_t __thread_worker(void *arg) {
+    uint32_t id = (uint32_t)arg;
+    volatile uint32_t sum = 0;
 
-static void __thread_03(void) {
-    printk("\t - Thread [03]\n");
-}
-
-static void __thread_04(void) {
-    printk("\t - Thread [04]\n");
-}
-
-static void create_threads() {
-    printk("Creating threads\n");
-
-    thread_t *thread = thread_create(__thread_01);
-    printk("Thread created\n");
-
-    if (!thread) {
-        __THROW_NO_RETURN("Failed to create thread");
-    } else {
-        printk("Starting thread\n");
-
-        // thread_start(thread);
-    }
-
-    while (1) {
-        ksleep(1);
-    }
+    printk("\t - Thread [%u] started\n", id);
+    for (uint32_t i = 0; i < 0x100000 * id; ++i)
+        sum += i;
+    return ((int32_t)(id * 10));
 }
 
 void threads_test(void) {
+    kthread_t *threads[THREADS_TEST_COUNT];
+    char name[KTHREAD_NAME_LEN];
+
     __WORKFLOW_HEADER();
 
-    init_task(create_threads);
-    // create_threads();
+    for (uint32_t i = 0; i < THREADS_TEST_COUNT; ++i) {
+        strncpy(name, "worker-x", KTHREAD_NAME_LEN);
+        name[7] = '0' + i + 1;
+        if (!(threads[i] = kthread_create(&__thread_worker, (void *)(i + 1), name)))
+            __THROW_NO_RETURN("Failed to create thread");
+    }
 
-    while (1) {
+    for (uint32_t i = 0; i < THREADS_TEST_COUNT; ++i) {
+        int32_t exit_code = -1;
 
-        ksleep(1);
+        kthread_print(threads[i]);
+        if (kthread_join(threads[i], &exit_code) != 0)
+            __THROW_NO_RETURN("Failed to join thread");
+        printk("\t - Thread [%u] joined, exit code: "_GREEN "%d" _END "\n", i + 1, exit_code);
     }
 
     __WORKFLOW_FOOTER();
-}
\ No newline at end of file
+}
@@ -0,0 +1,132 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   workflow_rcu.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 04:23:45 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:24:02 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+#include <memory/memory.h>
+
+#include <multitasking/kthread.h>
+#include <multitasking/scheduler.h>
+
+#include <system/clocksource.h>
+#include <system/percpu.h>
+#include <system/pit.h>
+#include <system/rcu.h>
+#include <system/smp.h>
+
+#include <workflows/workflows.h>
+
+#include <asm/div64.h>
+
+#define RCU_TEST_READ_MS 100  // Time the reader stays in its read section
+#define RCU_TEST_POLL_MS 1000 // Gives up on a reader never scheduled
+#define RCU_TEST_OLD 0x01D
+#define RCU_TEST_NEW 0x0E1
+
+typedef struct s_rcu_test_node {
+    uint32_t value;
+} rcu_test_node_t;
+
+static rcu_test_node_t *__rcu_node = NULL;
+static volatile bool __reader_in = false;
+static volatile bool __reader_out = false;
+static volatile bool __reader_intact = false;
+static volatile uint32_t __reader_cpu = 0;
+
+/**
+ * @brief Reader: holds the old node in a read section for RCU_TEST_READ_MS,
+ *        on the CPU it runs on, without sleeping
+ */
+static int32_t __rcu_reader(void *arg) {
+    rcu_test_node_t *node;
+    uint64_t end;
+
+    __UNUSED(arg);
+    rcu_read_lock();
+    node = rcu_dereference(__rcu_node);
+    __reader_cpu = this_cpu()->id;
+    __reader_in = true;
+
+    end = ktime_get() + (uint64_t)RCU_TEST_READ_MS * NSEC_PER_MSEC;
+    while (ktime_get() < end)
+        __asm__ volatile("pause");
+
+    /* Still the old node, not freed under us */
+    __reader_intact = node->value == RCU_TEST_OLD;
+    __reader_out = true;
+    rcu_read_unlock();
+    return (0);
+}
+
+/**
+ * @brief synchronize_rcu() must wait for a reader running on another CPU
+ *        before the old node may be freed
+ */
+void rcu_test(void) {
+    rcu_test_node_t *old, *new;
+    uint32_t waited_ms = 0, writer_cpu;
+    uint64_t gp_before, start;
+    kthread_t *reader;
+    bool reader_out = false;
+
+    __WORKFLOW_HEADER();
+
+    old = kmalloc(sizeof(rcu_test_node_t));
+    new = kmalloc(sizeof(rcu_test_node_t));
+    if (!old || !new) {
+        if (old)
+            kfree(old);
+        if (new)
+            kfree(new);
+        __THROW_NO_RETURN("rcu_test : kmalloc failed");
+    }
+    old->value = RCU_TEST_OLD;
+    new->value = RCU_TEST_NEW;
+    rcu_assign_pointer(__rcu_node, old);
+    __reader_in = __reader_out = __reader_intact = false;
+
+    if (!(reader = kthread_create(&__rcu_reader, NULL, "rcu-reader"))) {
+        rcu_assign_pointer(__rcu_node, NULL);
+        kfree(old);
+        kfree(new);
+        __THROW_NO_RETURN("rcu_test : kthread_create failed");
+    }
+    for (uint32_t ms = 0; !__reader_in && ms < RCU_TEST_POLL_MS; ms++)
+        kmsleep(1);
+
+    /* Writer: unlink the old node, wait for its readers, free it */
+    preempt_disable();
+    writer_cpu = this_cpu()->id;
+    preempt_enable();
+    rcu_assign_pointer(__rcu_node, new);
+    gp_before = rcu_stats.gp_completed;
+    start = ktime_get();
+    synchronize_rcu();
+    reader_out = __reader_out;
+    waited_ms = (uint32_t)div_u64(ktime_get() - start, NSEC_PER_MSEC);
+    old->value = 0;
+    kfree(old);
+
+    kthread_join(reader, NULL);
+    rcu_assign_pointer(__rcu_node, NULL);
+    kfree(new);
+
+    printk("\t- Reader on CPU %u, writer on CPU %u (%u CPUs online)\n", __reader_cpu, writer_cpu,
+           smp_online_cpus());
+    printk("\t- synchronize_rcu() waited " _YELLOW "%u ms" _END " (reader holds %u ms), %u grace periods\n",
+           waited_ms, RCU_TEST_READ_MS, (uint32_t)(rcu_stats.gp_completed - gp_before));
+    if (!__reader_in || __reader_cpu == writer_cpu)
+        printk("\t- " _YELLOW "SKIPPED" _END ": the reader did not run on another CPU\n");
+    else if (reader_out && __reader_intact)
+        printk("\t- " _GREEN "OK" _END ": the grace period ended after the reader left its section\n");
+    else
+        printk("\t- " _RED "FAILED" _END ": synchronize_rcu() returned while the reader held the node\n");
+
+    __WORKFLOW_FOOTER();
+}
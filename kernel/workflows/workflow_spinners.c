@@ -0,0 +1,80 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   workflow_spinners.c                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: vvaucoul <vvaucoul@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 04:35:43 by vvaucoul          #+#    #+#             */
+/*   Updated: 2026/10/19 04:35:57 by vvaucoul         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+#include <multitasking/kthread.h>
+#include <multitasking/scheduler.h>
+
+#include <system/clocksource.h>
+#include <system/percpu.h>
+
+#include <workflows/workflows.h>
+
+static workflow_spin_setup_t __spin_setup = NULL;
+static uint64_t __spin_start = 0, __spin_end = 0;
+static uint64_t *__spin_runtime = NULL;
+
+/**
+ * @brief Set up, spin through the window and record the CPU time spent
+ *        inside it
+ */
+static int32_t __workflow_spinner(void *arg) {
+    uint32_t id = (uint32_t)arg;
+    kthread_t *self = kthread_self();
+    uint64_t base;
+
+    if (__spin_setup)
+        __spin_setup(id);
+    while (ktime_get() < __spin_start)
+        __asm__ volatile("pause");
+    base = kthread_cpu_time(self);
+    while (ktime_get() < __spin_end)
+        __asm__ volatile("pause");
+    __spin_runtime[id] = kthread_cpu_time(self) - base;
+    return (0);
+}
+
+/**
+ * @brief Run 'count' spinning kthreads bound to one CPU through the same
+ *        WORKFLOW_SPIN_WINDOW_MS window
+ * @param setup Called first by each thread with its id, NULL for none
+ * @param runtime CPU time each thread spent inside the window
+ * @return The CPU they ran on, -1 if a thread could not be created
+ * @note : Runs them on another CPU than the caller when there is one, the
+ *         caller sleeps in kthread_join() meanwhile.
+ */
+int32_t workflow_spin_window(uint32_t count, workflow_spin_setup_t setup, uint64_t *runtime, const char *name) {
+    kthread_t *threads[WORKFLOW_SPIN_MAX] = {NULL};
+    uint32_t cpu = cpu_count > 1 ? cpu_count - 1 : 0;
+    bool created = true;
+
+    if (count > WORKFLOW_SPIN_MAX)
+        __THROW("workflow_spin_window : %u threads, %u at most", -1, count, WORKFLOW_SPIN_MAX);
+    if (!cpus[cpu].online)
+        cpu = 0;
+
+    __spin_setup = setup;
+    __spin_runtime = runtime;
+    __spin_start = ktime_get() + (uint64_t)WORKFLOW_SPIN_WARMUP_MS * NSEC_PER_MSEC;
+    __spin_end = __spin_start + (uint64_t)WORKFLOW_SPIN_WINDOW_MS * NSEC_PER_MSEC;
+    for (uint32_t i = 0; i < count; i++) {
+        runtime[i] = 0;
+        threads[i] = kthread_create_on_cpu(&__workflow_spinner, (void *)i, name, cpu);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (threads[i])
+            kthread_join(threads[i], NULL);
+        else
+            created = false;
+    }
+    if (!created)
+        __THROW("workflow_spin_window : kthread_create_on_cpu failed", -1);
+    return ((int32_t)cpu);
+}